@@ -0,0 +1,157 @@
+// Throughput of the primitives every scan leans on: address parsing and
+// formatting, ICMP checksums, the thread pool, result sorting, OUI lookup
+// and the --json report.
+
+#include "device_identifier.hpp"
+#include "icmp.hpp"
+#include "json_output.hpp"
+#include "network_info.hpp"
+#include "scan_pipeline.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    std::vector<std::string> randomIps(const size_t count) {
+        std::mt19937 gen(42);
+        std::vector<std::string> ips;
+        for (size_t i = 0; i < count; ++i) ips.push_back(Utils::uintToIp(gen()));
+        return ips;
+    }
+
+    std::string macFor(const uint32_t seed) {
+        char mac[18];
+        std::snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", seed >> 16 & 0xff, seed >> 8 & 0xff,
+                      seed & 0xff, seed >> 24 & 0xff, 0x12, 0x34);
+        return mac;
+    }
+
+    void BM_IpToUint(benchmark::State& state) {
+        const auto ips = randomIps(1024);
+        size_t i = 0;
+        for (auto _ : state) benchmark::DoNotOptimize(Utils::ipToUint(ips[i++ & 1023]));
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_IpToUint);
+
+    void BM_UintToIp(benchmark::State& state) {
+        uint32_t ip = 0x0a000001;
+        for (auto _ : state) benchmark::DoNotOptimize(Utils::uintToIp(ip += 0x01010101));
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UintToIp);
+
+    void BM_ParseCidr(benchmark::State& state) {
+        std::vector<std::string> cidrs;
+        for (const auto& ip : randomIps(1024)) cidrs.push_back(ip + "/" + std::to_string(8 + cidrs.size() % 25));
+        size_t i = 0;
+        for (auto _ : state) benchmark::DoNotOptimize(Utils::parseCIDR(cidrs[i++ & 1023]));
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ParseCidr);
+
+    // Echo header plus payload, from a bare header up to a full-MTU packet
+    void BM_IcmpChecksum(benchmark::State& state) {
+        std::vector<uint8_t> packet(static_cast<size_t>(state.range(0)));
+        std::mt19937 gen(42);
+        for (auto& byte : packet) byte = static_cast<uint8_t>(gen());
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(Icmp::checksum(packet.data(), static_cast<int>(packet.size())));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_IcmpChecksum)->Arg(8)->Arg(64)->Arg(1472);
+
+    // Tasks through enqueue -> worker -> done, with and without a bounded queue
+    void BM_ThreadPoolThroughput(benchmark::State& state) {
+        constexpr int TASKS = 10000;
+        const auto threads = static_cast<size_t>(state.range(0));
+        const auto maxQueued = static_cast<size_t>(state.range(1));
+        for (auto _ : state) {
+            std::atomic<int> done{0};
+            {
+                ThreadPool pool(threads, maxQueued);
+                for (int i = 0; i < TASKS; ++i) {
+                    pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                }
+            }
+            benchmark::DoNotOptimize(done.load());
+        }
+        state.SetItemsProcessed(state.iterations() * TASKS);
+    }
+    BENCHMARK(BM_ThreadPoolThroughput)
+        ->ArgNames({"threads", "max_queued"})
+        ->Args({1, 0})->Args({8, 0})->Args({8, 256})->Args({64, 256})
+        ->UseRealTime();
+
+    // The pipeline sorts its hits by (ip, port) before reporting them
+    void BM_SortHits(benchmark::State& state) {
+        std::mt19937 gen(42);
+        std::vector<ScanPipeline::Hit> hits(static_cast<size_t>(state.range(0)));
+        for (auto& hit : hits) hit = {static_cast<uint32_t>(gen()), static_cast<int>(gen() % 65536)};
+        for (auto _ : state) {
+            auto sorted = hits;
+            std::sort(sorted.begin(), sorted.end());
+            benchmark::DoNotOptimize(sorted.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_SortHits)->Arg(256)->Arg(65536);
+
+    // nmap-mac-prefixes holds roughly 50k OUIs
+    void BM_MacVendorLookup(benchmark::State& state) {
+        DeviceIdentifier deviceId;
+        std::ostringstream table;
+        char prefix[7];
+        for (uint32_t oui = 0; oui < 50000; ++oui) {
+            std::snprintf(prefix, sizeof(prefix), "%06X", oui * 331);
+            table << prefix << " Vendor " << oui << "\n";
+        }
+        std::istringstream in(table.str());
+        deviceId.loadMacVendors(in);
+
+        std::vector<std::string> macs;
+        for (uint32_t i = 0; i < 1024; ++i) macs.push_back(macFor(i * 331 * 7));
+        size_t i = 0;
+        for (auto _ : state) benchmark::DoNotOptimize(deviceId.macVendor(macs[i++ & 1023]));
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_MacVendorLookup);
+
+    void BM_JsonReport(benchmark::State& state) {
+        const auto hostCount = static_cast<size_t>(state.range(0));
+        const NetworkInfo info{"192.168.1.10", "192.168.1.1", "203.0.113.7", "eth0", "255.255.255.0"};
+        const std::vector<int> ports = {22, 80, 443};
+
+        DeviceIdentifier deviceId;
+        std::vector<std::pair<std::string, std::string>> hosts;
+        OpenPortMap openPorts;
+        for (const auto& ip : randomIps(hostCount)) {
+            hosts.emplace_back(ip, "Linux/Unix Server (SSH)");
+            deviceId.setMacAddress(ip, macFor(Utils::ipToUint(ip)));
+            openPorts[ip] = {22, 443};
+        }
+
+        size_t bytes = 0;
+        for (auto _ : state) {
+            const std::string json = JsonOutput::render(info, "tcp", 80, 64, false, 1000, "10.0.0.0/16", hosts, 12.5,
+                                                        65536, ports, openPorts, deviceId, 0, {}, {});
+            bytes = json.size();
+            benchmark::DoNotOptimize(json.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    }
+    BENCHMARK(BM_JsonReport)->Arg(16)->Arg(1024);
+}
@@ -0,0 +1,304 @@
+// End-to-end scan throughput against local responders on the loopback /8.
+//
+// Linux routes all of 127.0.0.0/8 to lo, so TCP listeners bound to a random
+// subset of one /16 stand in for live hosts and every other address refuses
+// at once. Each (mode, threads) run happens in a forked child, so the CPU time
+// and peak RSS reported are that run's alone; the responders stay in the parent.
+//
+//   cmake -B build -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON && cmake --build build
+//   ./build/bin/network-analyzer-loopback-bench [options]
+//
+//   --subnet CIDR       targets (default 127.1.0.0/16)
+//   --live N            responders placed in the subnet (default 256)
+//   --modes LIST        scan modes, plus "thorough" (default tcp,thorough)
+//   --threads LIST      thread counts (default 16,64,256)
+//   --port N            port probed in scan modes (default 80)
+//   --timeout MS        probe timeout (default 1000)
+//   --seed N            picks the live addresses (default 42)
+//   --json              one JSON object per run instead of the table
+
+#include "fd_budget.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "scanner.hpp"
+#include "target_set.hpp"
+#include "utils.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Ports a live host answers on: the scan port plus the thorough scan's TCP evidence ports
+    constexpr int VERIFY_PORTS[] = {80, 443, 22};
+
+    struct Options {
+        std::string subnet = "127.1.0.0/16";
+        size_t live = 256;
+        std::vector<std::string> modes = {"tcp", "thorough"};
+        std::vector<size_t> threads = {16, 64, 256};
+        int port = 80;
+        int timeoutMs = 1000;
+        uint32_t seed = 42;
+        bool json = false;
+    };
+
+    // Sent from the child back to the parent
+    struct Result {
+        double wallSec;
+        double cpuSec;
+        long peakRssKb;
+        uint64_t probes;
+        uint64_t found;
+        uint64_t truePositives;
+    };
+
+    std::vector<std::string> split(const std::string& list) {
+        std::vector<std::string> out;
+        std::stringstream in(list);
+        for (std::string item; std::getline(in, item, ',');) {
+            if (!item.empty()) out.push_back(item);
+        }
+        return out;
+    }
+
+    Options parseArgs(const int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+                return argv[++i];
+            };
+            if (arg == "--subnet") options.subnet = value();
+            else if (arg == "--live") options.live = std::stoul(value());
+            else if (arg == "--modes") options.modes = split(value());
+            else if (arg == "--threads") {
+                options.threads.clear();
+                for (const auto& n : split(value())) options.threads.push_back(std::stoul(n));
+            }
+            else if (arg == "--port") options.port = std::stoi(value());
+            else if (arg == "--timeout") options.timeoutMs = std::stoi(value());
+            else if (arg == "--seed") options.seed = static_cast<uint32_t>(std::stoul(value()));
+            else if (arg == "--json") options.json = true;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+
+        const auto [first, last] = Utils::parseCIDR(options.subnet);
+        if ((first >> 24) != 127) throw std::invalid_argument(options.subnet + " is not inside 127.0.0.0/8");
+        if (last - first < 2 || options.live > last - first - 1) throw std::invalid_argument("--live exceeds the subnet");
+        return options;
+    }
+
+    // Distinct addresses, never the network or broadcast address of the subnet
+    std::set<uint32_t> pickLive(const Options& options) {
+        const auto [first, last] = Utils::parseCIDR(options.subnet);
+        std::mt19937 gen(options.seed);
+        std::uniform_int_distribution<uint32_t> pick(first + 1, last - 1);
+        std::set<uint32_t> live;
+        while (live.size() < options.live) live.insert(pick(gen));
+        return live;
+    }
+
+    class Responders {
+    public:
+        Responders(const std::set<uint32_t>& live, const int scanPort) {
+            std::set<int> ports(std::begin(VERIFY_PORTS), std::end(VERIFY_PORTS));
+            ports.insert(scanPort);
+
+            for (const uint32_t ip : live) {
+                for (const int port : ports) {
+                    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+                    if (fd < 0) throw std::runtime_error("socket: " + std::string(std::strerror(errno)));
+                    const int one = 1;
+                    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+                    sockaddr_in addr{};
+                    addr.sin_family = AF_INET;
+                    addr.sin_port = htons(static_cast<uint16_t>(port));
+                    addr.sin_addr.s_addr = htonl(ip);
+                    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 1024) < 0) {
+                        const std::string reason = std::strerror(errno);
+                        close(fd);
+                        throw std::runtime_error("cannot listen on " + Utils::uintToIp(ip) + ":" + std::to_string(port) + ": " + reason);
+                    }
+                    fds.push_back({fd, POLLIN, 0});
+                }
+            }
+            thread = std::thread(&Responders::loop, this);
+        }
+
+        ~Responders() {
+            done = true;
+            thread.join();
+            for (const auto& pfd : fds) close(pfd.fd);
+        }
+
+    private:
+        // The scanner only needs the handshake; connections are dropped as soon as they are accepted
+        void loop() {
+            while (!done) {
+                if (poll(fds.data(), fds.size(), 100) <= 0) continue;
+                for (auto& pfd : fds) {
+                    if (!(pfd.revents & POLLIN)) continue;
+                    for (int client; (client = accept(pfd.fd, nullptr, nullptr)) >= 0;) close(client);
+                }
+            }
+        }
+
+        std::vector<pollfd> fds;
+        std::atomic<bool> done{false};
+        std::thread thread;
+    };
+
+    double seconds(const timeval& tv) {
+        return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+    }
+
+    Result runScan(const Options& options, const std::string& mode, const size_t threads, const std::set<uint32_t>& live) {
+        Logger::setLevel(Logger::Level::QUIET);
+        const TargetSet targets = TargetSet::hostsOf(options.subnet);
+        const bool thorough = mode == "thorough";
+        const NetworkScanner scanner(threads, thorough ? "tcp" : mode, options.port, options.timeoutMs);
+
+        const uint64_t probesBefore = Metrics::snapshot()[Metrics::Counter::ProbesSent];
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<std::string> found = thorough ? scanner.thoroughScan(targets) : scanner.scan(targets);
+        const double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+
+        Result result{};
+        result.wallSec = wallSec;
+        result.cpuSec = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+        result.peakRssKb = usage.ru_maxrss;
+        result.probes = Metrics::snapshot()[Metrics::Counter::ProbesSent] - probesBefore;
+        result.found = found.size();
+        for (const auto& ip : found) result.truePositives += live.count(Utils::ipToUint(ip));
+        return result;
+    }
+
+    // Fork, scan in the child, and read its Result back through a pipe
+    bool runIsolated(const Options& options, const std::string& mode, const size_t threads,
+                     const std::set<uint32_t>& live, Result& result) {
+        int pipeFds[2];
+        if (pipe(pipeFds) < 0) return false;
+
+        const pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            close(pipeFds[0]);
+            // The scan's progress bar goes to stderr; keep the table readable
+            const int savedStderr = dup(STDERR_FILENO);
+            if (const int devNull = open("/dev/null", O_WRONLY); devNull >= 0) {
+                dup2(devNull, STDERR_FILENO);
+                close(devNull);
+            }
+            int status = 1;
+            try {
+                const Result child = runScan(options, mode, threads, live);
+                if (write(pipeFds[1], &child, sizeof(child)) == static_cast<ssize_t>(sizeof(child))) status = 0;
+            } catch (const std::exception& e) {
+                dup2(savedStderr, STDERR_FILENO);
+                std::cerr << "[!] " << mode << " with " << threads << " threads: " << e.what() << std::endl;
+            }
+            _exit(status);
+        }
+
+        close(pipeFds[1]);
+        const ssize_t n = read(pipeFds[0], &result, sizeof(result));
+        close(pipeFds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return n == static_cast<ssize_t>(sizeof(result)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseArgs(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Responders and in-flight probes both need descriptors
+    FdBudget::raiseLimit();
+    const std::set<uint32_t> live = pickLive(options);
+    const uint64_t targetCount = TargetSet::hostsOf(options.subnet).size();
+
+    try {
+        Responders responders(live, options.port);
+
+        if (!options.json) {
+            std::cout << "targets: " << targetCount << " in " << options.subnet << ", live: " << live.size()
+                      << ", timeout: " << options.timeoutMs << " ms" << std::endl;
+            std::cout << std::left << std::setw(10) << "mode" << std::right << std::setw(8) << "threads"
+                      << std::setw(10) << "wall s" << std::setw(12) << "probes/s" << std::setw(10) << "cpu s"
+                      << std::setw(12) << "peak RSS MB" << std::setw(9) << "recall" << std::setw(8) << "false+"
+                      << std::endl;
+        }
+
+        int failures = 0;
+        for (const auto& mode : options.modes) {
+            for (const size_t threads : options.threads) {
+                Result r{};
+                if (!runIsolated(options, mode, threads, live, r)) {
+                    std::cerr << "[!] " << mode << " with " << threads << " threads failed" << std::endl;
+                    ++failures;
+                    continue;
+                }
+
+                const double recall = live.empty() ? 1.0 : static_cast<double>(r.truePositives) / static_cast<double>(live.size());
+                const uint64_t falsePositives = r.found - r.truePositives;
+                const double probesPerSec = r.wallSec > 0 ? static_cast<double>(r.probes) / r.wallSec : 0;
+
+                if (options.json) {
+                    std::cout << std::fixed << std::setprecision(3)
+                              << "{\"mode\": \"" << mode << "\", \"threads\": " << threads
+                              << ", \"targets\": " << targetCount << ", \"live\": " << live.size()
+                              << ", \"wall_seconds\": " << r.wallSec << ", \"cpu_seconds\": " << r.cpuSec
+                              << ", \"probes\": " << r.probes << ", \"probes_per_second\": " << std::setprecision(0) << probesPerSec
+                              << ", \"peak_rss_kb\": " << r.peakRssKb << ", \"found\": " << r.found
+                              << ", \"recall\": " << std::setprecision(4) << recall
+                              << ", \"false_positives\": " << falsePositives << "}" << std::endl;
+                } else {
+                    std::cout << std::fixed << std::left << std::setw(10) << mode << std::right << std::setw(8) << threads
+                              << std::setprecision(2) << std::setw(10) << r.wallSec
+                              << std::setprecision(0) << std::setw(12) << probesPerSec
+                              << std::setprecision(2) << std::setw(10) << r.cpuSec
+                              << std::setprecision(1) << std::setw(12) << static_cast<double>(r.peakRssKb) / 1024
+                              << std::setprecision(3) << std::setw(9) << recall
+                              << std::setw(8) << falsePositives << std::endl;
+                }
+            }
+        }
+        return failures ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << std::endl;
+        return 1;
+    }
+}
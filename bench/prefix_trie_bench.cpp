@@ -0,0 +1,68 @@
+// Lookup throughput of PrefixTrie against a linear CIDR scan.
+
+#include "prefix_trie.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct Prefixes {
+        std::vector<std::pair<uint32_t, uint32_t>> cidrs;   // (prefix, mask)
+        PrefixTrie trie;
+        std::vector<uint32_t> probes;
+    };
+
+    Prefixes makePrefixes(const size_t count) {
+        std::mt19937 gen(42);
+        Prefixes out;
+        for (size_t i = 0; i < count; ++i) {
+            const int len = 16 + static_cast<int>(gen() % 17);
+            const uint32_t mask = ~0U << (32 - len);
+            const uint32_t prefix = gen() & mask;
+            out.cidrs.emplace_back(prefix, mask);
+            out.trie.insert(prefix, len);
+        }
+        out.probes.resize(1 << 16);
+        for (auto& ip : out.probes) ip = gen();
+        return out;
+    }
+
+    void BM_PrefixTrieBuild(benchmark::State& state) {
+        for (auto _ : state) {
+            Prefixes prefixes = makePrefixes(static_cast<size_t>(state.range(0)));
+            benchmark::DoNotOptimize(prefixes.trie.nodeCount());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_PrefixTrieBuild)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+    void BM_PrefixTrieContains(benchmark::State& state) {
+        const Prefixes prefixes = makePrefixes(static_cast<size_t>(state.range(0)));
+        size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(prefixes.trie.contains(prefixes.probes[i++ & (prefixes.probes.size() - 1)]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_PrefixTrieContains)->Arg(1000)->Arg(100000);
+
+    // The baseline the trie replaced: first matching CIDR in a flat list
+    void BM_LinearCidrContains(benchmark::State& state) {
+        const Prefixes prefixes = makePrefixes(static_cast<size_t>(state.range(0)));
+        size_t i = 0;
+        for (auto _ : state) {
+            const uint32_t ip = prefixes.probes[i++ & (prefixes.probes.size() - 1)];
+            bool hit = false;
+            for (const auto& [prefix, mask] : prefixes.cidrs) {
+                if ((ip & mask) == prefix) { hit = true; break; }
+            }
+            benchmark::DoNotOptimize(hit);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_LinearCidrContains)->Arg(1000)->Arg(100000);
+}
@@ -0,0 +1,48 @@
+// Scan engine overhead with probes answered by SimulatedTransport: scheduling,
+// the thread pool, hit bookkeeping and metrics, with no socket in the way.
+
+#include "logger.hpp"
+#include "probe_transport.hpp"
+#include "scanner.hpp"
+#include "target_set.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+    // Sparse like a real sweep: 1% of addresses live, 1 ms median RTT
+    SimulatedTransport::Model sparse() {
+        SimulatedTransport::Model model;
+        model.seed = 42;
+        model.liveFraction = 0.01;
+        model.rttMedianMicros = 1000;
+        return model;
+    }
+
+    void BM_SimulatedScan(benchmark::State& state) {
+        Logger::setLevel(Logger::Level::QUIET);
+        const std::string cidr = "10.0.0.0/" + std::to_string(state.range(0));
+        const TargetSet targets = TargetSet::hostsOf(cidr);
+        const bool thorough = state.range(2) != 0;
+
+        size_t found = 0;
+        for (auto _ : state) {
+            NetworkScanner scanner(static_cast<size_t>(state.range(1)), "tcp", 80, 1000);
+            scanner.setTransport(std::make_shared<SimulatedTransport>(sparse()));
+            found = (thorough ? scanner.thoroughScan(targets) : scanner.scan(targets)).size();
+        }
+        state.counters["hosts_found"] = static_cast<double>(found);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(targets.size()));
+    }
+    BENCHMARK(BM_SimulatedScan)
+        ->ArgNames({"prefix", "threads", "thorough"})
+        ->Args({16, 8, 0})->Args({16, 64, 0})->Args({16, 64, 1})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    // A whole /8 (16M targets) is measured once per run
+    BENCHMARK(BM_SimulatedScan)
+        ->ArgNames({"prefix", "threads", "thorough"})
+        ->Args({8, 64, 0})
+        ->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -9,7 +9,7 @@ _network-scanner_completions() {
 
   # Add mode options
   if [[ ${cur} == --mode=* ]]; then
-    local modes="icmp tcp fallback"
+    local modes="icmp tcp syn arp fallback"
     local prefix=${cur%=*}=
     # shellcheck disable=SC2207
     COMPREPLY=($(compgen -P "$prefix" -W "$modes" -- "${cur#*=}"))
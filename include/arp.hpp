@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ARP sweeping of the directly attached subnet over a packet socket.
+ *
+ * Every host on the link answers ARP, even when it filters ICMP and all TCP
+ * ports, and the reply carries its MAC address. Requests are broadcast on one
+ * AF_PACKET socket bound to the interface and replies are collected by a
+ * receiver thread. Requires root (CAP_NET_RAW) and is only available on Linux.
+ */
+namespace Arp {
+    using MacAddress = std::array<uint8_t, 6>;
+
+    constexpr size_t FRAME_LEN = 42;  // Ethernet header + ARP payload, without padding
+
+    struct Reply {
+        uint32_t ip;
+        MacAddress mac;
+    };
+
+    // Write a broadcast who-has frame for targetIp into buf (addresses in host order), returns its length
+    size_t buildRequest(uint8_t* buf, const MacAddress& srcMac, uint32_t srcIp, uint32_t targetIp);
+
+    // Parse an Ethernet frame; true if it is an ARP reply
+    bool parseReply(const uint8_t* frame, size_t len, Reply& out);
+
+    // "aa:bb:cc:dd:ee:ff"
+    std::string formatMac(const MacAddress& mac);
+
+    class Engine {
+    public:
+        explicit Engine(const std::string& interfaceName, int timeoutMs = 1000);
+        ~Engine();
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        // Whether ip is inside the interface's subnet (only those can answer)
+        [[nodiscard]] bool onLink(uint32_t ip) const;
+
+        // False if the request could not be sent (counted as a probe error)
+        bool send(uint32_t ip);
+
+        // Distinct hosts that have replied so far
+        [[nodiscard]] size_t hostsAnswered() const { return answeredHosts.load(); }
+
+        // Wait one timeout after the last request, stop the receiver and return all replies
+        std::vector<Reply> finish();
+
+    private:
+        void receiveLoop();
+
+        int sockfd = -1;
+        int ifindex = 0;
+        int timeoutMs;
+        MacAddress localMac{};
+        uint32_t localIp = 0;
+        uint32_t netmask = 0;
+
+        std::chrono::steady_clock::time_point lastSend{};
+        std::atomic<bool> stop{false};
+        std::thread receiver;
+        std::mutex repliesMutex;
+        std::set<uint32_t> seen;
+        std::atomic<size_t> answeredHosts{0};
+        std::vector<Reply> replies;
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "target_set.hpp"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+class PrefixTrie;
+class ScanBudget;
+
+/**
+ * Cheap pre-pass that finds which /24 blocks of a large target set show
+ * signs of life before the full scan.
+ *
+ * Each block gets one echo request to its directed-broadcast address (.255)
+ * and one to each sentinel address, the host octets that routers and other
+ * infrastructure conventionally use (DeviceIdentifier::ROUTER_OCTETS and
+ * NETWORK_DEVICE_OCTETS). All requests go out paced from a single ICMP
+ * socket, so surveying a /16 costs a few thousand packets and one timeout.
+ * Blocks with no reply are "silent": the scanner probes them last, or skips
+ * them when pruning is enabled.
+ */
+namespace BlockSurvey {
+    struct Options {
+        int timeoutMs = 1000;
+        double rate = 0;                        // requests per second; 0 = DEFAULT_RATE
+        const PrefixTrie* exclusions = nullptr;
+        ScanBudget* budget = nullptr;           // the survey stops early once it is spent
+    };
+
+    constexpr double DEFAULT_RATE = 2000;
+
+    struct Result {
+        bool ran = false;                 // false if no ICMP socket could be opened
+        uint64_t blocks = 0;
+        uint64_t requests = 0;
+        std::set<uint32_t> liveBlocks;    // block numbers (address >> 8) that answered
+        std::vector<uint32_t> responders; // sorted addresses that answered
+        TargetSet live;                   // targets inside live blocks
+        TargetSet silent;                 // targets inside silent blocks
+    };
+
+    // Block numbers (address >> 8) of every /24 that targets touch, ascending
+    std::vector<uint32_t> blocksOf(const TargetSet& targets);
+
+    // Broadcast and sentinel addresses to probe in a block: only those in targets and not excluded
+    std::vector<uint32_t> probeAddresses(uint32_t block, const TargetSet& targets, const PrefixTrie* exclusions);
+
+    // Fill result.live and result.silent by splitting targets along result.liveBlocks
+    void partition(const TargetSet& targets, Result& result);
+
+    // Survey every block of targets
+    Result run(const TargetSet& targets, const Options& options);
+}
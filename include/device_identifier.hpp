@@ -1,19 +1,45 @@
 #pragma once
 
+#include <cstddef>
+#include <istream>
 #include <string>
 #include <map>
+#include "multicast_discovery.hpp"
+#include "udp_probes.hpp"
 
 class DeviceIdentifier {
 public:
+    // Host octets conventionally given to routers and to other infrastructure in a /24
+    static constexpr int ROUTER_OCTETS[] = {1, 254};
+    static constexpr int NETWORK_DEVICE_OCTETS[] = {10, 20, 50, 100};
+
     DeviceIdentifier();
     std::string identifyDevice(const std::string& ip);
+    [[nodiscard]] std::string serviceName(int port) const;
+
+    // Record a MAC learned during the scan (e.g. from an ARP reply); such hosts are known to be live
+    void setMacAddress(const std::string& ip, const std::string& mac);
+    // MAC from the scan, falling back to the system ARP table; empty if unknown
+    std::string macAddress(const std::string& ip) const;
+    // Names and device types learned from the mDNS/SSDP discovery stage
+    void setDiscoveryHints(std::map<std::string, Discovery::DeviceHint> hints);
+    // NetBIOS/SNMP/NTP answers from the batched UDP probe stage
+    void addUdpResults(const std::map<std::string, UdpProbes::Result>& results);
+    // Add "PREFIX Vendor" lines (nmap-mac-prefixes format); returns the number of entries loaded
+    size_t loadMacVendors(std::istream& in);
+    // Vendor owning the OUI of mac ("aa:bb:cc:..." or "AA-BB-CC-..."); empty if unknown
+    [[nodiscard]] std::string macVendor(const std::string& mac) const;
 
 private:
     std::map<std::string, std::string> macToVendor;
     std::map<int, std::string> portToService;
+    std::map<std::string, std::string> knownMacs;
+    std::map<std::string, Discovery::DeviceHint> discoveryHints;
+    std::map<std::string, UdpProbes::Result> udpResults;
 
     static std::string resolveHostname(const std::string& ip);
     std::string checkCommonServices(const std::string& ip);
+    static bool isDiscoveryPort(int port);
     static std::string identifyByPattern(const std::string& ip);
     bool verifyHost(const std::string& ip);
     std::string lookupMacVendor(const std::string& ip);
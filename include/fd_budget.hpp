@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * Process-wide file descriptor budget for probes.
+ *
+ * The budget is derived from RLIMIT_NOFILE (the soft limit is raised towards
+ * the hard limit on first use) minus a fixed reserve for stdio, libcurl and
+ * the scanner's own long-lived sockets. Every probe holds a Slot while its
+ * socket is open, so in-flight probes can never run the process out of
+ * descriptors regardless of --threads.
+ */
+namespace FdBudget {
+    // Raise the soft RLIMIT_NOFILE as far as allowed; returns the resulting soft limit
+    size_t raiseLimit();
+
+    // Maximum number of probe descriptors that may be open at once
+    size_t capacity();
+
+    // Take (or return) n descriptors at once; a multi-socket probe must not hold some while waiting for others
+    void acquire(size_t n = 1);
+    void release(size_t n = 1);
+
+    class Slot {
+    public:
+        explicit Slot(const size_t n = 1) : count(n) { acquire(count); }
+        ~Slot() { release(count); }
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+    private:
+        size_t count;
+    };
+}
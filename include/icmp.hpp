@@ -1,12 +1,19 @@
 #pragma once
 #include <string>
-#include <atomic>
+#include <cstdint>
 
+namespace Interfaces { struct Interface; }
+
+// via: interface to send from (see Interfaces::bindSocket); nullptr follows the routing table
 namespace Icmp {
     uint16_t checksum(void* data, int len);
-    bool pingRawSocket(const std::string& ip, bool quiet = false, int timeoutMs = 1000);
-    bool pingDatagramSocket(const std::string& ip, bool quiet = false, int timeoutMs = 1000);
-    bool pingFallback(const std::string& ip, bool quiet = false, int timeoutMs = 1000);
-    bool ping(const std::string& ip, std::atomic<int>& counter, int total, bool quiet = false, int timeoutMs = 1000);
-    bool ping(const std::string& ip, bool quiet = false, int timeoutMs = 1000);
+    bool pingRawSocket(const std::string& ip, bool quiet = false, int timeoutMs = 1000, const Interfaces::Interface* via = nullptr);
+    bool pingDatagramSocket(const std::string& ip, bool quiet = false, int timeoutMs = 1000, const Interfaces::Interface* via = nullptr);
+    bool pingFallback(const std::string& ip, bool quiet = false, int timeoutMs = 1000, const Interfaces::Interface* via = nullptr);
+    bool ping(const std::string& ip, bool quiet = false, int timeoutMs = 1000, const Interfaces::Interface* via = nullptr);
+
+    // Send one echo request (datagram socket, raw as fallback); returns the socket to poll for POLLIN, or -1
+    int sendEcho(const std::string& ip, const Interfaces::Interface* via = nullptr);
+    // Read one datagram from a sendEcho socket; true if it is the echo reply from ip
+    bool readEchoReply(int sockfd, const std::string& ip);
 }
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TargetSet;
+
+/**
+ * Local IPv4 interfaces and per-destination socket binding.
+ *
+ * A multi-homed host (Ethernet plus Wi-Fi, VPN, container bridges) has one
+ * directly attached subnet per interface. When all of them are scanned in one
+ * pass, every probe socket is bound to the interface whose subnet contains the
+ * destination, so replies come back on the link the probe left from even when
+ * routes overlap.
+ */
+namespace Interfaces {
+    struct Interface {
+        std::string name;
+        uint32_t address = 0;       // host byte order
+        uint8_t prefixLength = 0;
+
+        [[nodiscard]] uint32_t netmask() const;
+        [[nodiscard]] bool contains(uint32_t ip) const;
+        // "192.168.1.0/24"
+        [[nodiscard]] std::string cidr() const;
+    };
+
+    // Every up, non-loopback interface with an IPv4 address (link-local addresses skipped)
+    std::vector<Interface> list();
+
+    // Usable hosts of every interface subnet, merged
+    TargetSet subnetsOf(const std::vector<Interface>& interfaces);
+
+    /**
+     * Longest-prefix match of destinations onto interface subnets.
+     * Destinations outside all subnets are left to the kernel's routing table.
+     */
+    class Router {
+    public:
+        explicit Router(std::vector<Interface> interfaces);
+
+        // Interface whose subnet contains ip, or nullptr
+        [[nodiscard]] const Interface* route(uint32_t ip) const;
+        [[nodiscard]] const std::vector<Interface>& interfaces() const { return entries; }
+
+    private:
+        std::vector<Interface> entries;  // most specific subnet first
+    };
+
+    /**
+     * Pin a socket to an interface before it sends: SO_BINDTODEVICE where
+     * permitted, and the interface address as source. A null interface is a
+     * no-op. Failures are logged and leave the socket to normal routing.
+     */
+    void bindSocket(int sockfd, const Interface* via);
+}
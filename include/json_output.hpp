@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct NetworkInfo;
+class DeviceIdentifier;
+
+// Open ports per host (only populated when --ports is used)
+using OpenPortMap = std::map<std::string, std::vector<int>>;
+
+// What the block survey found, and what pruning traded away for speed
+struct SurveyReport {
+    bool enabled = false;
+    bool pruned = false;
+    uint64_t blocks = 0;
+    uint64_t liveBlocks = 0;
+    uint64_t silentTargets = 0;
+    size_t hostsInLiveBlocks = 0;   // found hosts the survey had flagged (its recall)
+    size_t hostsFound = 0;
+};
+
+// How far a budgeted scan got, and what cut it short
+struct BudgetReport {
+    uint64_t probesSent = 0;
+    std::string truncatedBy;        // "max-duration", "max-hosts", "max-probes", "interrupt"; empty if complete
+};
+
+/**
+ * The --json report: network info, scan settings, statistics, metrics and
+ * one entry per host, rendered as a single document.
+ */
+namespace JsonOutput {
+    // Escape a string for use inside a JSON string literal
+    std::string escape(const std::string& s);
+
+    std::string render(const NetworkInfo& info, const std::string& mode, int port, size_t threadCount,
+                       bool thoroughScan, int timeoutMs, const std::string& subnet,
+                       const std::vector<std::pair<std::string, std::string>>& hosts,
+                       double durationSec, uint64_t totalScanned,
+                       const std::vector<int>& ports, const OpenPortMap& openPorts, const DeviceIdentifier& deviceId,
+                       uint64_t probesSaved, const SurveyReport& survey, const BudgetReport& budget);
+}
@@ -1,53 +1,81 @@
 #pragma once
-#include <string>
-#include <iostream>
-#include <chrono>
-#include <iomanip>
+#include <atomic>
 #include <sstream>
-#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
+/**
+ * Leveled logging to stderr.
+ *
+ * Messages are passed as pieces (Logger::debug("host ", ip, " port ", port))
+ * and only concatenated once the level check has passed, so a disabled
+ * debug line costs one relaxed load. Each thread appends finished records to
+ * its own lock-free ring; a background writer drains all rings, adds the
+ * timestamps and writes them to stderr in batches. Warnings and errors wake
+ * the writer at once, and error() waits until its line is out. Call flush()
+ * before writing to stderr or stdout directly so output stays in order.
+ */
 namespace Logger {
     enum class Level { QUIET, NORMAL, VERBOSE, DEBUG };
 
-    inline Level currentLevel = Level::NORMAL;
-    inline std::mutex logMutex;
+    inline std::atomic<Level> currentLevel{Level::NORMAL};
 
-    inline void setLevel(Level level) { currentLevel = level; }
+    inline void setLevel(const Level level) { currentLevel.store(level, std::memory_order_relaxed); }
 
-    inline std::string timestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
-        std::ostringstream oss;
-        oss << std::put_time(std::localtime(&time), "%H:%M:%S")
-            << "." << std::setfill('0') << std::setw(3) << ms.count();
-        return oss.str();
-    }
+    inline bool enabled(const Level level) { return currentLevel.load(std::memory_order_relaxed) >= level; }
 
-    inline void debug(const std::string& msg) {
-        if (currentLevel >= Level::DEBUG) {
-            std::lock_guard<std::mutex> lock(logMutex);
-            std::cerr << "[" << timestamp() << " DBG] " << msg << std::endl;
+    // Queue a finished message on the calling thread's ring (blocks only while the ring is full)
+    void submit(Level level, std::string message);
+
+    // Wait until everything submitted so far, from any thread, has been written
+    void flush();
+
+    namespace detail {
+        template <typename T>
+        void append(std::string& out, const T& piece) {
+            using Piece = std::decay_t<T>;
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                out += std::string_view(piece);
+            } else if constexpr (std::is_same_v<Piece, char>) {
+                out += piece;
+            } else if constexpr (std::is_same_v<Piece, bool>) {
+                out += piece ? "true" : "false";
+            } else if constexpr (std::is_arithmetic_v<Piece>) {
+                out += std::to_string(piece);
+            } else {
+                std::ostringstream stream;
+                stream << piece;
+                out += stream.str();
+            }
         }
-    }
 
-    inline void verbose(const std::string& msg) {
-        if (currentLevel >= Level::VERBOSE) {
-            std::lock_guard<std::mutex> lock(logMutex);
-            std::cerr << "[" << timestamp() << " INF] " << msg << std::endl;
+        template <typename... Args>
+        std::string format(const Args&... pieces) {
+            std::string out;
+            (append(out, pieces), ...);
+            return out;
         }
     }
 
-    inline void warn(const std::string& msg) {
-        if (currentLevel >= Level::NORMAL) {
-            std::lock_guard<std::mutex> lock(logMutex);
-            std::cerr << "[" << timestamp() << " WRN] " << msg << std::endl;
-        }
+    template <typename... Args>
+    void debug(const Args&... pieces) {
+        if (enabled(Level::DEBUG)) submit(Level::DEBUG, detail::format(pieces...));
+    }
+
+    template <typename... Args>
+    void verbose(const Args&... pieces) {
+        if (enabled(Level::VERBOSE)) submit(Level::VERBOSE, detail::format(pieces...));
+    }
+
+    template <typename... Args>
+    void warn(const Args&... pieces) {
+        if (enabled(Level::NORMAL)) submit(Level::NORMAL, detail::format(pieces...));
     }
 
-    inline void error(const std::string& msg) {
-        std::lock_guard<std::mutex> lock(logMutex);
-        std::cerr << "[" << timestamp() << " ERR] " << msg << std::endl;
+    template <typename... Args>
+    void error(const Args&... pieces) {
+        submit(Level::QUIET, detail::format(pieces...));
     }
 }
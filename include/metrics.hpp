@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/**
+ * Process-wide scan counters.
+ *
+ * Every thread that records a value gets its own cache-line aligned shard, so
+ * the probe hot path is a single uncontended relaxed store with no lock and
+ * no line shared with another core. Shards outlive their threads (they are
+ * recycled, never cleared), and snapshot() sums all of them. Counters only
+ * grow: callers that want a per-stage figure subtract two snapshots.
+ *
+ * Probes with a round trip (ICMP echo, TCP connect, and whatever the device
+ * identification stage sends) also land in a per-type log-linear latency
+ * histogram: eight linear sub-buckets per power of two of microseconds, so
+ * any quantile is within 12.5% of the true value at a fixed 1.5 KB per type.
+ */
+namespace Metrics {
+    enum class Counter : size_t {
+        ProbesSent,   // host/port attempts and raw packets put on the wire
+        Replies,      // probes the target answered
+        Timeouts,     // probes with no answer within the timeout
+        Errors,       // probes that could not be sent or failed locally
+        HostsFound,   // live hosts reported by a scan stage
+        JobsDone,     // units of stage progress (targets probed or skipped, hosts identified)
+        Count
+    };
+
+    constexpr size_t COUNTERS = static_cast<size_t>(Counter::Count);
+
+    enum class ProbeType : size_t { Icmp, Tcp, Identify, Count };
+    constexpr size_t PROBE_TYPES = static_cast<size_t>(ProbeType::Count);
+
+    enum class Outcome { Reply, Timeout, Error };
+
+    // Histogram layout: values below 8 us are exact, then 8 sub-buckets per octave up to 2^26 us (~67 s)
+    constexpr int SUB_BUCKET_BITS = 3;
+    constexpr int MAX_OCTAVE = 25;
+    constexpr size_t BUCKETS = static_cast<size_t>(MAX_OCTAVE - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+    // Bucket of a latency in microseconds (values past the last octave share the last bucket)
+    size_t bucketOf(uint64_t micros);
+    // Smallest latency (microseconds) that falls into bucket
+    uint64_t bucketLowerBound(size_t bucket);
+
+    // Cache-line size assumed for padding; 64 bytes on every platform we build for
+    constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) Shard {
+        std::array<std::atomic<uint64_t>, COUNTERS> counters{};
+
+        struct Latency {
+            std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+            std::atomic<uint64_t> timeouts{0};
+            std::atomic<uint64_t> errors{0};
+            std::atomic<uint64_t> maxMicros{0};
+            std::atomic<uint64_t> sumMicros{0};
+        };
+        std::array<Latency, PROBE_TYPES> latency{};
+    };
+
+    // The calling thread's shard, registered on first use
+    Shard& localShard();
+
+    inline void add(const Counter counter, const uint64_t n = 1) {
+        // Only the owning thread writes a shard, so load + store needs no read-modify-write
+        auto& value = localShard().counters[static_cast<size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Count one probe of type with its outcome (ProbesSent plus Replies,
+     * Timeouts or Errors) and, for replies, its round-trip time. Inside a
+     * StageScope the probe is filed under the scope's type instead.
+     */
+    void recordProbe(ProbeType type, Outcome outcome, std::chrono::microseconds rtt = std::chrono::microseconds(0));
+
+    // Files every probe this thread records under one type while alive (e.g. the identification stage)
+    class StageScope {
+    public:
+        explicit StageScope(ProbeType type);
+        ~StageScope();
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+
+    private:
+        int previous;
+    };
+
+    // Latencies of one probe type, summed over threads
+    struct Histogram {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t replies = 0;
+        uint64_t timeouts = 0;
+        uint64_t errors = 0;
+        uint64_t maxMicros = 0;
+        uint64_t sumMicros = 0;
+
+        void add(uint64_t micros);
+        // Latency (microseconds) at quantile q in [0, 1]: upper edge of its bucket, capped at the maximum
+        [[nodiscard]] uint64_t quantile(double q) const;
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, COUNTERS> values{};
+        std::array<Histogram, PROBE_TYPES> latency{};
+
+        uint64_t operator[](const Counter counter) const { return values[static_cast<size_t>(counter)]; }
+        const Histogram& operator[](const ProbeType type) const { return latency[static_cast<size_t>(type)]; }
+        // Per-counter difference from an earlier snapshot (latency histograms are kept as they are)
+        [[nodiscard]] Snapshot since(const Snapshot& earlier) const;
+    };
+
+    // Sum of every shard
+    Snapshot snapshot();
+
+    // "probes_sent", "replies", "timeouts", "errors", "hosts_found", "jobs_done"
+    const char* name(Counter counter);
+    // "icmp", "tcp", "identify"
+    const char* name(ProbeType type);
+
+    // {"probes_sent": 12, ...} on one line
+    std::string toJson(const Snapshot& snapshot);
+    // {"icmp": {"replies": 3, "timeouts": 1, "errors": 0, "p50_ms": 0.42, ...}, ...}, one type per line at indent
+    std::string latencyJson(const Snapshot& snapshot, int indent);
+
+    /**
+     * The one progress line on stderr: a bar over `total` jobs, job rate, ETA
+     * and hosts found, all read from snapshots taken every 100 ms. Counts
+     * start from zero at construction; the line is cleared on destruction.
+     */
+    class Reporter {
+    public:
+        Reporter(std::string label, uint64_t total, bool enabled = true);
+        ~Reporter();
+        Reporter(const Reporter&) = delete;
+        Reporter& operator=(const Reporter&) = delete;
+
+        // The progress line for `stage` after `elapsed`, without the leading carriage return
+        static std::string format(const std::string& label, const Snapshot& stage, uint64_t total,
+                                  std::chrono::duration<double> elapsed);
+
+    private:
+        void loop();
+
+        std::string label;
+        uint64_t total;
+        Snapshot baseline;
+        std::chrono::steady_clock::time_point start;
+        std::atomic<bool> done{false};
+        std::thread thread;
+    };
+}
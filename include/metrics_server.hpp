@@ -0,0 +1,46 @@
+#pragma once
+#include "metrics.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/**
+ * Prometheus exposition of the scan metrics.
+ *
+ * A single background thread answers GET /metrics with the counters and the
+ * per-type latency histograms, rendered from a snapshot taken per request.
+ * Nothing is added to the probe path: scrapes only read the shards that the
+ * probes already write.
+ */
+namespace Metrics {
+    // Counters and histograms in the Prometheus text format (version 0.0.4)
+    std::string prometheusText(const Snapshot& snapshot);
+
+    class Server {
+    public:
+        /**
+         * Listen on "ADDR:PORT" (":PORT" for every address; port 0 picks a free one).
+         *
+         * @throws std::invalid_argument if listen is malformed
+         * @throws std::runtime_error if the address cannot be bound
+         */
+        explicit Server(const std::string& listen);
+        ~Server();
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // The bound port (useful after asking for port 0)
+        [[nodiscard]] uint16_t port() const { return boundPort; }
+
+    private:
+        void loop();
+        void serve(int client) const;
+
+        int listenFd = -1;
+        uint16_t boundPort = 0;
+        std::atomic<bool> done{false};
+        std::thread thread;
+    };
+}
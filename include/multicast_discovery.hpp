@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Bulk device identification over mDNS and SSDP.
+ *
+ * One DNS-SD query (several PTR questions in a single packet) and one SSDP
+ * M-SEARCH go out at the start of the scan; every device that answers in the
+ * listening window is mapped to a host name and a device type. This replaces
+ * guessing the same devices with per-host TCP connects to service ports.
+ */
+namespace Discovery {
+    struct DeviceHint {
+        std::string hostname;
+        std::string deviceType;
+    };
+
+    // Records of interest in one mDNS response
+    struct MdnsRecords {
+        std::vector<std::string> services;  // service type names seen (PTR owners/targets, SRV owners)
+        std::string hostname;               // from the first A or SRV target, ".local" stripped
+    };
+
+    // mDNS query asking for PTR records of each of the given names
+    std::vector<uint8_t> buildMdnsQuery(const std::vector<std::string>& names);
+
+    // Parse a DNS message (name compression supported); false if malformed
+    bool parseMdnsResponse(const uint8_t* msg, size_t len, MdnsRecords& out);
+
+    // Device type for a set of advertised DNS-SD services; empty if none is recognised
+    std::string classifyServices(const std::vector<std::string>& services);
+
+    // Device type from an SSDP response (status line and headers); empty if unrecognised
+    std::string classifySsdpResponse(const std::string& response);
+
+    /**
+     * Send both queries from localIp's interface and listen for windowMs.
+     *
+     * @return Hints keyed by the responder's IPv4 address
+     */
+    std::map<std::string, DeviceHint> run(const std::string& localIp, int windowMs = 1500);
+}
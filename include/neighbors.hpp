@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * The kernel's IPv4 neighbor (ARP) table.
+ *
+ * Read before a scan, it tells us which local-link hosts were recently seen
+ * alive and which failed address resolution, without sending anything.
+ * Linux uses an rtnetlink dump and falls back to /proc/net/arp.
+ */
+namespace Neighbors {
+    enum class State {
+        Alive,   // REACHABLE, STALE, DELAY or PROBE: recently answered
+        Failed,  // FAILED or INCOMPLETE: did not answer resolution
+        Other    // PERMANENT, NOARP, ...: says nothing about liveness
+    };
+
+    struct Entry {
+        uint32_t ip;
+        std::string mac;  // empty when unresolved
+        State state;
+    };
+
+    // Parse the contents of /proc/net/arp (header line included)
+    std::vector<Entry> parseProcArp(std::istream& in);
+
+    // Parse one RTM_NEWNEIGH payload (struct ndmsg + attributes); false if not an IPv4 entry
+    bool parseNeighborMessage(const void* payload, size_t len, Entry& out);
+
+    // Current table; empty if neither netlink nor /proc/net/arp is available
+    std::vector<Entry> dump();
+}
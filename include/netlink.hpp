@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Minimal rtnetlink dump client (Linux only).
+ *
+ * Sends one NLM_F_DUMP request on a NETLINK_ROUTE socket and hands the
+ * payload of every reply message to a callback until NLMSG_DONE. Callers
+ * parse the payload themselves (ndmsg, ifaddrmsg, rtmsg, ...), so this
+ * header stays free of Linux-specific types.
+ */
+namespace Netlink {
+    using MessageHandler = std::function<void(uint16_t type, const void* payload, size_t len)>;
+
+    // Dump request of the given type (e.g. RTM_GETNEIGH) with a family-specific request body.
+    // Returns false if netlink is unavailable or the dump failed.
+    bool dump(uint16_t type, const void* request, size_t requestLen, const MessageHandler& onMessage);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <future>
 #include <string>
 
 struct NetworkInfo {
@@ -11,18 +13,74 @@ struct NetworkInfo {
 };
 
 /**
- * Get network information including local IP, gateway IP, and public IP
+ * Get local network information: interface, local IP, subnet mask and gateway.
  *
- * @return NetworkInfo structure with network details
+ * On Linux this is two rtnetlink dumps (default route, then addresses), with
+ * getifaddrs() and /proc/net/route as the fallback. The public IP is not
+ * looked up here (see PublicIpLookup), so this returns in milliseconds.
+ *
+ * @return NetworkInfo structure with network details (publicIp left empty)
  */
 NetworkInfo getNetworkInfo();
 
 /**
  * Get public IP address using an external service
  *
- * @return String containing the public IP address
+ * @param cancel Optional flag that aborts the request when set
+ * @return String containing the public IP address, or "Error: ..." on failure
+ */
+std::string getPublicIP(const std::atomic<bool>* cancel = nullptr);
+
+/**
+ * Location of the public IP cache: $XDG_CACHE_HOME/network-scanner/public_ip,
+ * or ~/.cache/network-scanner/public_ip. Empty if neither variable is set.
  */
-std::string getPublicIP();
+std::string publicIpCachePath();
+
+/**
+ * Read a cached public IP written by writeCachedPublicIP
+ *
+ * @param path Cache file
+ * @param ttlSeconds Maximum age of the entry
+ * @return The cached address, or an empty string if missing, stale or malformed
+ */
+std::string readCachedPublicIP(const std::string& path, long ttlSeconds);
+
+/**
+ * Store a public IP with the current time. Only valid IPv4 addresses are
+ * written, so lookup errors are never cached.
+ *
+ * @return true if the entry was written
+ */
+bool writeCachedPublicIP(const std::string& path, const std::string& ip);
+
+/**
+ * Public IP lookup that runs alongside the scan.
+ *
+ * A fresh cache entry is served immediately; otherwise the HTTP request runs
+ * on a background thread and refreshes the cache on success. Destroying the
+ * lookup aborts a request still in flight, so exiting never waits on it.
+ */
+class PublicIpLookup {
+public:
+    static constexpr long DEFAULT_TTL_SECONDS = 3600;
+
+    explicit PublicIpLookup(long ttlSeconds = DEFAULT_TTL_SECONDS, std::string cachePath = publicIpCachePath());
+    ~PublicIpLookup();
+
+    PublicIpLookup(const PublicIpLookup&) = delete;
+    PublicIpLookup& operator=(const PublicIpLookup&) = delete;
+
+    // True once the address (or an error) is available without blocking
+    [[nodiscard]] bool ready() const;
+    // The address or "Error: ..."; waits for the request if it is still running
+    [[nodiscard]] std::string get();
+
+private:
+    std::string cachePath;
+    std::atomic<bool> cancelled{false};
+    std::shared_future<std::string> result;
+};
 
 /**
  * Convert IP address to CIDR notation based on subnet mask
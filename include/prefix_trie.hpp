@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Path-compressed binary (Patricia) trie of IPv4 prefixes.
+ *
+ * Membership checks walk at most 32 nodes regardless of how many prefixes are
+ * stored, which keeps per-probe deny-list checks cheap even with security
+ * team exclusion lists of 100k+ entries. Nodes live in one contiguous vector
+ * and reference children by index (16 bytes per node).
+ */
+class PrefixTrie {
+public:
+    // Insert a CIDR block such as "10.0.0.0/8" (parsed with Utils::parseCIDR)
+    void insert(const std::string& cidr);
+    void insert(uint32_t prefix, int length);
+    // Insert an arbitrary inclusive range, decomposed into the minimal set of prefixes
+    void insertRange(uint32_t first, uint32_t last);
+
+    [[nodiscard]] bool contains(uint32_t ip) const;
+    [[nodiscard]] bool empty() const { return nodes.empty(); }
+    [[nodiscard]] size_t prefixCount() const { return prefixes; }
+    [[nodiscard]] size_t nodeCount() const { return nodes.size(); }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        uint32_t prefix;
+        uint32_t child[2];
+        uint8_t length;
+        bool terminal;
+    };
+
+    uint32_t newNode(uint32_t prefix, int length, bool terminal);
+
+    std::vector<Node> nodes;
+    uint32_t root = NONE;
+    size_t prefixes = 0;
+};
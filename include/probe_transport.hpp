@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Interfaces { struct Interface; }
+
+/**
+ * Where the scanner's connect-style probes go: ICMP echo, TCP connect and the
+ * thorough scan's multi-probe verification. sockets() sends real packets
+ * through Icmp and Tcp; SimulatedTransport answers from a seeded model, so
+ * the scheduling and bookkeeping around probes can be benchmarked at /8 scale
+ * and tested without a network. SYN and ARP sweeps use their own raw-socket
+ * engines and do not go through a transport.
+ *
+ * Implementations record every probe in Metrics like the socket probes do.
+ */
+class ProbeTransport {
+public:
+    virtual ~ProbeTransport() = default;
+
+    // ICMP echo; true if ip answered within timeoutMs
+    virtual bool echo(uint32_t ip, const std::string& ipStr, int timeoutMs, const Interfaces::Interface* via) = 0;
+    // TCP connect; true if the handshake completed (a refusal is an answer, but not an open port)
+    virtual bool connect(uint32_t ip, const std::string& ipStr, int port, int timeoutMs,
+                         const Interfaces::Interface* via) = 0;
+    /**
+     * One echo plus a connect to each of ports, all in flight at once; true
+     * when at least quorum of them succeeded within timeoutMs.
+     */
+    virtual bool verify(uint32_t ip, const std::string& ipStr, const std::vector<int>& ports, int quorum,
+                        int timeoutMs, const Interfaces::Interface* via) = 0;
+
+    // The real network, shared by every scanner without a transport of its own
+    static ProbeTransport& sockets();
+};
+
+/**
+ * A deterministic network for engine benchmarks and tests.
+ *
+ * Every property is a hash of the seed and the address, so two scans with the
+ * same model see the same network regardless of thread count or probe order.
+ * Probes never sleep: a reply whose RTT exceeds the probe's timeout is a
+ * timeout, which is what the scanner would have observed. Repeated probes of
+ * the same host and port are numbered, so a retry can draw a different
+ * outcome (loss, jitter) than the first attempt, again deterministically.
+ */
+class SimulatedTransport final : public ProbeTransport {
+public:
+    struct Model {
+        uint64_t seed = 1;
+        double liveFraction = 0.01;      // addresses with a host behind them
+        double echoFraction = 0.8;       // live hosts that answer ICMP echo
+        std::vector<int> ports = {80, 443, 22};
+        double portFraction = 0.5;       // chance each of ports is open on a live host; the rest refuse
+        uint32_t rttMedianMicros = 2000; // median across hosts, log-normally distributed
+        double rttSpread = 0.5;          // sigma of the host median's log-normal
+        double rttJitter = 0.1;          // sigma of each probe around its host's median
+        double loss = 0;                 // chance any single probe or its reply is dropped
+        uint32_t replyLimit = 0;         // replies a host sends per probe type before going silent; 0 = unlimited
+    };
+
+    explicit SimulatedTransport(Model model);
+
+    bool echo(uint32_t ip, const std::string& ipStr, int timeoutMs, const Interfaces::Interface* via) override;
+    bool connect(uint32_t ip, const std::string& ipStr, int port, int timeoutMs,
+                 const Interfaces::Interface* via) override;
+    bool verify(uint32_t ip, const std::string& ipStr, const std::vector<int>& ports, int quorum, int timeoutMs,
+                const Interfaces::Interface* via) override;
+
+    // Ground truth, for scoring a scan
+    [[nodiscard]] bool alive(uint32_t ip) const;
+    [[nodiscard]] bool answersEcho(uint32_t ip) const;
+    [[nodiscard]] bool portOpen(uint32_t ip, int port) const;
+    // Median round trip of ip in microseconds (0 if nothing lives there)
+    [[nodiscard]] uint32_t rttMicros(uint32_t ip) const;
+
+    // Probes sent so far (echo, connect and each probe of a verify)
+    [[nodiscard]] uint64_t probes() const { return probeCount.load(std::memory_order_relaxed); }
+
+private:
+    enum class Kind : uint8_t { Echo, Connect };
+    enum class Answer { Reply, Refused, Timeout };
+
+    Answer probe(uint32_t ip, Kind kind, int port, int timeoutMs);
+    // Attempt number of this probe of (ip, kind, port), starting at 0; only live hosts are tracked
+    uint32_t nextAttempt(uint32_t ip, Kind kind, int port);
+    // Spend one of ip's replies of kind; false once replyLimit is used up
+    bool takeReply(uint32_t ip, Kind kind);
+    // Count one more under key; returns the count before this one
+    uint32_t bump(uint64_t key);
+
+    static constexpr size_t SHARDS = 64;
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> attempts;
+    };
+
+    Model model;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<uint64_t> probeCount{0};
+};
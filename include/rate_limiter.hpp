@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+
+/**
+ * Token-bucket pacer for packet senders.
+ *
+ * acquire() blocks until the next packet may go out, so a sender loop emits
+ * at most `ratePerSecond` packets per second on average with bursts of up to
+ * `burst` packets. A rate of 0 disables pacing. Safe to share across threads.
+ */
+class RateLimiter {
+public:
+    explicit RateLimiter(double ratePerSecond = 0, double burst = 16);
+
+    void acquire();
+    [[nodiscard]] double rate() const { return ratePerSecond; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double ratePerSecond;
+    double burst;
+    double tokens;
+    Clock::time_point last;
+    std::mutex mutex;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Limits on how long a scan runs, how many probes it sends and how many hosts
+ * it looks for.
+ *
+ * Senders call acquire() before each probe. Once any limit is reached the
+ * budget is spent for good: no new probe starts, probes already in flight
+ * still get their timeout to answer, and the scan returns what it found. A
+ * probe is one host (or host:port) attempt, whatever packets it takes. Limits
+ * of zero are unlimited. Safe to share across threads.
+ */
+class ScanBudget {
+public:
+    enum class Limit { None, Duration, Hosts, Probes };
+
+    struct Limits {
+        std::chrono::milliseconds maxDuration{0};
+        uint64_t maxHosts = 0;
+        uint64_t maxProbes = 0;
+    };
+
+    ScanBudget();
+    explicit ScanBudget(const Limits& limits);
+
+    // Claim one probe; false once any limit is reached
+    bool acquire();
+    // Count newly found live hosts
+    void addHosts(uint64_t count = 1);
+    // True once any limit is reached (checks the clock)
+    bool exhausted();
+
+    // The limit that stopped the scan, or None
+    [[nodiscard]] Limit reason() const { return static_cast<Limit>(tripped.load()); }
+    [[nodiscard]] uint64_t probes() const { return issued.load(); }
+    [[nodiscard]] uint64_t hosts() const { return found.load(); }
+
+    // "max-duration", "max-hosts", "max-probes"; empty for None
+    static std::string describe(Limit limit);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void trip(Limit limit);
+
+    Limits limits;
+    Clock::time_point deadline;
+    std::atomic<uint64_t> issued{0};
+    std::atomic<uint64_t> found{0};
+    std::atomic<int> tripped{static_cast<int>(Limit::None)};
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Hosts seen alive by earlier scans, kept in the user's cache directory.
+ *
+ * A host that answered last time is the best predictor of one that answers
+ * now, so the scheduler probes these first. The file is one "address
+ * last-seen-unix-time" pair per line; entries not seen for maxAge are
+ * dropped on load and never written back.
+ */
+namespace ScanHistory {
+    constexpr long DEFAULT_MAX_AGE_SECONDS = 30L * 24 * 3600;
+
+    // Utils::cachePath("hosts")
+    std::string defaultPath();
+
+    // Address -> last seen, without entries older than maxAgeSeconds at `now`
+    std::map<uint32_t, long long> parse(std::istream& in, long long now, long maxAgeSeconds);
+
+    // Sorted addresses from the history file; empty if it is missing
+    std::vector<uint32_t> load(const std::string& path, long maxAgeSeconds = DEFAULT_MAX_AGE_SECONDS);
+
+    // Mark hosts as seen now and rewrite the file
+    bool record(const std::string& path, const std::vector<uint32_t>& hosts, long maxAgeSeconds = DEFAULT_MAX_AGE_SECONDS);
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include "target_set.hpp"
+#include "prefix_trie.hpp"
+#include "scan_budget.hpp"
+#include "metrics.hpp"
+#include "usdt.hpp"
+#include "thread_pool.hpp"
+#include "signal_handler.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * The one scan loop shared by every connect-style scan.
+ *
+ * A scan is the matrix of targets x ports (host-only probes use a single
+ * placeholder port) walked port-major, so consecutive jobs hit different
+ * hosts. The probe strategy is a template parameter: each scan mode is
+ * resolved once per scan to a concrete type, and the per-job hot path is a
+ * direct (inlinable) call with no string comparison or virtual dispatch.
+ *
+ * A Probe is any callable `bool(uint32_t ip, const std::string& ipStr, int port)`.
+ *
+ * An optional ScanBudget bounds the scan: once it is spent no further job is
+ * queued or started, and the jobs already running finish within their own
+ * timeout, so the hits returned are always complete for what was probed.
+ */
+namespace ScanPipeline {
+    struct Hit {
+        uint32_t ip;
+        int port;
+
+        bool operator<(const Hit& other) const {
+            return ip != other.ip ? ip < other.ip : port < other.port;
+        }
+    };
+
+    // Upper bound on queued probe tasks per worker; keeps memory flat for huge target sets
+    constexpr size_t QUEUE_DEPTH_PER_THREAD = 64;
+
+    /**
+     * Visit every (ip, port) job tier by tier, port-major within a tier,
+     * skipping excluded addresses. Tiers must be disjoint; earlier tiers hold
+     * the targets most likely to answer. Stops early on Ctrl+C or once budget
+     * is spent. Returns the number of jobs skipped by the deny list.
+     */
+    template <typename Fn>
+    uint64_t forEachJob(const std::vector<TargetSet>& tiers, const std::vector<int>& ports, const PrefixTrie* exclusions,
+                        ScanBudget* budget, Fn&& fn) {
+        const auto stopped = [budget] { return SignalHandler::isInterrupted() || (budget && budget->exhausted()); };
+        uint64_t skipped = 0;
+        for (const auto& tier : tiers) {
+            for (const int port : ports) {
+                for (const auto& [first, last] : tier.ranges()) {
+                    for (uint64_t ip = first; ip <= last && !stopped(); ++ip) {
+                        if (exclusions && exclusions->contains(static_cast<uint32_t>(ip))) {
+                            ++skipped;
+                            continue;
+                        }
+                        fn(static_cast<uint32_t>(ip), port);
+                    }
+                }
+            }
+        }
+        return skipped;
+    }
+
+    template <typename Fn>
+    uint64_t forEachJob(const TargetSet& targets, const std::vector<int>& ports, const PrefixTrie* exclusions,
+                        ScanBudget* budget, Fn&& fn) {
+        return forEachJob(std::vector<TargetSet>{targets}, ports, exclusions, budget, std::forward<Fn>(fn));
+    }
+
+    /**
+     * Run probe over each tier's targets x ports, in tier order, on one pool of `threads` workers.
+     *
+     * @return Successful jobs sorted by address, then port
+     */
+    template <typename Probe>
+    std::vector<Hit> run(const std::vector<TargetSet>& tiers, const std::vector<int>& ports, const size_t threads,
+                         const PrefixTrie* exclusions, ScanBudget* budget, const Probe& probe) {
+        std::vector<Hit> hits;
+        uint64_t total = 0;
+        for (const auto& tier : tiers) total += tier.size() * ports.size();
+        if (total == 0) return hits;
+
+        std::atomic<uint64_t> counter = 0;
+        uint64_t queued = 0;
+        std::mutex hitsMutex;
+        std::unordered_set<uint32_t> liveHosts;
+
+        {
+            Metrics::Reporter progress("SCAN", total);
+            ThreadPool pool(threads, threads * QUEUE_DEPTH_PER_THREAD);
+
+            // Tiers share one pool: a small first tier never idles workers waiting on its timeouts
+            const uint64_t skipped = forEachJob(tiers, ports, exclusions, budget, [&](const uint32_t ip, const int port) {
+                ++queued;
+                pool.enqueue([ip, port, budget, &counter, &hitsMutex, &hits, &liveHosts, &probe] {
+                    // Jobs still queued when the budget runs out are dropped, not probed
+                    const auto finish = [&counter] {
+                        Metrics::add(Metrics::Counter::JobsDone);
+                        ++counter;
+                    };
+                    if (SignalHandler::isInterrupted() || (budget && !budget->acquire())) { finish(); return; }
+
+                    const std::string ipStr = Utils::uintToIp(ip);
+                    const bool success = probe(ip, ipStr, port);
+
+                    finish();
+
+                    if (success) {
+                        if (port) Logger::debug("Probe hit: ", ipStr, ":", port);
+                        else Logger::debug("Probe hit: ", ipStr);
+                        std::lock_guard<std::mutex> lock(hitsMutex);
+                        hits.push_back({ip, port});
+                        if (liveHosts.insert(ip).second) {
+                            SCANNER_PROBE(host_found, ipStr.c_str());
+                            Metrics::add(Metrics::Counter::HostsFound);
+                            if (budget) budget->addHosts();
+                        }
+                    }
+                });
+            });
+            counter += skipped;
+            Metrics::add(Metrics::Counter::JobsDone, skipped);
+
+            // In-flight probes finish within their timeout even after the budget is spent
+            while (counter < skipped + queued && !SignalHandler::isInterrupted()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+
+            if (SignalHandler::isInterrupted()) {
+                pool.shutdown();
+                Logger::verbose("Scan interrupted by user");
+            }
+            // Pool destructor joins the workers before hits is read
+        }
+
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    template <typename Probe>
+    std::vector<Hit> run(const TargetSet& targets, const std::vector<int>& ports, const size_t threads,
+                         const PrefixTrie* exclusions, ScanBudget* budget, const Probe& probe) {
+        return run(std::vector<TargetSet>{targets}, ports, threads, exclusions, budget, probe);
+    }
+}
@@ -3,27 +3,115 @@
 #include <cstddef>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+class TargetSet;
+class PrefixTrie;
+class RateLimiter;
+class ScanBudget;
+class ProbeTransport;
+namespace Interfaces { class Router; struct Interface; }
+namespace BlockSurvey { struct Result; }
+
+struct HostPorts {
+    std::string ip;
+    std::vector<int> openPorts;
+};
+
+struct HostMac {
+    std::string ip;
+    std::string mac;
+};
+
+// What the kernel neighbor table knew before the scan started
+struct NeighborHints {
+    std::unordered_set<uint32_t> alive;   // reported live without probing
+    std::unordered_set<uint32_t> failed;  // probed with a shortened timeout
+};
+
+enum class ScanMode { Icmp, Tcp, Fallback, Syn, Arp };
+
+// Map a --mode value to ScanMode; throws std::invalid_argument for unknown modes
+ScanMode parseScanMode(const std::string& mode);
 
 class Scanner {
 public:
-    explicit Scanner(size_t threads = 0, std::string mode = "icmp", int port = 80, int timeoutMs = 1000);
+    explicit Scanner(size_t threads = 0, const std::string& mode = "icmp", int port = 80, int timeoutMs = 1000);
     virtual void run(const std::string& cidr) const;
     virtual ~Scanner() = default;
 
+    // Addresses matching this deny list are never probed, whatever produced them
+    void setExclusions(std::shared_ptr<const PrefixTrie> trie);
+    // Interface for link-layer (ARP) sweeps
+    void setInterface(const std::string& name);
+    // Probe rate shared by the whole scan (packets for SYN/ARP, probe starts otherwise); 0 = mode default
+    void setRate(double packetsPerSecond);
+    // Scan several directly attached subnets at once: each probe leaves from the interface owning its target
+    void setInterfaces(std::shared_ptr<const Interfaces::Router> router);
+    // Pre-seed host discovery from the neighbor table
+    void setNeighborHints(std::shared_ptr<const NeighborHints> hints);
+    // Probe blocks that answered the survey first; with pruneSilent, never probe the silent ones
+    void setBlockSurvey(std::shared_ptr<const BlockSurvey::Result> survey, bool pruneSilent);
+    // Hosts to probe before all others (seen by earlier scans, listed in the neighbor table, gateways)
+    void setPriorityHosts(std::shared_ptr<const TargetSet> hosts);
+    // Stop issuing probes once the budget is spent; results cover what was probed
+    void setBudget(std::shared_ptr<ScanBudget> limits);
+    // Send ICMP/TCP probes (not SYN or ARP sweeps) through this transport instead of real sockets
+    void setTransport(std::shared_ptr<ProbeTransport> probes);
+
 protected:
+    // Host discovery over targets with the configured mode; sorted live addresses
+    [[nodiscard]] std::vector<uint32_t> discover(const TargetSet& targets) const;
+    // Half-open sweep of targets x ports; maps every responding host to its open ports.
+    // openOnly: only hosts with an open port count towards the budget's host limit.
+    [[nodiscard]] std::map<uint32_t, std::vector<int>> synScan(const TargetSet& targets, const std::vector<int>& ports,
+                                                              bool openOnly) const;
+    // ARP sweep of the on-link part of targets; maps every responding host to its MAC
+    [[nodiscard]] std::map<uint32_t, std::string> arpSweep(const TargetSet& targets) const;
+
+    // Targets minus the hosts the neighbor table already knows are alive (returned sorted in knownAlive)
+    [[nodiscard]] TargetSet withoutKnownAlive(const TargetSet& targets, std::vector<uint32_t>& knownAlive) const;
+    /**
+     * Targets split into disjoint tiers, most likely to answer first: priority
+     * hosts, then router-like addresses (.1, .254, ...), then the rest, then
+     * blocks the survey found silent (dropped when pruning).
+     */
+    [[nodiscard]] std::vector<TargetSet> schedule(const TargetSet& targets) const;
+    // The configured transport, or the real network
+    [[nodiscard]] ProbeTransport* probeTransport() const;
+
+    std::shared_ptr<const PrefixTrie> exclusions;
+    std::shared_ptr<const NeighborHints> neighbors;
+    std::shared_ptr<const Interfaces::Router> router;
+    std::shared_ptr<const BlockSurvey::Result> survey;
+    std::shared_ptr<const TargetSet> priorityHosts;
+    std::shared_ptr<ScanBudget> budget;
+    std::shared_ptr<ProbeTransport> transport;
+    bool pruneSilent = false;
+    std::string interfaceName;
+    double rate = 0;
     size_t threadCount;
-    std::string mode;
+    ScanMode mode;
     int port;
     int timeoutMs;
 };
 
 class NetworkScanner final : public Scanner {
 public:
-    explicit NetworkScanner(size_t threads = 0, std::string mode = "icmp", int port = 80, int timeoutMs = 1000);
+    explicit NetworkScanner(size_t threads = 0, const std::string& mode = "icmp", int port = 80, int timeoutMs = 1000);
     [[nodiscard]] std::vector<std::string> scan(const std::string& cidr) const;
+    [[nodiscard]] std::vector<std::string> scan(const TargetSet& targets) const;
     [[nodiscard]] std::vector<std::string> thoroughScan(const std::string& cidr) const;
+    [[nodiscard]] std::vector<std::string> thoroughScan(const TargetSet& targets) const;
+    [[nodiscard]] std::vector<HostPorts> portScan(const std::string& cidr, const std::vector<int>& ports) const;
+    [[nodiscard]] std::vector<HostPorts> portScan(const TargetSet& targets, const std::vector<int>& ports) const;
+    [[nodiscard]] std::vector<HostMac> arpScan(const TargetSet& targets) const;
     ~NetworkScanner() override = default;
 
-private:
-    [[nodiscard]] bool verifyHost(const std::string& ip) const;
+    // Probes thoroughScan sends each host besides an ICMP echo, and how many of all of them must answer
+    static const std::vector<int> VERIFY_PORTS;
+    static constexpr int VERIFY_QUORUM = 2;
 };
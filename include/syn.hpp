@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Half-open (SYN) scanning over a single raw socket.
+ *
+ * SYNs carry a stateless cookie in the sequence number, so replies can be
+ * matched without keeping per-probe state: a SYN-ACK or RST whose
+ * acknowledgement number equals cookie + 1 belongs to one of our probes.
+ * Requires root (CAP_NET_RAW) and is only available on Linux.
+ */
+namespace Syn {
+    enum class PortState { Open, Closed };
+
+    struct Reply {
+        uint32_t ip;
+        uint16_t port;
+        PortState state;
+    };
+
+    // Sequence number cookie for a probe to dstIp:dstPort from srcPort
+    uint32_t cookie(uint32_t secret, uint32_t dstIp, uint16_t dstPort, uint16_t srcPort);
+
+    // TCP checksum over the IPv4 pseudo-header and segment (addresses in host order)
+    uint16_t tcpChecksum(uint32_t srcIp, uint32_t dstIp, const uint8_t* segment, size_t len);
+
+    // Write a 20-byte SYN segment into buf (addresses/ports in host order), returns its length
+    size_t buildSyn(uint8_t* buf, uint32_t srcIp, uint32_t dstIp, uint16_t srcPort, uint16_t dstPort, uint32_t seq);
+
+    // Parse an IPv4 packet received on the raw socket; true if it answers one of our probes
+    bool parseReply(const uint8_t* packet, size_t len, uint32_t secret, uint16_t srcPort, Reply& out);
+
+    class Engine {
+    public:
+        explicit Engine(int timeoutMs = 1000);
+        ~Engine();
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        // False if the request could not be sent (counted as a probe error)
+        bool send(uint32_t ip, uint16_t port);
+
+        // Distinct hosts that have replied so far (with openOnly, only those with an open port)
+        [[nodiscard]] size_t hostsAnswered(bool openOnly) const {
+            return openOnly ? openHosts.load() : answeredHosts.load();
+        }
+
+        // Wait one timeout after the last SYN, stop the receiver and return all replies
+        std::vector<Reply> finish();
+
+    private:
+        void receiveLoop();
+        uint32_t sourceFor(uint32_t dstIp);
+
+        int sockfd = -1;
+        int timeoutMs;
+        uint32_t secret;
+        uint16_t srcPort;
+        uint32_t cachedNet = 0;
+        uint32_t cachedSrc = 0;
+
+        std::atomic<bool> stop{false};
+        std::thread receiver;
+        std::mutex repliesMutex;
+        std::set<std::pair<uint32_t, uint16_t>> seen;
+        std::set<uint32_t> answered;
+        std::set<uint32_t> open;
+        std::atomic<size_t> answeredHosts{0};
+        std::atomic<size_t> openHosts{0};
+        std::vector<Reply> replies;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A set of IPv4 addresses stored as sorted, merged, inclusive ranges.
+ *
+ * Target and exclusion lists are kept as ranges and never expanded into
+ * individual addresses, so a million-line inventory export or a /8 costs
+ * memory proportional to the number of distinct ranges only. Every mutator
+ * leaves the ranges normalized, so const members never write and a shared
+ * const set can be read from several threads.
+ */
+class TargetSet {
+public:
+    using Range = std::pair<uint32_t, uint32_t>;
+
+    TargetSet() = default;
+
+    // Usable hosts of a CIDR block (network and broadcast dropped for prefixes shorter than /31)
+    static TargetSet hostsOf(const std::string& cidr);
+
+    // Merges in place; cheapest when ranges arrive in ascending order
+    void add(uint32_t first, uint32_t last);
+    void add(const TargetSet& other);
+    void subtract(const TargetSet& other);
+    // Keep only the addresses also in other
+    void intersect(const TargetSet& other);
+
+    /**
+     * Parse target entries from a text buffer without allocating per entry.
+     *
+     * Entries are separated by whitespace, commas or newlines and may be a
+     * single address ("10.0.0.1"), a CIDR block ("10.0.0.0/24"), a full range
+     * ("10.0.0.1-10.0.0.50") or a last-octet range ("10.0.0.1-50"). Text after
+     * '#' up to the end of the line is ignored.
+     *
+     * @return Number of entries that could not be parsed
+     */
+    size_t parse(const char* data, size_t len);
+
+    /**
+     * Load entries from a file (memory-mapped) or from stdin when path is "-".
+     *
+     * @return Number of entries that could not be parsed
+     * @throws std::runtime_error if the file cannot be read
+     */
+    size_t load(const std::string& path);
+
+    [[nodiscard]] const std::vector<Range>& ranges() const;
+    [[nodiscard]] uint64_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] bool contains(uint32_t ip) const;
+
+private:
+    // Sort and merge rangeList after appending unsorted ranges
+    void normalize();
+
+    std::vector<Range> rangeList;
+};
@@ -1,6 +1,19 @@
 #pragma once
 #include <string>
 
+namespace Interfaces { struct Interface; }
+
 namespace Tcp {
-    bool ping(const std::string& ip, int port, bool quiet = false, int timeoutMs = 1000);
+    // via: interface to send from (see Interfaces::bindSocket); nullptr follows the routing table
+    bool ping(const std::string& ip, int port, bool quiet = false, int timeoutMs = 1000,
+              const Interfaces::Interface* via = nullptr);
+
+    // Begin a non-blocking connect; returns the socket to poll for POLLOUT, or -1
+    int startConnect(const std::string& ip, int port, const Interfaces::Interface* via = nullptr);
+    // Once the socket polled writable: 0 if the handshake succeeded, else the errno it failed with
+    int connectError(int sockfd);
+    // Once the socket polled writable: whether the handshake succeeded
+    bool connected(int sockfd);
+    // Close with RST instead of FIN so no TIME_WAIT entry is left behind
+    void closeAbortive(int sockfd);
 }
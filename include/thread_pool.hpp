@@ -9,7 +9,9 @@
 
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    // queueLimit > 0 makes enqueue() block while that many tasks are waiting,
+    // so producers of very large target sets don't materialize them all at once
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), size_t queueLimit = 0);
     ~ThreadPool();
     void enqueue(std::function<void()> task);
     void shutdown();
@@ -19,5 +21,7 @@ private:
     std::queue<std::function<void()>> tasks;
     std::mutex queue_mutex;
     std::condition_variable condition;
+    std::condition_variable space;
+    size_t maxQueued;
     std::atomic<bool> stop{false};
 };
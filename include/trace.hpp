@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/**
+ * Chrome trace-event recording (--trace FILE), viewable in Perfetto or
+ * chrome://tracing.
+ *
+ * A Span records one complete event from construction to destruction. Phase
+ * and host spans are always kept; probe spans only for one probe in
+ * PROBE_SAMPLE per thread, so a /16 sweep still yields a readable trace. Events go to a
+ * fixed-size ring buffer per thread (the oldest are overwritten once it is
+ * full), and the Session writes them all out when it ends. With no Session
+ * running a Span costs one relaxed load.
+ */
+namespace Trace {
+    enum class Category {
+        Phase,   // a stage of the run, always kept
+        Host,    // work on one live host (identification), always kept: there are few of them
+        Probe    // one probe, sampled
+    };
+
+    // Keep one probe span in this many, per thread
+    constexpr uint32_t PROBE_SAMPLE = 16;
+    // Events kept per thread before the oldest are overwritten
+    constexpr size_t RING_CAPACITY = 16384;
+
+    namespace detail {
+        inline std::atomic<bool> recording{false};
+    }
+
+    inline bool active() { return detail::recording.load(std::memory_order_relaxed); }
+
+    class Span {
+    public:
+        // name must outlive the program (a literal); detail becomes the event's "target" argument
+        explicit Span(const char* name, const Category category = Category::Phase, const std::string& detail = {}) {
+            if (active()) begin(name, category, detail);
+        }
+        ~Span() {
+            if (name) end();
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        void begin(const char* spanName, Category spanCategory, const std::string& spanDetail);
+        void end();
+
+        const char* name = nullptr;
+        Category category = Category::Phase;
+        std::string detail;
+        int64_t startMicros = 0;
+    };
+
+    /**
+     * Turns recording on for its lifetime and writes the trace to path when it
+     * ends. The file is opened up front so a bad path is reported before the scan.
+     */
+    class Session {
+    public:
+        // @throws std::runtime_error if path cannot be opened for writing
+        explicit Session(const std::string& path);
+        ~Session();
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        // Write every recorded event as {"traceEvents": [...]}; returns the number written
+        size_t write();
+
+    private:
+        std::string path;
+        std::ofstream out;
+        uint32_t mainTid = 0;   // the thread that started the session is labelled "main"
+        bool written = false;
+    };
+}
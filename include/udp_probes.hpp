@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Batched UDP identification probes: NetBIOS node status, SNMP sysDescr and NTP.
+ *
+ * Windows machines, printers and network gear reveal their names or
+ * descriptions over these UDP services. One socket per protocol sends a
+ * request to every host back to back, then a single poll loop collects the
+ * answers, so probing N hosts costs one timeout rather than N.
+ */
+namespace UdpProbes {
+    struct Options {
+        std::string community = "public";
+        int timeoutMs = 1000;
+        // Destination ports; overridable so tests can use local stand-in responders
+        uint16_t netbiosPort = 137;
+        uint16_t snmpPort = 161;
+        uint16_t ntpPort = 123;
+    };
+
+    struct Result {
+        std::string netbiosName;
+        std::string sysDescr;
+        int ntpStratum = -1;  // -1 when NTP did not answer
+    };
+
+    // NetBIOS node status (NBSTAT) request for the wildcard name
+    std::vector<uint8_t> buildNetbiosStatusRequest(uint16_t transactionId);
+    // First unique workstation name from a node status response
+    bool parseNetbiosStatusResponse(const uint8_t* msg, size_t len, std::string& name);
+
+    // SNMPv2c GET for sysDescr.0
+    std::vector<uint8_t> buildSnmpGet(const std::string& community, uint32_t requestId);
+    // sysDescr value from a GetResponse
+    bool parseSnmpResponse(const uint8_t* msg, size_t len, std::string& sysDescr);
+
+    // 48-byte NTPv4 client (mode 3) request
+    std::vector<uint8_t> buildNtpRequest();
+    // Stratum from a server (mode 4) reply
+    bool parseNtpResponse(const uint8_t* msg, size_t len, int& stratum);
+
+    // Device description for identifyDevice; empty when nothing answered
+    std::string describe(const Result& result);
+
+    // Probe every host on all three protocols concurrently; results only for hosts that answered
+    std::map<std::string, Result> probe(const std::vector<std::string>& hosts, const Options& options);
+}
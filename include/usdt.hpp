@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * USDT (user-level statically defined tracing) probes for bpftrace and perf.
+ *
+ * Built with -DENABLE_USDT=ON, each SCANNER_PROBE is a single nop plus an ELF
+ * note naming the probe and where its arguments live; it costs nothing until
+ * a tracer attaches. Otherwise the macro expands to nothing and its arguments
+ * are not evaluated. Provider: network_scanner.
+ *
+ *   probe_send(type, ip, port)             type: 0 icmp, 1 tcp (Metrics::ProbeType); port 0 for ICMP
+ *   probe_reply(type, ip, port, rtt_us)
+ *   probe_timeout(type, ip, port)
+ *   host_found(ip)                         first hit on a host during discovery
+ *   identify_start(ip)
+ *   identify_done(ip, device_type)
+ *
+ * ip and device_type are NUL-terminated strings. See docs/bpftrace/ for scripts.
+ */
+#ifdef NETWORK_SCANNER_USDT
+#include <sys/sdt.h>
+#define SCANNER_PROBE(name, ...) STAP_PROBEV(network_scanner, name, __VA_ARGS__)
+#else
+#define SCANNER_PROBE(name, ...) do { } while (0)
+#endif
@@ -2,10 +2,17 @@
 #include <string>
 #include <utility>
 #include <cstdint>
+#include <vector>
 
 namespace Utils {
     uint32_t ipToUint(const std::string& ipStr);
     std::string uintToIp(uint32_t ip);
     std::pair<uint32_t, uint32_t> parseCIDR(const std::string& cidr);
     bool isValidIpv4(const std::string& ip);
+    std::vector<int> parsePortList(const std::string& spec);
+
+    // $XDG_CACHE_HOME/network-scanner/<name>, or ~/.cache/network-scanner/<name>; empty if neither is set
+    std::string cachePath(const std::string& name);
+    // Replace path's contents via a temporary file and rename, creating parent directories
+    bool writeFileAtomically(const std::string& path, const std::string& contents);
 }
@@ -0,0 +1,228 @@
+#include "../include/arp.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+#include "../include/metrics.hpp"
+#include "../include/signal_handler.hpp"
+
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#endif
+
+namespace Arp {
+    namespace {
+        constexpr uint16_t ETHERTYPE_ARP_FRAME = 0x0806;
+        constexpr uint16_t ARP_HW_ETHERNET = 1;
+        constexpr uint16_t ARP_PROTO_IPV4 = 0x0800;
+        constexpr uint16_t ARP_OP_REQUEST = 1;
+        constexpr uint16_t ARP_OP_REPLY = 2;
+
+        void put16(uint8_t* p, uint16_t v) {
+            p[0] = static_cast<uint8_t>(v >> 8);
+            p[1] = static_cast<uint8_t>(v);
+        }
+
+        void put32(uint8_t* p, uint32_t v) {
+            p[0] = static_cast<uint8_t>(v >> 24);
+            p[1] = static_cast<uint8_t>(v >> 16);
+            p[2] = static_cast<uint8_t>(v >> 8);
+            p[3] = static_cast<uint8_t>(v);
+        }
+
+        uint16_t get16(const uint8_t* p) {
+            return static_cast<uint16_t>((p[0] << 8) | p[1]);
+        }
+
+        uint32_t get32(const uint8_t* p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+    }
+
+    size_t buildRequest(uint8_t* buf, const MacAddress& srcMac, const uint32_t srcIp, const uint32_t targetIp) {
+        std::memset(buf, 0, FRAME_LEN);
+
+        // Ethernet: broadcast destination, our source, ARP ethertype
+        std::memset(buf, 0xff, 6);
+        std::memcpy(buf + 6, srcMac.data(), 6);
+        put16(buf + 12, ETHERTYPE_ARP_FRAME);
+
+        uint8_t* arp = buf + 14;
+        put16(arp, ARP_HW_ETHERNET);
+        put16(arp + 2, ARP_PROTO_IPV4);
+        arp[4] = 6;
+        arp[5] = 4;
+        put16(arp + 6, ARP_OP_REQUEST);
+        std::memcpy(arp + 8, srcMac.data(), 6);
+        put32(arp + 14, srcIp);
+        // Target hardware address (arp + 18) stays zero
+        put32(arp + 24, targetIp);
+        return FRAME_LEN;
+    }
+
+    bool parseReply(const uint8_t* frame, const size_t len, Reply& out) {
+        if (len < FRAME_LEN || get16(frame + 12) != ETHERTYPE_ARP_FRAME) return false;
+
+        const uint8_t* arp = frame + 14;
+        if (get16(arp) != ARP_HW_ETHERNET || get16(arp + 2) != ARP_PROTO_IPV4) return false;
+        if (arp[4] != 6 || arp[5] != 4 || get16(arp + 6) != ARP_OP_REPLY) return false;
+
+        std::memcpy(out.mac.data(), arp + 8, 6);
+        out.ip = get32(arp + 14);
+        return true;
+    }
+
+    std::string formatMac(const MacAddress& mac) {
+        char buf[18];
+        std::snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+                      mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        return buf;
+    }
+
+#ifdef __linux__
+    Engine::Engine(const std::string& interfaceName, const int timeoutMs) : timeoutMs(timeoutMs) {
+        if (interfaceName.empty() || interfaceName.size() >= IFNAMSIZ) {
+            throw std::runtime_error("ARP scan needs a network interface");
+        }
+
+        // Interface index, MAC, address and netmask via the classic ioctls
+        const int ctl = socket(AF_INET, SOCK_DGRAM, 0);
+        if (ctl < 0) {
+            throw std::runtime_error("cannot query interface " + interfaceName + ": " + std::strerror(errno));
+        }
+
+        ifreq ifr{};
+        const auto query = [&](const unsigned long request) {
+            std::strncpy(ifr.ifr_name, interfaceName.c_str(), IFNAMSIZ - 1);
+            if (ioctl(ctl, request, &ifr) != 0) {
+                const std::string reason = std::strerror(errno);
+                close(ctl);
+                throw std::runtime_error("cannot query interface " + interfaceName + ": " + reason);
+            }
+        };
+
+        query(SIOCGIFINDEX);
+        ifindex = ifr.ifr_ifindex;
+        query(SIOCGIFHWADDR);
+        std::memcpy(localMac.data(), ifr.ifr_hwaddr.sa_data, 6);
+        query(SIOCGIFADDR);
+        localIp = ntohl(reinterpret_cast<sockaddr_in*>(&ifr.ifr_addr)->sin_addr.s_addr);
+        query(SIOCGIFNETMASK);
+        netmask = ntohl(reinterpret_cast<sockaddr_in*>(&ifr.ifr_netmask)->sin_addr.s_addr);
+        close(ctl);
+
+        sockfd = socket(AF_PACKET, SOCK_RAW, htons(ETHERTYPE_ARP_FRAME));
+        if (sockfd < 0) {
+            throw std::runtime_error("ARP scan needs a packet socket (run as root): " + std::string(std::strerror(errno)));
+        }
+
+        sockaddr_ll bindAddr{};
+        bindAddr.sll_family = AF_PACKET;
+        bindAddr.sll_protocol = htons(ETHERTYPE_ARP_FRAME);
+        bindAddr.sll_ifindex = ifindex;
+        if (bind(sockfd, reinterpret_cast<sockaddr*>(&bindAddr), sizeof(bindAddr)) != 0) {
+            const std::string reason = std::strerror(errno);
+            close(sockfd);
+            throw std::runtime_error("cannot bind packet socket to " + interfaceName + ": " + reason);
+        }
+
+        Logger::debug("ARP: engine started on ", interfaceName, " (", formatMac(localMac), ", ",
+                      Utils::uintToIp(localIp), ")");
+        receiver = std::thread(&Engine::receiveLoop, this);
+    }
+#else
+    Engine::Engine(const std::string&, const int timeoutMs) : timeoutMs(timeoutMs) {
+        throw std::runtime_error("ARP scan is only supported on Linux");
+    }
+#endif
+
+    Engine::~Engine() {
+        stop.store(true);
+        if (receiver.joinable()) receiver.join();
+        if (sockfd >= 0) close(sockfd);
+    }
+
+    bool Engine::onLink(const uint32_t ip) const {
+        return (ip & netmask) == (localIp & netmask);
+    }
+
+    bool Engine::send(const uint32_t ip) {
+#ifdef __linux__
+        uint8_t frame[FRAME_LEN];
+        const size_t len = buildRequest(frame, localMac, localIp, ip);
+
+        sockaddr_ll addr{};
+        addr.sll_family = AF_PACKET;
+        addr.sll_protocol = htons(ETHERTYPE_ARP_FRAME);
+        addr.sll_ifindex = ifindex;
+        addr.sll_halen = 6;
+        std::memset(addr.sll_addr, 0xff, 6);
+
+        lastSend = std::chrono::steady_clock::now();
+        Metrics::add(Metrics::Counter::ProbesSent);
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            if (sendto(sockfd, frame, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) >= 0) return true;
+            if (errno != ENOBUFS && errno != EAGAIN) break;
+            // Transmit queue is full: back off briefly instead of dropping the request
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        Logger::debug("ARP: sendto failed for ", Utils::uintToIp(ip), " (", std::strerror(errno), ")");
+#else
+        (void)ip;
+#endif
+        Metrics::add(Metrics::Counter::Errors);
+        return false;
+    }
+
+    void Engine::receiveLoop() {
+        uint8_t buf[1514];
+        pollfd pfd{sockfd, POLLIN, 0};
+
+        while (!stop.load()) {
+            if (poll(&pfd, 1, 50) <= 0) continue;
+
+            const ssize_t n = recv(sockfd, buf, sizeof(buf), 0);
+            if (n <= 0) continue;
+
+            Reply reply{};
+            if (!parseReply(buf, static_cast<size_t>(n), reply) || reply.ip == localIp) continue;
+
+            std::lock_guard<std::mutex> lock(repliesMutex);
+            if (seen.insert(reply.ip).second) {
+                if (Logger::enabled(Logger::Level::DEBUG)) {
+                    Logger::debug("ARP: ", Utils::uintToIp(reply.ip), " is at ", formatMac(reply.mac));
+                }
+                replies.push_back(reply);
+                ++answeredHosts;
+                Metrics::add(Metrics::Counter::Replies);
+            }
+        }
+    }
+
+    std::vector<Reply> Engine::finish() {
+        // Engines finished one after another share the wait: it is measured from each one's last request
+        const auto deadline = lastSend + std::chrono::milliseconds(timeoutMs);
+        while (std::chrono::steady_clock::now() < deadline && !SignalHandler::isInterrupted()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        stop.store(true);
+        if (receiver.joinable()) receiver.join();
+
+        std::lock_guard<std::mutex> lock(repliesMutex);
+        return replies;
+    }
+}
@@ -0,0 +1,178 @@
+#include "../include/block_survey.hpp"
+#include "../include/device_identifier.hpp"
+#include "../include/prefix_trie.hpp"
+#include "../include/rate_limiter.hpp"
+#include "../include/scan_budget.hpp"
+#include "../include/metrics.hpp"
+#include "../include/icmp.hpp"
+#include "../include/signal_handler.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace BlockSurvey {
+    namespace {
+        constexpr uint8_t ICMP_ECHO_REPLY = 0;
+        constexpr uint8_t ICMP_ECHO_REQUEST = 8;
+        constexpr size_t ECHO_LEN = 16;
+
+        size_t buildEcho(uint8_t* buf, const uint16_t id, const uint16_t sequence) {
+            std::memset(buf, 0, ECHO_LEN);
+            buf[0] = ICMP_ECHO_REQUEST;
+            std::memcpy(buf + 4, &id, 2);
+            std::memcpy(buf + 6, &sequence, 2);
+            const uint16_t sum = Icmp::checksum(buf, ECHO_LEN);
+            std::memcpy(buf + 2, &sum, 2);
+            return ECHO_LEN;
+        }
+    }
+
+    std::vector<uint32_t> blocksOf(const TargetSet& targets) {
+        std::vector<uint32_t> blocks;
+        for (const auto& [first, last] : targets.ranges()) {
+            const uint32_t firstBlock = first >> 8;
+            // Ranges are sorted and disjoint, but neighbours can share a block
+            for (uint64_t block = (!blocks.empty() && blocks.back() == firstBlock) ? firstBlock + 1 : firstBlock;
+                 block <= (last >> 8); ++block) {
+                blocks.push_back(static_cast<uint32_t>(block));
+            }
+        }
+        return blocks;
+    }
+
+    std::vector<uint32_t> probeAddresses(const uint32_t block, const TargetSet& targets, const PrefixTrie* exclusions) {
+        std::vector<uint32_t> addresses;
+        const auto consider = [&](const int octet) {
+            const uint32_t ip = (block << 8) | static_cast<uint32_t>(octet);
+            if (targets.contains(ip) && !(exclusions && exclusions->contains(ip))) addresses.push_back(ip);
+        };
+
+        consider(255);
+        for (const int octet : DeviceIdentifier::ROUTER_OCTETS) consider(octet);
+        for (const int octet : DeviceIdentifier::NETWORK_DEVICE_OCTETS) consider(octet);
+        return addresses;
+    }
+
+    void partition(const TargetSet& targets, Result& result) {
+        TargetSet liveRanges;
+        for (const uint32_t block : result.liveBlocks) {
+            liveRanges.add(block << 8, (block << 8) | 0xff);
+        }
+
+        result.silent = targets;
+        result.silent.subtract(liveRanges);
+        result.live = targets;
+        result.live.subtract(result.silent);
+    }
+
+    Result run(const TargetSet& targets, const Options& options) {
+        Result result;
+        const std::vector<uint32_t> blocks = blocksOf(targets);
+        result.blocks = blocks.size();
+
+        // Datagram ICMP sockets need no privileges; the kernel then matches replies to us
+        bool raw = false;
+        int sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+        if (sockfd < 0) {
+            sockfd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+            raw = true;
+        }
+        if (sockfd < 0) {
+            Logger::warn("Block survey skipped: no ICMP socket available (", std::strerror(errno), ")");
+            return result;
+        }
+
+        const int one = 1;
+        setsockopt(sockfd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+        const int receiveBuffer = 1 << 20;
+        setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+        const auto id = static_cast<uint16_t>(getpid());
+        std::set<uint32_t> responders;
+
+        const auto drain = [&] {
+            uint8_t buf[1500];
+            sockaddr_in from{};
+            socklen_t fromLen = sizeof(from);
+            ssize_t n;
+            while ((n = recvfrom(sockfd, buf, sizeof(buf), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&from), &fromLen)) > 0) {
+                fromLen = sizeof(from);
+                const uint8_t* icmp = buf;
+                size_t len = static_cast<size_t>(n);
+                if (raw) {
+                    const size_t ipHeaderLen = (buf[0] & 0x0f) * 4u;
+                    if (len < ipHeaderLen + 8) continue;
+                    icmp += ipHeaderLen;
+                    len -= ipHeaderLen;
+                    uint16_t replyId;
+                    std::memcpy(&replyId, icmp + 4, 2);
+                    if (replyId != id) continue;
+                }
+                if (len < 8 || icmp[0] != ICMP_ECHO_REPLY) continue;
+
+                const uint32_t source = ntohl(from.sin_addr.s_addr);
+                if (!std::binary_search(blocks.begin(), blocks.end(), source >> 8)) continue;
+                Metrics::add(Metrics::Counter::Replies);
+                result.liveBlocks.insert(source >> 8);
+                if (targets.contains(source)) responders.insert(source);
+            }
+        };
+
+        RateLimiter pacer(options.rate > 0 ? options.rate : DEFAULT_RATE);
+        uint8_t packet[ECHO_LEN];
+        uint16_t sequence = 0;
+
+        {
+            Metrics::Reporter progress("SURVEY", blocks.size());
+
+            for (const uint32_t block : blocks) {
+                if (SignalHandler::isInterrupted() || (options.budget && options.budget->exhausted())) break;
+                for (const uint32_t ip : probeAddresses(block, targets, options.exclusions)) {
+                    pacer.acquire();
+
+                    sockaddr_in addr{};
+                    addr.sin_family = AF_INET;
+                    addr.sin_addr.s_addr = htonl(ip);
+                    const size_t len = buildEcho(packet, id, htons(++sequence));
+                    Metrics::add(Metrics::Counter::ProbesSent);
+                    if (sendto(sockfd, packet, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                        Logger::debug("Block survey: sendto ", Utils::uintToIp(ip), " failed: ", std::strerror(errno));
+                        Metrics::add(Metrics::Counter::Errors);
+                    }
+                    ++result.requests;
+                }
+                drain();
+                Metrics::add(Metrics::Counter::JobsDone);
+            }
+
+            // Late replies: one timeout after the last request
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeoutMs);
+            pollfd pfd{sockfd, POLLIN, 0};
+            while (!SignalHandler::isInterrupted()) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (remaining <= 0) break;
+                if (poll(&pfd, 1, static_cast<int>(remaining)) > 0) drain();
+            }
+        }
+        close(sockfd);
+
+        result.ran = true;
+        result.responders.assign(responders.begin(), responders.end());
+        partition(targets, result);
+
+        Logger::verbose("Block survey: ", result.requests, " requests, ", result.liveBlocks.size(),
+                        " of ", result.blocks, " /24 blocks answered");
+        return result;
+    }
+}
@@ -2,6 +2,9 @@
 #include "../include/tcp.hpp"
 #include "../include/icmp.hpp"
 #include "../include/logger.hpp"
+#include "../include/neighbors.hpp"
+#include "../include/utils.hpp"
+#include "../include/trace.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -13,6 +16,8 @@
 #include <cstring>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/wait.h>
@@ -46,27 +51,21 @@ DeviceIdentifier::DeviceIdentifier() {
     portToService[1080] = "Security Camera";
 
     if (std::ifstream file("/usr/share/nmap/nmap-mac-prefixes"); file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            if (line.empty() || line[0] == '#') continue;
-
-            std::istringstream iss(line);
-            std::string prefix;
-            std::string vendor;
-            if (iss >> prefix) {
-                std::getline(iss >> std::ws, vendor);
-                if (!vendor.empty()) {
-                    macToVendor[prefix] = vendor;
-                }
-            }
-        }
-        Logger::debug("Loaded " + std::to_string(macToVendor.size()) + " MAC vendor entries");
+        Logger::debug("Loaded ", loadMacVendors(file), " MAC vendor entries");
     } else {
         Logger::debug("MAC vendor database not found at /usr/share/nmap/nmap-mac-prefixes");
     }
 }
 
+std::string DeviceIdentifier::serviceName(const int port) const {
+    if (const auto it = portToService.find(port); it != portToService.end()) {
+        return it->second;
+    }
+    return "";
+}
+
 std::string DeviceIdentifier::resolveHostname(const std::string& ip) {
+    Trace::Span span("reverse-dns", Trace::Category::Probe, ip);
     struct sockaddr_in sa{};
     char hostname[NI_MAXHOST];
     memset(&sa, 0, sizeof(sa));
@@ -74,30 +73,31 @@ std::string DeviceIdentifier::resolveHostname(const std::string& ip) {
     inet_pton(AF_INET, ip.c_str(), &sa.sin_addr);
 
     if (getnameinfo(reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa), hostname, sizeof(hostname), nullptr, 0, NI_NAMEREQD) == 0) {
-        Logger::debug("Resolved " + ip + " -> " + std::string(hostname));
+        Logger::debug("Resolved ", ip, " -> ", hostname);
         return {hostname};
     }
 
     return "";
 }
 
-std::string DeviceIdentifier::lookupMacVendor(const std::string& ip) {
-    if (macToVendor.empty()) return "";
+void DeviceIdentifier::setMacAddress(const std::string& ip, const std::string& mac) {
+    knownMacs[ip] = mac;
+}
+
+std::string DeviceIdentifier::macAddress(const std::string& ip) const {
+    if (const auto it = knownMacs.find(ip); it != knownMacs.end()) {
+        return it->second;
+    }
 
     // Read ARP table to find MAC for this IP
     std::string mac;
 
 #ifdef __linux__
-    std::ifstream arpFile("/proc/net/arp");
-    if (arpFile.is_open()) {
-        std::string line;
-        std::getline(arpFile, line); // skip header
-        while (std::getline(arpFile, line)) {
-            std::istringstream iss(line);
-            std::string arpIp, hwType, flags, hwAddr;
-            iss >> arpIp >> hwType >> flags >> hwAddr;
-            if (arpIp == ip && hwAddr != "00:00:00:00:00:00") {
-                mac = hwAddr;
+    if (std::ifstream arpFile("/proc/net/arp"); arpFile.is_open() && Utils::isValidIpv4(ip)) {
+        const uint32_t target = Utils::ipToUint(ip);
+        for (const auto& entry : Neighbors::parseProcArp(arpFile)) {
+            if (entry.ip == target && !entry.mac.empty()) {
+                mac = entry.mac;
                 break;
             }
         }
@@ -145,7 +145,41 @@ std::string DeviceIdentifier::lookupMacVendor(const std::string& ip) {
     }
 #endif
 
-    if (mac.empty()) return "";
+    return mac;
+}
+
+void DeviceIdentifier::setDiscoveryHints(std::map<std::string, Discovery::DeviceHint> hints) {
+    discoveryHints = std::move(hints);
+}
+
+void DeviceIdentifier::addUdpResults(const std::map<std::string, UdpProbes::Result>& results) {
+    for (const auto& [ip, result] : results) {
+        udpResults[ip] = result;
+    }
+}
+
+size_t DeviceIdentifier::loadMacVendors(std::istream& in) {
+    size_t loaded = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string prefix;
+        std::string vendor;
+        if (iss >> prefix) {
+            std::getline(iss >> std::ws, vendor);
+            if (!vendor.empty()) {
+                macToVendor[prefix] = vendor;
+                ++loaded;
+            }
+        }
+    }
+    return loaded;
+}
+
+std::string DeviceIdentifier::macVendor(const std::string& mac) const {
+    if (macToVendor.empty()) return "";
 
     // Extract OUI prefix (first 3 octets) and convert to uppercase hex without colons
     std::string oui;
@@ -155,23 +189,32 @@ std::string DeviceIdentifier::lookupMacVendor(const std::string& ip) {
         if (oui.size() == 6) break;
     }
 
-    auto it = macToVendor.find(oui);
-    if (it != macToVendor.end()) {
-        Logger::debug("MAC vendor for " + ip + " (" + mac + "): " + it->second);
-        return it->second;
-    }
+    const auto it = macToVendor.find(oui);
+    return it != macToVendor.end() ? it->second : "";
+}
 
-    return "";
+std::string DeviceIdentifier::lookupMacVendor(const std::string& ip) {
+    if (macToVendor.empty()) return "";
+
+    const std::string mac = macAddress(ip);
+    if (mac.empty()) return "";
+
+    std::string vendor = macVendor(mac);
+    if (!vendor.empty()) Logger::debug("MAC vendor for ", ip, " (", mac, "): ", vendor);
+    return vendor;
+}
+
+bool DeviceIdentifier::isDiscoveryPort(const int port) {
+    return port == 5353 || port == 7000 || port == 8009 || port == 8060 || port == 1900;
 }
 
 std::string DeviceIdentifier::checkCommonServices(const std::string& ip) {
     if (Tcp::ping(ip, 62078, true)) return "Apple iPhone/iPad";
     if (Tcp::ping(ip, 5228, true) || Tcp::ping(ip, 9000, true)) return "Android Device";
-    if (Tcp::ping(ip, 7000, true) || Tcp::ping(ip, 5353, true)) return "Apple Device";
-    if (Tcp::ping(ip, 8009, true)) return "Google Chromecast";
-    if (Tcp::ping(ip, 8060, true)) return "Roku Device";
 
     for (const auto& [port, service] : portToService) {
+        // Multicast/UDP services (and the devices behind them) are identified by the discovery stage
+        if (isDiscoveryPort(port)) continue;
         if (Tcp::ping(ip, port, true)) return service;
     }
 
@@ -179,10 +222,13 @@ std::string DeviceIdentifier::checkCommonServices(const std::string& ip) {
 }
 
 std::string DeviceIdentifier::identifyByPattern(const std::string& ip) {
-    const std::string lastOctet = ip.substr(ip.find_last_of('.') + 1);
+    const int lastOctet = std::atoi(ip.c_str() + ip.find_last_of('.') + 1);
+    const auto matches = [lastOctet](const auto& octets) {
+        return std::find(std::begin(octets), std::end(octets), lastOctet) != std::end(octets);
+    };
 
-    if (lastOctet == "1" || lastOctet == "254") return "Possible Router/Gateway";
-    if (lastOctet == "10" || lastOctet == "20" || lastOctet == "50" || lastOctet == "100") return "Possible Network Device";
+    if (matches(ROUTER_OCTETS)) return "Possible Router/Gateway";
+    if (matches(NETWORK_DEVICE_OCTETS)) return "Possible Network Device";
 
     return "";
 }
@@ -193,7 +239,7 @@ bool DeviceIdentifier::verifyHost(const std::string& ip) {
 
         const std::vector<int> commonPorts = {
             80, 443, 22, 21, 23, 25, 53, 3389, 8080, 445,
-            7000, 62078, 5353, 5228, 9000, 8009, 8060, 1900
+            62078, 5228, 9000
         };
 
         for (const int port : commonPorts) {
@@ -208,11 +254,23 @@ bool DeviceIdentifier::verifyHost(const std::string& ip) {
 
     return Tcp::ping(ip, 80, true) || Tcp::ping(ip, 443, true) ||
            Tcp::ping(ip, 22, true) || Tcp::ping(ip, 8080, true) ||
-           Tcp::ping(ip, 62078, true) || Tcp::ping(ip, 7000, true);
+           Tcp::ping(ip, 62078, true);
 }
 
 std::string DeviceIdentifier::identifyDevice(const std::string& ip) {
-    Logger::debug("Identifying device: " + ip);
+    Trace::Span span("identify", Trace::Category::Host, ip);
+    Logger::debug("Identifying device: ", ip);
+
+    // Devices that answered mDNS/SSDP identified themselves already
+    if (const auto it = discoveryHints.find(ip); it != discoveryHints.end()) {
+        const auto& [name, type] = it->second;
+        if (!type.empty()) return name.empty() ? type : type + " (" + name + ")";
+        if (!name.empty()) return name;
+    }
+
+    if (const auto it = udpResults.find(ip); it != udpResults.end()) {
+        if (std::string description = UdpProbes::describe(it->second); !description.empty()) return description;
+    }
 
     // First try to resolve hostname
     std::string hostname = resolveHostname(ip);
@@ -225,14 +283,12 @@ std::string DeviceIdentifier::identifyDevice(const std::string& ip) {
     // Try to identify by specific device ports
     if (Tcp::ping(ip, 62078, true)) return "Apple iPhone/iPad";
     if (Tcp::ping(ip, 5228, true) || Tcp::ping(ip, 9000, true)) return "Android Device";
-    if (Tcp::ping(ip, 7000, true) && Tcp::ping(ip, 5353, true)) return "Apple TV";
-    if (Tcp::ping(ip, 8009, true)) return "Google Chromecast";
-    if (Tcp::ping(ip, 8060, true)) return "Roku Device";
 
     std::string serviceType = checkCommonServices(ip);
     if (!serviceType.empty()) return serviceType;
 
-    if (!verifyHost(ip)) return "Possible Ghost - Unconfirmed";
+    // A host that answered ARP is on the link, whatever its ports say
+    if (!knownMacs.count(ip) && !verifyHost(ip)) return "Possible Ghost - Unconfirmed";
 
     std::string patternType = identifyByPattern(ip);
     if (!patternType.empty()) return patternType;
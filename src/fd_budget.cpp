@@ -0,0 +1,73 @@
+#include "../include/fd_budget.hpp"
+#include "../include/logger.hpp"
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+namespace FdBudget {
+    namespace {
+        // Descriptors kept back for stdio, libcurl, log files and long-lived sockets
+        constexpr size_t RESERVED_FDS = 64;
+        // Never hand out fewer than this, even under a tiny RLIMIT_NOFILE
+        constexpr size_t MIN_CAPACITY = 4;
+
+        std::once_flag initFlag;
+        size_t total = MIN_CAPACITY;
+        size_t available = MIN_CAPACITY;
+        std::mutex budgetMutex;
+        std::condition_variable budgetCv;
+
+        void init() {
+            const size_t limit = raiseLimit();
+            total = limit > RESERVED_FDS + MIN_CAPACITY ? limit - RESERVED_FDS : MIN_CAPACITY;
+            available = total;
+            Logger::verbose("File descriptor budget: ", total, " concurrent probes (RLIMIT_NOFILE ", limit, ")");
+        }
+    }
+
+    size_t raiseLimit() {
+        rlimit rl{};
+        if (getrlimit(RLIMIT_NOFILE, &rl) != 0) {
+            return 1024;
+        }
+
+        if (rl.rlim_cur < rl.rlim_max) {
+            rlimit raised = rl;
+            raised.rlim_cur = rl.rlim_max;
+#ifdef __APPLE__
+            // macOS rejects RLIM_INFINITY / values above OPEN_MAX for the soft limit
+            if (raised.rlim_cur == RLIM_INFINITY || raised.rlim_cur > 10240) raised.rlim_cur = 10240;
+#endif
+            if (setrlimit(RLIMIT_NOFILE, &raised) == 0) {
+                Logger::debug("Raised RLIMIT_NOFILE soft limit from ", rl.rlim_cur, " to ", raised.rlim_cur);
+                rl = raised;
+            }
+        }
+
+        return rl.rlim_cur == RLIM_INFINITY ? static_cast<size_t>(1) << 20 : static_cast<size_t>(rl.rlim_cur);
+    }
+
+    size_t capacity() {
+        std::call_once(initFlag, init);
+        return total;
+    }
+
+    void acquire(size_t n) {
+        std::call_once(initFlag, init);
+        std::unique_lock<std::mutex> lock(budgetMutex);
+        n = std::min(n, total);
+        budgetCv.wait(lock, [n] { return available >= n; });
+        available -= n;
+    }
+
+    void release(size_t n) {
+        {
+            std::lock_guard<std::mutex> lock(budgetMutex);
+            available = std::min(available + n, total);
+        }
+        budgetCv.notify_all();
+    }
+}
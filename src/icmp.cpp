@@ -1,14 +1,12 @@
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <sys/wait.h>
 #include <chrono>
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
 #include <string>
-#include <atomic>
-#include <mutex>
 #include <fcntl.h>
 
 // ICMP headers
@@ -42,10 +40,13 @@ struct icmphdr {
 #include "../include/icmp.hpp"
 #include "../include/utils.hpp"
 #include "../include/logger.hpp"
+#include "../include/fd_budget.hpp"
+#include "../include/interfaces.hpp"
+#include "../include/metrics.hpp"
+#include "../include/trace.hpp"
+#include "../include/usdt.hpp"
 
 namespace Icmp {
-    static std::mutex outputMutex;
-
     uint16_t checksum(void* data, int len) {
         auto* buf = static_cast<uint16_t*>(data);
         uint32_t sum = 0;
@@ -56,17 +57,19 @@ namespace Icmp {
         return static_cast<uint16_t>(~sum);
     }
 
-    bool pingRawSocket(const std::string& ip, bool quiet, int timeoutMs) {
+    bool pingRawSocket(const std::string& ip, bool quiet, int timeoutMs, const Interfaces::Interface* via) {
         if (!Utils::isValidIpv4(ip)) {
-            Logger::debug("pingRawSocket: invalid IP " + ip);
+            Logger::debug("pingRawSocket: invalid IP ", ip);
             return false;
         }
 
+        FdBudget::Slot slot;
         const int sockfd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
         if (sockfd < 0) {
             Logger::debug("pingRawSocket: cannot create raw socket (need root?)");
             return false;
         }
+        Interfaces::bindSocket(sockfd, via);
 
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
@@ -82,19 +85,16 @@ namespace Icmp {
 
         if (sendto(sockfd, sendbuf, sizeof(sendbuf), 0,
                    reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            Logger::debug("pingRawSocket: sendto failed for " + ip);
+            Logger::debug("pingRawSocket: sendto failed for ", ip);
             close(sockfd);
             return false;
         }
 
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(sockfd, &fds);
-        timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        pollfd pfd{sockfd, POLLIN, 0};
 
         bool result = false;
 
-        if (select(sockfd + 1, &fds, nullptr, nullptr, &timeout) > 0) {
+        if (poll(&pfd, 1, timeoutMs) > 0) {
             char recvbuf[1500];
             sockaddr_in from{};
             socklen_t socklen = sizeof(from);
@@ -108,7 +108,7 @@ namespace Icmp {
 
                 if (const auto* icmp_reply = reinterpret_cast<struct icmphdr*>(recvbuf + ip_header_len); icmp_reply->type == 0 && icmp_reply->un.echo.id == getpid()) {
                     result = true;
-                    Logger::debug("pingRawSocket: " + ip + " is alive");
+                    Logger::debug("pingRawSocket: ", ip, " is alive");
                 }
             }
         }
@@ -117,14 +117,16 @@ namespace Icmp {
         return result;
     }
 
-    bool pingDatagramSocket(const std::string& ip, bool quiet, int timeoutMs) {
+    bool pingDatagramSocket(const std::string& ip, bool quiet, int timeoutMs, const Interfaces::Interface* via) {
         if (!Utils::isValidIpv4(ip)) return false;
 
+        FdBudget::Slot slot;
         const int sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
         if (sockfd < 0) {
             Logger::debug("pingDatagramSocket: cannot create dgram ICMP socket");
             return false;
         }
+        Interfaces::bindSocket(sockfd, via);
 
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
@@ -144,18 +146,15 @@ namespace Icmp {
             return false;
         }
 
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(sockfd, &fds);
-        timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        pollfd pfd{sockfd, POLLIN, 0};
 
         bool result = false;
 
-        if (select(sockfd + 1, &fds, nullptr, nullptr, &timeout) > 0) {
+        if (poll(&pfd, 1, timeoutMs) > 0) {
             char recvbuf[1500];
             if (const ssize_t n = recv(sockfd, recvbuf, sizeof(recvbuf), 0); n > 0) {
                 result = true;
-                Logger::debug("pingDatagramSocket: " + ip + " is alive");
+                Logger::debug("pingDatagramSocket: ", ip, " is alive");
             }
         }
 
@@ -163,17 +162,17 @@ namespace Icmp {
         return result;
     }
 
-    bool pingFallback(const std::string& ip, bool quiet, int timeoutMs) {
+    bool pingFallback(const std::string& ip, bool quiet, int timeoutMs, const Interfaces::Interface* via) {
         if (!Utils::isValidIpv4(ip)) {
-            Logger::warn("pingFallback: rejecting invalid IP: " + ip);
+            Logger::warn("pingFallback: rejecting invalid IP: ", ip);
             return false;
         }
 
-        if (pingDatagramSocket(ip, quiet, timeoutMs)) return true;
-        if (pingRawSocket(ip, quiet, timeoutMs)) return true;
+        if (pingDatagramSocket(ip, quiet, timeoutMs, via)) return true;
+        if (pingRawSocket(ip, quiet, timeoutMs, via)) return true;
 
         // Use fork/exec instead of system() to avoid shell injection
-        Logger::debug("pingFallback: trying fping for " + ip);
+        Logger::debug("pingFallback: trying fping for ", ip);
         std::string timeoutArg = "-t" + std::to_string(timeoutMs);
 
         pid_t pid = fork();
@@ -191,7 +190,7 @@ namespace Icmp {
             int status;
             waitpid(pid, &status, 0);
             if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-                Logger::debug("pingFallback: fping reports " + ip + " alive");
+                Logger::debug("pingFallback: fping reports ", ip, " alive");
                 return true;
             }
         }
@@ -199,32 +198,81 @@ namespace Icmp {
         return false;
     }
 
-    bool ping(const std::string& ip, std::atomic<int>& counter, const int total, const bool quiet, int timeoutMs) {
-        const bool res = pingFallback(ip, quiet, timeoutMs);
+    bool ping(const std::string& ip, const bool quiet, const int timeoutMs, const Interfaces::Interface* via) {
+        Trace::Span span("icmp", Trace::Category::Probe, ip);
+        const auto start = std::chrono::steady_clock::now();
+        SCANNER_PROBE(probe_send, 0, ip.c_str(), 0);
+        const bool alive = pingFallback(ip, quiet, timeoutMs, via);
+        if (alive) {
+            const auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            SCANNER_PROBE(probe_reply, 0, ip.c_str(), 0, static_cast<long long>(rtt.count()));
+            Metrics::recordProbe(Metrics::ProbeType::Icmp, Metrics::Outcome::Reply, rtt);
+        } else {
+            SCANNER_PROBE(probe_timeout, 0, ip.c_str(), 0);
+            Metrics::recordProbe(Metrics::ProbeType::Icmp, Metrics::Outcome::Timeout);
+        }
+        return alive;
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(outputMutex);
+    int sendEcho(const std::string& ip, const Interfaces::Interface* via) {
+        if (!Utils::isValidIpv4(ip)) return -1;
 
-            if (res && !quiet) {
-                std::cerr << ip << std::endl;
-            }
+        int sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+        if (sockfd < 0) sockfd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+        if (sockfd < 0) {
+            Logger::debug("sendEcho: no ICMP socket available for ", ip);
+            return -1;
+        }
+        Interfaces::bindSocket(sockfd, via);
 
-            const int done = ++counter;
-            constexpr int width = 30;
-            const int filled = static_cast<int>((static_cast<double>(done) * width) / total);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
 
-            if (!quiet) {
-                std::cerr << "\r[";
-                for (int i = 0; i < width; ++i) std::cerr << (i < filled ? '#' : '.');
-                std::cerr << "] " << done << "/" << total << std::flush;
-            }
-        }
+        char sendbuf[64]{};
+        auto* icmp = reinterpret_cast<struct icmphdr*>(sendbuf);
+        icmp->type = ICMP_ECHO;
+        icmp->code = 0;
+        icmp->un.echo.id = getpid();
+        icmp->un.echo.sequence = 1;
+        icmp->checksum = checksum(sendbuf, sizeof(sendbuf));
 
-        return res;
+        if (sendto(sockfd, sendbuf, sizeof(sendbuf), 0,
+                   reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            Logger::debug("sendEcho: sendto failed for ", ip);
+            close(sockfd);
+            return -1;
+        }
+        return sockfd;
     }
 
-    bool ping(const std::string& ip, bool quiet, int timeoutMs) {
-        std::atomic<int> dummy = 0;
-        return ping(ip, dummy, 1, quiet, timeoutMs);
+    bool readEchoReply(const int sockfd, const std::string& ip) {
+        char recvbuf[1500];
+        sockaddr_in from{};
+        socklen_t socklen = sizeof(from);
+
+        const ssize_t n = recvfrom(sockfd, recvbuf, sizeof(recvbuf), MSG_DONTWAIT,
+                                   reinterpret_cast<sockaddr*>(&from), &socklen);
+        if (n <= 0) return false;
+
+        in_addr target{};
+        inet_pton(AF_INET, ip.c_str(), &target);
+        if (from.sin_addr.s_addr != target.s_addr) return false;
+
+        int type = 0;
+        socklen_t typeLen = sizeof(type);
+        getsockopt(sockfd, SOL_SOCKET, SO_TYPE, &type, &typeLen);
+
+        // Datagram ICMP sockets are demultiplexed by the kernel and deliver
+        // only the ICMP message; raw sockets see every ICMP packet with its IP header.
+        const char* message = recvbuf;
+        if (type == SOCK_RAW) {
+            const int ipHeaderLen = reinterpret_cast<struct ip*>(recvbuf)->ip_hl << 2;
+            if (n < ipHeaderLen + static_cast<ssize_t>(sizeof(struct icmphdr))) return false;
+            message = recvbuf + ipHeaderLen;
+            if (reinterpret_cast<const struct icmphdr*>(message)->un.echo.id != static_cast<uint16_t>(getpid())) return false;
+        }
+
+        return reinterpret_cast<const struct icmphdr*>(message)->type == 0;
     }
 }
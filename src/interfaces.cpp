@@ -0,0 +1,103 @@
+#include "../include/interfaces.hpp"
+#include "../include/target_set.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+
+namespace Interfaces {
+    uint32_t Interface::netmask() const {
+        return prefixLength == 0 ? 0 : (~0U << (32 - prefixLength));
+    }
+
+    bool Interface::contains(const uint32_t ip) const {
+        return (ip & netmask()) == (address & netmask());
+    }
+
+    std::string Interface::cidr() const {
+        return Utils::uintToIp(address & netmask()) + "/" + std::to_string(prefixLength);
+    }
+
+    std::vector<Interface> list() {
+        std::vector<Interface> interfaces;
+
+        ifaddrs* ifap;
+        if (getifaddrs(&ifap) != 0) {
+            Logger::debug("Interfaces: getifaddrs failed: ", std::strerror(errno));
+            return interfaces;
+        }
+
+        for (ifaddrs* ifa = ifap; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET || !ifa->ifa_netmask) continue;
+            if (!(ifa->ifa_flags & IFF_UP) || (ifa->ifa_flags & IFF_LOOPBACK)) continue;
+
+            Interface iface;
+            iface.name = ifa->ifa_name;
+            iface.address = ntohl(reinterpret_cast<sockaddr_in*>(ifa->ifa_addr)->sin_addr.s_addr);
+            const uint32_t mask = ntohl(reinterpret_cast<sockaddr_in*>(ifa->ifa_netmask)->sin_addr.s_addr);
+            iface.prefixLength = static_cast<uint8_t>(__builtin_popcount(mask));
+
+            // 169.254.0.0/16: link-local autoconfiguration, nothing to discover there
+            if ((iface.address & 0xffff0000U) == 0xa9fe0000U) continue;
+
+            Logger::debug("Interfaces: ", iface.name, " ", Utils::uintToIp(iface.address), "/", iface.prefixLength);
+            interfaces.push_back(std::move(iface));
+        }
+        freeifaddrs(ifap);
+
+        return interfaces;
+    }
+
+    TargetSet subnetsOf(const std::vector<Interface>& interfaces) {
+        TargetSet targets;
+        for (const auto& iface : interfaces) {
+            targets.add(TargetSet::hostsOf(iface.cidr()));
+        }
+        return targets;
+    }
+
+    Router::Router(std::vector<Interface> interfaces) : entries(std::move(interfaces)) {
+        std::stable_sort(entries.begin(), entries.end(), [](const Interface& a, const Interface& b) {
+            return a.prefixLength > b.prefixLength;
+        });
+    }
+
+    const Interface* Router::route(const uint32_t ip) const {
+        for (const auto& iface : entries) {
+            if (iface.contains(ip)) return &iface;
+        }
+        return nullptr;
+    }
+
+    void bindSocket(const int sockfd, const Interface* via) {
+        if (!via || sockfd < 0) return;
+
+#ifdef SO_BINDTODEVICE
+        // Needs CAP_NET_RAW on older kernels; the source address below still steers the reply
+        if (setsockopt(sockfd, SOL_SOCKET, SO_BINDTODEVICE, via->name.c_str(),
+                       static_cast<socklen_t>(via->name.size() + 1)) < 0 && errno != EPERM) {
+            Logger::debug("Interfaces: SO_BINDTODEVICE ", via->name, " failed: ", std::strerror(errno));
+        }
+#endif
+
+#ifdef IP_BIND_ADDRESS_NO_PORT
+        // Defer the ephemeral port choice to connect(), which can reuse ports across destinations
+        const int one = 1;
+        setsockopt(sockfd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &one, sizeof(one));
+#endif
+
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(via->address);
+        if (bind(sockfd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+            Logger::debug("Interfaces: bind to ", Utils::uintToIp(via->address), " failed: ", std::strerror(errno));
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include "../include/json_output.hpp"
+#include "../include/device_identifier.hpp"
+#include "../include/metrics.hpp"
+#include "../include/network_info.hpp"
+#include "../include/trace.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace JsonOutput {
+    std::string escape(const std::string& s) {
+        std::string out;
+        out.reserve(s.size() + 8);
+        for (char c : s) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:   out += c; break;
+            }
+        }
+        return out;
+    }
+
+    std::string render(const NetworkInfo& info, const std::string& mode, int port, size_t threadCount,
+                       bool thoroughScan, int timeoutMs, const std::string& subnet,
+                       const std::vector<std::pair<std::string, std::string>>& hosts,
+                       double durationSec, uint64_t totalScanned,
+                       const std::vector<int>& ports, const OpenPortMap& openPorts, const DeviceIdentifier& deviceId,
+                       uint64_t probesSaved, const SurveyReport& survey, const BudgetReport& budget) {
+        Trace::Span span("output");
+        std::ostringstream json;
+        json << "{\n";
+        json << "  \"network_info\": {\n";
+        json << "    \"interface\": \"" << escape(info.interfaceName) << "\",\n";
+        json << "    \"local_ip\": \"" << escape(info.localIp) << "\",\n";
+        json << "    \"subnet_mask\": \"" << escape(info.subnetMask) << "\",\n";
+        json << "    \"gateway_ip\": \"" << escape(info.gatewayIp) << "\",\n";
+        json << "    \"public_ip\": \"" << escape(info.publicIp) << "\"\n";
+        json << "  },\n";
+        json << "  \"scan_settings\": {\n";
+        json << "    \"mode\": \"" << escape(mode) << "\",\n";
+        json << "    \"port\": " << port << ",\n";
+        if (!ports.empty()) {
+            json << "    \"ports\": [";
+            for (size_t i = 0; i < ports.size(); ++i) {
+                json << (i ? ", " : "") << ports[i];
+            }
+            json << "],\n";
+        }
+        json << "    \"threads\": " << threadCount << ",\n";
+        json << "    \"timeout_ms\": " << timeoutMs << ",\n";
+        json << "    \"thorough\": " << (thoroughScan ? "true" : "false") << ",\n";
+        json << "    \"subnet\": \"" << escape(subnet) << "\"\n";
+        json << "  },\n";
+        json << "  \"statistics\": {\n";
+        json << "    \"duration_seconds\": " << std::fixed << std::setprecision(3) << durationSec << ",\n";
+        json << "    \"ips_scanned\": " << totalScanned << ",\n";
+        json << "    \"hosts_found\": " << hosts.size() << ",\n";
+        json << "    \"probes_saved\": " << probesSaved << ",\n";
+        json << "    \"probes_sent\": " << budget.probesSent << ",\n";
+        if (!budget.truncatedBy.empty()) {
+            json << "    \"truncated_by\": \"" << budget.truncatedBy << "\",\n";
+        }
+        json << "    \"truncated\": " << (budget.truncatedBy.empty() ? "false" : "true") << "\n";
+        json << "  },\n";
+        if (survey.enabled) {
+            json << "  \"block_survey\": {\n";
+            json << "    \"blocks\": " << survey.blocks << ",\n";
+            json << "    \"live_blocks\": " << survey.liveBlocks << ",\n";
+            json << "    \"silent_targets\": " << survey.silentTargets << ",\n";
+            json << "    \"pruned\": " << (survey.pruned ? "true" : "false") << ",\n";
+            json << "    \"hosts_in_live_blocks\": " << survey.hostsInLiveBlocks << "\n";
+            json << "  },\n";
+        }
+        const Metrics::Snapshot metrics = Metrics::snapshot();
+        json << "  \"metrics\": " << Metrics::toJson(metrics) << ",\n";
+        json << "  \"probe_latency\": " << Metrics::latencyJson(metrics, 2) << ",\n";
+        json << "  \"results\": [\n";
+        for (size_t i = 0; i < hosts.size(); ++i) {
+            json << "    {\"ip\": \"" << escape(hosts[i].first)
+                 << "\", \"device_type\": \"" << escape(hosts[i].second) << "\"";
+            if (const std::string mac = deviceId.macAddress(hosts[i].first); !mac.empty()) {
+                json << ", \"mac\": \"" << escape(mac) << "\"";
+            }
+            if (!ports.empty()) {
+                json << ", \"open_ports\": [";
+                if (const auto it = openPorts.find(hosts[i].first); it != openPorts.end()) {
+                    for (size_t j = 0; j < it->second.size(); ++j) {
+                        const int p = it->second[j];
+                        json << (j ? ", " : "") << "{\"port\": " << p
+                             << ", \"service\": \"" << escape(deviceId.serviceName(p)) << "\"}";
+                    }
+                }
+                json << "]";
+            }
+            json << "}";
+            if (i + 1 < hosts.size()) json << ",";
+            json << "\n";
+        }
+        json << "  ]\n";
+        json << "}\n";
+
+        return json.str();
+    }
+}
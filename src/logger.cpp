@@ -0,0 +1,252 @@
+#include "../include/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Logger {
+    namespace {
+        using Clock = std::chrono::system_clock;
+
+        // Records a thread can queue before it has to wait for the writer
+        constexpr size_t RING_SIZE = 512;
+        // The writer wakes at least this often; warnings, errors and half-full rings wake it sooner
+        constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(10);
+        constexpr size_t CACHE_LINE = 64;
+
+        struct Record {
+            Level level = Level::QUIET;
+            Clock::time_point time;
+            std::string message;
+        };
+
+        // Single producer (the owning thread), single consumer (the writer)
+        struct Ring {
+            std::array<Record, RING_SIZE> slots;
+            alignas(CACHE_LINE) std::atomic<size_t> head{0};   // next slot the producer fills
+            alignas(CACHE_LINE) std::atomic<size_t> tail{0};   // next slot the writer drains
+        };
+
+        const char* tag(const Level level) {
+            switch (level) {
+                case Level::QUIET: return "ERR";   // error() is the only thing logged at QUIET
+                case Level::NORMAL: return "WRN";
+                case Level::VERBOSE: return "INF";
+                case Level::DEBUG: return "DBG";
+            }
+            return "";
+        }
+
+        class Writer {
+        public:
+            Writer() : thread(&Writer::loop, this) {
+                std::atexit([] { instance().stop(); });
+            }
+
+            // Never destroyed: threads may still log while static destructors run
+            static Writer& instance() {
+                static Writer* const writer = new Writer();
+                return *writer;
+            }
+
+            Ring& lease() {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                if (!freeRings.empty()) {
+                    Ring* ring = freeRings.back();
+                    freeRings.pop_back();
+                    return *ring;
+                }
+                rings.push_back(std::make_unique<Ring>());
+                return *rings.back();
+            }
+
+            void release(Ring& ring) {
+                // Whatever is still queued is drained by the writer as usual
+                std::lock_guard<std::mutex> lock(registryMutex);
+                freeRings.push_back(&ring);
+            }
+
+            void wake() {
+                wakeRequested.store(true, std::memory_order_relaxed);
+                wakeCv.notify_one();
+            }
+
+            bool running() const { return !stopped.load(std::memory_order_acquire); }
+
+            // Once stopped there is no writer thread left, so the caller writes its own line
+            void writeDirect(const Level level, std::string message) {
+                std::lock_guard<std::mutex> lock(drainMutex);
+                std::vector<Record> batch;
+                batch.push_back({level, Clock::now(), std::move(message)});
+                write(batch);
+            }
+
+            void flush() {
+                std::vector<std::pair<Ring*, size_t>> targets;
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex);
+                    for (const auto& ring : rings) targets.emplace_back(ring.get(), ring->head.load(std::memory_order_acquire));
+                }
+                const auto caughtUp = [&targets] {
+                    return std::all_of(targets.begin(), targets.end(), [](const auto& target) {
+                        return target.first->tail.load(std::memory_order_acquire) >= target.second;
+                    });
+                };
+
+                std::unique_lock<std::mutex> lock(drainMutex);
+                while (!caughtUp()) {
+                    if (!running()) {
+                        drain();
+                        continue;
+                    }
+                    wake();
+                    drainedCv.wait_for(lock, WRITE_INTERVAL);
+                }
+            }
+
+        private:
+            void loop() {
+                while (running()) {
+                    {
+                        std::unique_lock<std::mutex> lock(wakeMutex);
+                        wakeCv.wait_for(lock, WRITE_INTERVAL, [this] {
+                            return wakeRequested.load(std::memory_order_relaxed) || !running();
+                        });
+                        wakeRequested.store(false, std::memory_order_relaxed);
+                    }
+                    std::lock_guard<std::mutex> lock(drainMutex);
+                    drain();
+                }
+            }
+
+            void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    stopped.store(true, std::memory_order_release);
+                }
+                wakeCv.notify_one();
+                if (thread.joinable()) thread.join();
+                std::lock_guard<std::mutex> lock(drainMutex);
+                drain();
+            }
+
+            // Caller holds drainMutex; nothing here may log
+            void drain() {
+                std::vector<Ring*> snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex);
+                    for (const auto& ring : rings) snapshot.push_back(ring.get());
+                }
+
+                batch.clear();
+                for (Ring* ring : snapshot) {
+                    const size_t head = ring->head.load(std::memory_order_acquire);
+                    size_t tail = ring->tail.load(std::memory_order_relaxed);
+                    for (; tail != head; ++tail) batch.push_back(std::move(ring->slots[tail % RING_SIZE]));
+                    ring->tail.store(tail, std::memory_order_release);
+                }
+                if (!batch.empty()) {
+                    // Each ring is in order already; interleave the threads by capture time
+                    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+                        return a.time < b.time;
+                    });
+                    write(batch);
+                }
+                drainedCv.notify_all();
+            }
+
+            void write(const std::vector<Record>& records) {
+                text.clear();
+                for (const auto& record : records) {
+                    const auto sinceEpoch = record.time.time_since_epoch();
+                    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+                    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - seconds).count();
+
+                    // localtime_r takes the tz lock; a batch rarely spans more than one second
+                    if (seconds.count() != cachedSecond) {
+                        cachedSecond = seconds.count();
+                        const std::time_t time = static_cast<std::time_t>(cachedSecond);
+                        std::tm local{};
+                        localtime_r(&time, &local);
+                        std::strftime(cachedClock, sizeof(cachedClock), "%H:%M:%S", &local);
+                    }
+
+                    char prefix[32];
+                    std::snprintf(prefix, sizeof(prefix), "[%s.%03d %s] ", cachedClock, static_cast<int>(millis), tag(record.level));
+                    text += prefix;
+                    text += record.message;
+                    text += '\n';
+                }
+                std::cerr.write(text.data(), static_cast<std::streamsize>(text.size()));
+                std::cerr.flush();
+            }
+
+            std::mutex registryMutex;
+            std::vector<std::unique_ptr<Ring>> rings;   // kept after their threads exit
+            std::vector<Ring*> freeRings;                // rings of threads that have exited
+
+            std::mutex wakeMutex;
+            std::condition_variable wakeCv;
+            std::atomic<bool> wakeRequested{false};
+            std::atomic<bool> stopped{false};
+
+            // Held while draining, so flush() callers see a batch either fully written or not at all
+            std::mutex drainMutex;
+            std::condition_variable drainedCv;
+            std::vector<Record> batch;
+            std::string text;
+            int64_t cachedSecond = -1;
+            char cachedClock[16] = {};
+
+            std::thread thread;   // last: starts once everything above exists
+        };
+
+        // Hands the thread's ring back to the free list when the thread exits
+        struct Lease {
+            Ring& ring = Writer::instance().lease();
+            ~Lease() { Writer::instance().release(ring); }
+        };
+    }
+
+    void submit(const Level level, std::string message) {
+        Writer& writer = Writer::instance();
+        if (!writer.running()) {
+            writer.writeDirect(level, std::move(message));
+            return;
+        }
+
+        thread_local Lease lease;
+        Ring& ring = lease.ring;
+        const size_t head = ring.head.load(std::memory_order_relaxed);
+        while (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+            if (!writer.running()) {
+                writer.writeDirect(level, std::move(message));
+                return;
+            }
+            writer.wake();
+            std::this_thread::yield();
+        }
+
+        Record& slot = ring.slots[head % RING_SIZE];
+        slot.level = level;
+        slot.time = Clock::now();
+        slot.message = std::move(message);
+        ring.head.store(head + 1, std::memory_order_release);
+
+        if (level <= Level::NORMAL || head + 1 - ring.tail.load(std::memory_order_relaxed) >= RING_SIZE / 2) writer.wake();
+        if (level == Level::QUIET) writer.flush();
+    }
+
+    void flush() {
+        Writer::instance().flush();
+    }
+}
@@ -10,6 +10,9 @@
 #include <chrono>
 #include <iomanip>
 #include <cstdlib>
+#include <map>
+#include <memory>
+#include <future>
 #include "../include/version.hpp"
 
 #include "../include/scanner.hpp"
@@ -19,26 +22,22 @@
 #include "../include/logger.hpp"
 #include "../include/signal_handler.hpp"
 #include "../include/utils.hpp"
+#include "../include/target_set.hpp"
+#include "../include/prefix_trie.hpp"
+#include "../include/neighbors.hpp"
+#include "../include/multicast_discovery.hpp"
+#include "../include/interfaces.hpp"
+#include "../include/json_output.hpp"
+#include "../include/block_survey.hpp"
+#include "../include/scan_history.hpp"
+#include "../include/scan_budget.hpp"
+#include "../include/metrics.hpp"
+#include "../include/metrics_server.hpp"
+#include "../include/trace.hpp"
+#include "../include/usdt.hpp"
 
 const std::string VERSION = NetworkAnalyzer::VERSION_STRING;
 
-// JSON helper: escape a string for JSON output
-static std::string jsonEscape(const std::string& s) {
-    std::string out;
-    out.reserve(s.size() + 8);
-    for (char c : s) {
-        switch (c) {
-            case '"':  out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\n': out += "\\n"; break;
-            case '\r': out += "\\r"; break;
-            case '\t': out += "\\t"; break;
-            default:   out += c; break;
-        }
-    }
-    return out;
-}
-
 void printVersion() {
     std::cout << VERSION << std::endl;
     std::cout << "Copyright " << NetworkAnalyzer::COPYRIGHT_YEAR << " TLDR;IT s.r.o." << std::endl;
@@ -88,8 +87,23 @@ void printPixelAsciiArt() {
     std::cout << GREEN << "[ Systems online. Ready to scan. ]" << RESET << std::endl << std::endl;
 }
 
-void printCompactNetworkInfo(const NetworkInfo& info, const size_t threadCount, const std::string& mode, const int port, const bool thoroughScan, int timeoutMs) {
+// Format a port list back into compact "22,80,8000-8100" notation
+static std::string formatPortList(const std::vector<int>& ports) {
+    std::string out;
+    for (size_t i = 0; i < ports.size(); ++i) {
+        size_t j = i;
+        while (j + 1 < ports.size() && ports[j + 1] == ports[j] + 1) ++j;
+        if (!out.empty()) out += ",";
+        out += std::to_string(ports[i]);
+        if (j > i) out += "-" + std::to_string(ports[j]);
+        i = j;
+    }
+    return out;
+}
+
+void printCompactNetworkInfo(const NetworkInfo& info, const size_t threadCount, const std::string& mode, const int port, const bool thoroughScan, int timeoutMs, const std::vector<int>& ports) {
     using namespace Colors;
+    Logger::flush();  // log lines are written in the background; keep them above the table
     std::cout << GREEN << "[ SYSTEM INFORMATION ]" << RESET << std::endl;
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
 
@@ -120,7 +134,10 @@ void printCompactNetworkInfo(const NetworkInfo& info, const size_t threadCount,
     std::cout << BOLD << std::left << std::setw(labelWidth) << "SCAN MODE" << RESET << "| "
               << YELLOW << std::left << std::setw(valueWidth) << mode << RESET << std::endl;
 
-    if (mode == "tcp" || mode == "fallback") {
+    if (!ports.empty()) {
+        std::cout << BOLD << std::left << std::setw(labelWidth) << "TCP PORTS" << RESET << "| "
+                  << YELLOW << std::left << std::setw(valueWidth) << formatPortList(ports) << RESET << std::endl;
+    } else if (mode == "tcp" || mode == "fallback" || mode == "syn") {
         std::cout << BOLD << std::left << std::setw(labelWidth) << "TCP PORT" << RESET << "| "
                   << YELLOW << std::left << std::setw(valueWidth) << port << RESET << std::endl;
     }
@@ -136,32 +153,67 @@ void printCompactNetworkInfo(const NetworkInfo& info, const size_t threadCount,
     std::cout << std::endl;
 }
 
-void promptScan(const std::string& subnet) {
+void promptScan(const std::string& subnet, bool fromFile, uint64_t hostCount) {
     using namespace Colors;
+    Logger::flush();
     std::cout << GREEN << "[ SCAN ]" << RESET << std::endl;
-    std::cout << GREEN << "--- Do you want to scan your local subnet (" << YELLOW << subnet << GREEN << ")? (y/n): " << RESET;
+    if (fromFile) {
+        std::cout << GREEN << "--- Do you want to scan " << YELLOW << hostCount << GREEN << " addresses from "
+                  << YELLOW << subnet << GREEN << "? (y/n): " << RESET;
+    } else {
+        std::cout << GREEN << "--- Do you want to scan your local subnet (" << YELLOW << subnet << GREEN << ")? (y/n): " << RESET;
+    }
+}
+
+// curl's global state must outlive the background public IP lookup
+struct CurlGlobal {
+    CurlGlobal() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+    ~CurlGlobal() { curl_global_cleanup(); }
+};
+
+static std::string describePorts(const std::vector<int>& ports, const DeviceIdentifier& deviceId) {
+    std::string out;
+    for (const int p : ports) {
+        if (!out.empty()) out += ", ";
+        out += std::to_string(p);
+        if (const std::string service = deviceId.serviceName(p); !service.empty()) {
+            out += "/" + service;
+        }
+    }
+    return out;
 }
 
-void displayScanResults(const std::vector<std::pair<std::string, std::string>>& hosts, const std::string& title) {
+void displayScanResults(const std::vector<std::pair<std::string, std::string>>& hosts, const std::string& title,
+                        const OpenPortMap& openPorts, const DeviceIdentifier& deviceId) {
     using namespace Colors;
+    Logger::flush();
     std::cout << GREEN << "[ " << title << " ]" << RESET << std::endl;
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
 
     std::cout << BOLD << std::left << std::setw(18) << "IP ADDRESS" << RESET << "| "
-              << BOLD << std::left << std::setw(30) << "DEVICE TYPE" << RESET << std::endl;
+              << BOLD << std::left << std::setw(30) << "DEVICE TYPE" << RESET;
+    if (!openPorts.empty()) {
+        std::cout << "| " << BOLD << "OPEN PORTS" << RESET;
+    }
+    std::cout << std::endl;
 
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
 
     for (const auto& [ip, deviceType] : hosts) {
         std::cout << YELLOW << std::left << std::setw(18) << ip << RESET << "| "
-                  << BRIGHT_GREEN << std::left << std::setw(30) << deviceType << RESET << std::endl;
+                  << BRIGHT_GREEN << std::left << std::setw(30) << deviceType << RESET;
+        if (const auto it = openPorts.find(ip); it != openPorts.end()) {
+            std::cout << "| " << CYAN << describePorts(it->second, deviceId) << RESET;
+        }
+        std::cout << std::endl;
     }
 
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
     std::cout << std::endl;
 }
 
-void displayScanStats(double durationSec, uint32_t totalScanned, size_t hostsFound, size_t confirmedHosts) {
+void displayScanStats(double durationSec, uint64_t totalScanned, size_t hostsFound, size_t confirmedHosts,
+                      uint64_t probesSaved = 0, const SurveyReport& survey = {}, const BudgetReport& budget = {}) {
     using namespace Colors;
     std::cout << GREEN << "[ SCAN STATISTICS ]" << RESET << std::endl;
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
@@ -191,130 +243,217 @@ void displayScanStats(double durationSec, uint32_t totalScanned, size_t hostsFou
     std::cout << BOLD << std::left << std::setw(labelWidth) << "DISCOVERY RATE" << RESET << "| "
               << YELLOW << std::left << std::setw(valueWidth) << rateStr.str() << RESET << std::endl;
 
+    if (probesSaved > 0) {
+        std::cout << BOLD << std::left << std::setw(labelWidth) << "PROBES SAVED" << RESET << "| "
+                  << YELLOW << std::left << std::setw(valueWidth) << probesSaved << RESET << std::endl;
+    }
+
+    if (!budget.truncatedBy.empty()) {
+        std::cout << BOLD << std::left << std::setw(labelWidth) << "TRUNCATED BY" << RESET << "| "
+                  << RED << std::left << std::setw(valueWidth) << budget.truncatedBy << RESET << std::endl;
+        std::cout << BOLD << std::left << std::setw(labelWidth) << "PROBES SENT" << RESET << "| "
+                  << YELLOW << std::left << std::setw(valueWidth) << budget.probesSent << RESET << std::endl;
+    }
+
+    if (survey.enabled) {
+        std::cout << BOLD << std::left << std::setw(labelWidth) << "LIVE /24 BLOCKS" << RESET << "| "
+                  << YELLOW << std::left << std::setw(valueWidth)
+                  << (std::to_string(survey.liveBlocks) + " of " + std::to_string(survey.blocks)) << RESET << std::endl;
+
+        if (survey.pruned) {
+            std::cout << BOLD << std::left << std::setw(labelWidth) << "TARGETS PRUNED" << RESET << "| "
+                      << YELLOW << std::left << std::setw(valueWidth) << survey.silentTargets << RESET << std::endl;
+        } else if (survey.hostsFound > 0) {
+            // Share of live hosts that pruning would have kept
+            std::ostringstream recallStr;
+            recallStr << std::fixed << std::setprecision(1)
+                      << (100.0 * static_cast<double>(survey.hostsInLiveBlocks) / static_cast<double>(survey.hostsFound)) << "%";
+            std::cout << BOLD << std::left << std::setw(labelWidth) << "SURVEY RECALL" << RESET << "| "
+                      << YELLOW << std::left << std::setw(valueWidth) << recallStr.str() << RESET << std::endl;
+        }
+    }
+
     std::cout << GREEN << std::string(49, '-') << RESET << std::endl;
     std::cout << std::endl;
 }
 
-void outputJson(const NetworkInfo& info, const std::string& mode, int port, size_t threadCount,
-                bool thoroughScan, int timeoutMs, const std::string& subnet,
-                const std::vector<std::pair<std::string, std::string>>& hosts,
-                double durationSec, uint32_t totalScanned) {
-    std::ostringstream json;
-    json << "{\n";
-    json << "  \"network_info\": {\n";
-    json << "    \"interface\": \"" << jsonEscape(info.interfaceName) << "\",\n";
-    json << "    \"local_ip\": \"" << jsonEscape(info.localIp) << "\",\n";
-    json << "    \"subnet_mask\": \"" << jsonEscape(info.subnetMask) << "\",\n";
-    json << "    \"gateway_ip\": \"" << jsonEscape(info.gatewayIp) << "\",\n";
-    json << "    \"public_ip\": \"" << jsonEscape(info.publicIp) << "\"\n";
-    json << "  },\n";
-    json << "  \"scan_settings\": {\n";
-    json << "    \"mode\": \"" << jsonEscape(mode) << "\",\n";
-    json << "    \"port\": " << port << ",\n";
-    json << "    \"threads\": " << threadCount << ",\n";
-    json << "    \"timeout_ms\": " << timeoutMs << ",\n";
-    json << "    \"thorough\": " << (thoroughScan ? "true" : "false") << ",\n";
-    json << "    \"subnet\": \"" << jsonEscape(subnet) << "\"\n";
-    json << "  },\n";
-    json << "  \"statistics\": {\n";
-    json << "    \"duration_seconds\": " << std::fixed << std::setprecision(3) << durationSec << ",\n";
-    json << "    \"ips_scanned\": " << totalScanned << ",\n";
-    json << "    \"hosts_found\": " << hosts.size() << "\n";
-    json << "  },\n";
-    json << "  \"results\": [\n";
-    for (size_t i = 0; i < hosts.size(); ++i) {
-        json << "    {\"ip\": \"" << jsonEscape(hosts[i].first)
-             << "\", \"device_type\": \"" << jsonEscape(hosts[i].second) << "\"}";
-        if (i + 1 < hosts.size()) json << ",";
-        json << "\n";
-    }
-    json << "  ]\n";
-    json << "}\n";
-
-    std::cout << json.str();
+// Why a scan ended early, if it did, announced unless the output is JSON
+BudgetReport reportBudget(const ScanBudget& budget, const bool jsonOutput) {
+    using namespace Colors;
+    BudgetReport report;
+    report.probesSent = budget.probes();
+    if (SignalHandler::isInterrupted()) {
+        report.truncatedBy = "interrupt";
+        if (!jsonOutput) {
+            std::cout << std::endl << YELLOW << "[!] Scan interrupted by user. Showing partial results." << RESET << std::endl;
+        }
+    } else if (budget.reason() != ScanBudget::Limit::None) {
+        report.truncatedBy = ScanBudget::describe(budget.reason());
+        if (!jsonOutput) {
+            std::cout << YELLOW << "[!] Scan stopped at the --" << report.truncatedBy << " limit after "
+                      << report.probesSent << " probes. Showing partial results." << RESET << std::endl;
+        }
+    }
+    return report;
+}
+
+// Per-type probe counts and round-trip quantiles from the metrics histograms (--stats)
+void displayLatencyStats(const Metrics::Snapshot& snapshot) {
+    using namespace Colors;
+    constexpr int width = 82;
+    std::cout << GREEN << "[ PROBE LATENCY ]" << RESET << std::endl;
+    std::cout << GREEN << std::string(width, '-') << RESET << std::endl;
+
+    std::cout << BOLD << std::left << std::setw(10) << "TYPE" << std::right
+              << std::setw(8) << "SENT" << std::setw(9) << "REPLIES" << std::setw(10) << "TIMEOUTS"
+              << std::setw(8) << "ERRORS" << std::setw(9) << "P50 ms" << std::setw(9) << "P90 ms"
+              << std::setw(9) << "P99 ms" << std::setw(10) << "MAX ms" << RESET << std::endl;
+    std::cout << GREEN << std::string(width, '-') << RESET << std::endl;
+
+    const auto ms = [](const uint64_t micros) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << static_cast<double>(micros) / 1000.0;
+        return out.str();
+    };
+    for (size_t t = 0; t < Metrics::PROBE_TYPES; ++t) {
+        const auto type = static_cast<Metrics::ProbeType>(t);
+        const Metrics::Histogram& h = snapshot[type];
+        const uint64_t sent = h.replies + h.timeouts + h.errors;
+        std::cout << YELLOW << std::left << std::setw(10) << Metrics::name(type) << RESET << std::right
+                  << std::setw(8) << sent << std::setw(9) << h.replies << std::setw(10) << h.timeouts
+                  << std::setw(8) << h.errors;
+        if (h.replies > 0) {
+            std::cout << std::setw(9) << ms(h.quantile(0.50)) << std::setw(9) << ms(h.quantile(0.90))
+                      << std::setw(9) << ms(h.quantile(0.99)) << std::setw(10) << ms(h.maxMicros);
+        } else {
+            std::cout << std::setw(9) << "-" << std::setw(9) << "-" << std::setw(9) << "-" << std::setw(10) << "-";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << GREEN << std::string(width, '-') << RESET << std::endl;
+    std::cout << std::endl;
 }
 
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --threads N       Number of threads to use (default: CPU cores)" << std::endl;
-    std::cout << "  --mode MODE       Scan mode: icmp, tcp, or fallback (default: fallback)" << std::endl;
+    std::cout << "  --mode MODE       Scan mode: icmp, tcp, syn, arp, or fallback (default: fallback)" << std::endl;
     std::cout << "  --port PORT       Port for TCP scanning (default: 80)" << std::endl;
+    std::cout << "  --ports LIST      Scan a port list/ranges per host, e.g. 22,80,443,8000-8100" << std::endl;
+    std::cout << "  --targets FILE    Scan IPs, ranges and CIDRs listed in FILE ('-' for stdin)" << std::endl;
+    std::cout << "  --exclude FILE    Never probe IPs, ranges and CIDRs listed in FILE" << std::endl;
+    std::cout << "  --all-interfaces  Scan every interface's subnet and the gateway subnet in one pass" << std::endl;
     std::cout << "  --timeout MS      Probe timeout in milliseconds (default: 1000)" << std::endl;
+    std::cout << "  --survey          Ping each /24's broadcast and sentinel addresses first; scan answering blocks first" << std::endl;
+    std::cout << "  --prune-silent    Like --survey, but skip /24 blocks that gave no sign of life" << std::endl;
+    std::cout << "  --rate PPS        Probes per second for the whole scan (default: unpaced, 1000 for arp)" << std::endl;
+    std::cout << "  --max-duration S  Stop starting probes after S seconds and report what was found" << std::endl;
+    std::cout << "  --max-hosts N     Stop starting probes once N live hosts are found" << std::endl;
+    std::cout << "  --max-probes N    Send at most N probes (host or host:port attempts)" << std::endl;
     std::cout << "  --thorough        Use thorough scanning (higher accuracy, slower)" << std::endl;
     std::cout << "  --skip-scan       Skip network scanning" << std::endl;
     std::cout << "  --json            Output results as JSON (non-interactive)" << std::endl;
     std::cout << "  --no-color        Disable colored output" << std::endl;
+    std::cout << "  --no-discovery    Skip the mDNS/SSDP device discovery stage" << std::endl;
+    std::cout << "  --no-udp          Skip NetBIOS/SNMP/NTP identification probes" << std::endl;
+    std::cout << "  --snmp-community STR  SNMP community for identification (default: public)" << std::endl;
+    std::cout << "  --no-neighbors    Don't pre-seed results from the kernel neighbor (ARP) table" << std::endl;
+    std::cout << "  --no-public-ip    Don't look up the public IP address" << std::endl;
+    std::cout << "  --no-history      Don't probe previously seen hosts first or remember this scan's hosts" << std::endl;
     std::cout << "  --verbose         Show informational messages" << std::endl;
     std::cout << "  --debug           Show debug messages" << std::endl;
     std::cout << "  --help            Display this help message" << std::endl;
     std::cout << "  --version         Display version information" << std::endl;
     std::cout << "  --show-all        Show all hosts, including unconfirmed ones" << std::endl;
+    std::cout << "  --stats           Show per-probe-type latency quantiles after the scan statistics" << std::endl;
+    std::cout << "  --trace FILE      Write a Chrome trace of scan phases and sampled probes to FILE (open in Perfetto)" << std::endl;
+    std::cout << "  --metrics-listen ADDR:PORT  Serve live counters and latency histograms for Prometheus at /metrics" << std::endl;
     std::cout << "  --no-banner       Disable ASCII art banner" << std::endl;
     std::cout << "  --no-clear        Don't clear the screen at start" << std::endl;
 }
 
-// Process scan results with progress bar, returns host pairs
+// Identify each host, with progress on stderr; returns host pairs
 static std::vector<std::pair<std::string, std::string>> processHosts(
     DeviceIdentifier& deviceId,
     const std::vector<std::string>& hosts,
     bool jsonOutput)
 {
+    Trace::Span span("identify");
     std::vector<std::pair<std::string, std::string>> hostInfoPairs;
-
-    std::atomic<size_t> counter = 0;
-    const size_t total = hosts.size();
-    std::atomic<bool> processComplete = false;
-
-    std::thread progressThread;
-    if (!jsonOutput) {
-        using namespace Colors;
-        progressThread = std::thread([&counter, total, &processComplete]() {
-            while (!processComplete && !SignalHandler::isInterrupted()) {
-                const size_t done = counter.load();
-                constexpr int width = 30;
-                const int filled = static_cast<int>((static_cast<double>(done) * static_cast<double>(width)) / static_cast<double>(total));
-
-                std::cerr << "\r" << Colors::GREEN << "[" << Colors::YELLOW;
-                for (int i = 0; i < width; ++i) {
-                    std::cerr << (i < filled ? '#' : '.');
-                }
-                std::cerr << Colors::GREEN << "] " << Colors::YELLOW << done << "/" << total << Colors::RESET << std::flush;
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-        });
-    }
+    Metrics::Reporter progress("IDENTIFY", hosts.size(), !jsonOutput);
+    // Identification probes get their own latency histogram
+    Metrics::StageScope stage(Metrics::ProbeType::Identify);
 
     for (const auto& ip : hosts) {
         if (SignalHandler::isInterrupted()) break;
+        SCANNER_PROBE(identify_start, ip.c_str());
         std::string deviceType = deviceId.identifyDevice(ip);
+        SCANNER_PROBE(identify_done, ip.c_str(), deviceType.c_str());
         hostInfoPairs.emplace_back(ip, deviceType);
-        ++counter;
+        Metrics::add(Metrics::Counter::JobsDone);
     }
 
-    processComplete = true;
-    if (progressThread.joinable()) {
-        progressThread.join();
+    return hostInfoPairs;
+}
+
+// Run the configured scan over one subnet; fills openPorts when a port list is given
+static std::vector<std::string> runScan(const NetworkScanner& scanner, const TargetSet& targets,
+                                        bool thoroughScan, const std::vector<int>& ports, OpenPortMap& openPorts,
+                                        const std::string& mode, DeviceIdentifier& deviceId) {
+    if (!ports.empty()) {
+        std::vector<std::string> hosts;
+        for (auto& [ip, hostPorts] : scanner.portScan(targets, ports)) {
+            hosts.push_back(ip);
+            openPorts[ip] = std::move(hostPorts);
+        }
+        return hosts;
     }
-    if (!jsonOutput) {
-        std::cerr << "\r" << std::string(80, ' ') << "\r";
+    if (mode == "arp") {
+        // ARP replies are authoritative for the link, so there is nothing to verify further
+        std::vector<std::string> hosts;
+        for (const auto& [ip, mac] : scanner.arpScan(targets)) {
+            hosts.push_back(ip);
+            deviceId.setMacAddress(ip, mac);
+        }
+        return hosts;
     }
-
-    return hostInfoPairs;
+    if (thoroughScan) {
+        return scanner.thoroughScan(targets);
+    }
+    return scanner.scan(targets);
 }
 
 int main(int argc, char* argv[]) {
     size_t threadCount = std::thread::hardware_concurrency();
     std::string mode = "fallback";
     int port = 80;
+    std::vector<int> ports;
     int timeoutMs = 1000;
+    double rate = 0;
+    ScanBudget::Limits limits;
     bool skipScan = false;
     bool thoroughScan = false;
     bool showAll = false;
+    bool showLatency = false;
     bool showBanner = true;
     bool clearScr = true;
     bool jsonOutput = false;
     bool noColor = false;
+    bool useNeighbors = true;
+    bool useSurvey = false;
+    bool useHistory = true;
+    bool pruneSilent = false;
+    bool usePublicIp = true;
+    bool allInterfaces = false;
+    bool useDiscovery = true;
+    bool useUdpProbes = true;
+    std::string snmpCommunity = "public";
+    std::string targetsPath;
+    std::string excludePath;
+    std::string metricsListen;
+    std::string tracePath;
     int returnCode = 0;
 
     std::vector<std::string> args(argv, argv + argc);
@@ -331,7 +470,7 @@ int main(int argc, char* argv[]) {
             }
         } else if (args[i] == "--mode" && i + 1 < args.size()) {
             mode = args[++i];
-            if (mode != "icmp" && mode != "tcp" && mode != "fallback") {
+            if (mode != "icmp" && mode != "tcp" && mode != "fallback" && mode != "syn" && mode != "arp") {
                 std::cout << "Invalid mode, using default." << std::endl;
                 mode = "fallback";
             }
@@ -345,6 +484,17 @@ int main(int argc, char* argv[]) {
             } catch (...) {
                 std::cout << "Invalid port, using default." << std::endl;
             }
+        } else if (args[i] == "--ports" && i + 1 < args.size()) {
+            try {
+                ports = Utils::parsePortList(args[++i]);
+            } catch (...) {
+                std::cout << "Invalid port list, ignoring --ports." << std::endl;
+                ports.clear();
+            }
+        } else if (args[i] == "--targets" && i + 1 < args.size()) {
+            targetsPath = args[++i];
+        } else if (args[i] == "--exclude" && i + 1 < args.size()) {
+            excludePath = args[++i];
         } else if (args[i] == "--timeout" && i + 1 < args.size()) {
             try {
                 timeoutMs = std::stoi(args[++i]);
@@ -355,6 +505,40 @@ int main(int argc, char* argv[]) {
             } catch (...) {
                 std::cout << "Invalid timeout, using default." << std::endl;
             }
+        } else if (args[i] == "--rate" && i + 1 < args.size()) {
+            try {
+                rate = std::stod(args[++i]);
+                if (rate < 0) {
+                    std::cout << "Invalid rate, using default." << std::endl;
+                    rate = 0;
+                }
+            } catch (...) {
+                std::cout << "Invalid rate, using default." << std::endl;
+            }
+        } else if (args[i] == "--max-duration" && i + 1 < args.size()) {
+            try {
+                const double seconds = std::stod(args[++i]);
+                if (seconds <= 0) {
+                    std::cout << "Invalid duration, ignoring --max-duration." << std::endl;
+                } else {
+                    limits.maxDuration = std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+                }
+            } catch (...) {
+                std::cout << "Invalid duration, ignoring --max-duration." << std::endl;
+            }
+        } else if ((args[i] == "--max-hosts" || args[i] == "--max-probes") && i + 1 < args.size()) {
+            const std::string& option = args[i];
+            uint64_t& limit = option == "--max-hosts" ? limits.maxHosts : limits.maxProbes;
+            try {
+                const long long value = std::stoll(args[++i]);
+                if (value < 1) {
+                    std::cout << "Invalid count, ignoring " << option << "." << std::endl;
+                } else {
+                    limit = static_cast<uint64_t>(value);
+                }
+            } catch (...) {
+                std::cout << "Invalid count, ignoring " << option << "." << std::endl;
+            }
         } else if (args[i] == "--help") {
             printUsage(argv[0]);
             return 0;
@@ -367,12 +551,37 @@ int main(int argc, char* argv[]) {
             thoroughScan = true;
         } else if (args[i] == "--show-all") {
             showAll = true;
+        } else if (args[i] == "--stats") {
+            showLatency = true;
         } else if (args[i] == "--no-banner") {
             showBanner = false;
         } else if (args[i] == "--no-clear") {
             clearScr = false;
         } else if (args[i] == "--json") {
             jsonOutput = true;
+        } else if (args[i] == "--trace" && i + 1 < args.size()) {
+            tracePath = args[++i];
+        } else if (args[i] == "--metrics-listen" && i + 1 < args.size()) {
+            metricsListen = args[++i];
+        } else if (args[i] == "--snmp-community" && i + 1 < args.size()) {
+            snmpCommunity = args[++i];
+        } else if (args[i] == "--no-udp") {
+            useUdpProbes = false;
+        } else if (args[i] == "--no-discovery") {
+            useDiscovery = false;
+        } else if (args[i] == "--no-history") {
+            useHistory = false;
+        } else if (args[i] == "--survey") {
+            useSurvey = true;
+        } else if (args[i] == "--prune-silent") {
+            useSurvey = true;
+            pruneSilent = true;
+        } else if (args[i] == "--no-neighbors") {
+            useNeighbors = false;
+        } else if (args[i] == "--no-public-ip") {
+            usePublicIp = false;
+        } else if (args[i] == "--all-interfaces") {
+            allInterfaces = true;
         } else if (args[i] == "--no-color") {
             noColor = true;
         } else if (args[i] == "--verbose") {
@@ -397,6 +606,28 @@ int main(int argc, char* argv[]) {
     // Install signal handler for graceful Ctrl+C
     SignalHandler::install();
 
+    // Records phase and sampled probe spans; the file is written when main returns
+    std::unique_ptr<Trace::Session> trace;
+    if (!tracePath.empty()) {
+        try {
+            trace = std::make_unique<Trace::Session>(tracePath);
+        } catch (const std::exception& e) {
+            std::cerr << Colors::RED << "[!] --trace: " << e.what() << Colors::RESET << std::endl;
+            return 1;
+        }
+    }
+
+    // Serves scrapes from a background thread until main returns
+    std::unique_ptr<Metrics::Server> metricsServer;
+    if (!metricsListen.empty()) {
+        try {
+            metricsServer = std::make_unique<Metrics::Server>(metricsListen);
+        } catch (const std::exception& e) {
+            std::cerr << Colors::RED << "[!] --metrics-listen: " << e.what() << Colors::RESET << std::endl;
+            return 1;
+        }
+    }
+
     if (clearScr) {
         clearScreen();
     }
@@ -405,12 +636,24 @@ int main(int argc, char* argv[]) {
         printPixelAsciiArt();
     }
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    const CurlGlobal curlGlobal;
 
-    NetworkInfo info = getNetworkInfo();
+    NetworkInfo info = [] {
+        Trace::Span span("network-info");
+        return getNetworkInfo();
+    }();
+
+    // The public IP is cached on disk and otherwise resolved while the scan runs;
+    // it is shown up front only if it is already known
+    std::unique_ptr<PublicIpLookup> publicIp;
+    if (usePublicIp) {
+        publicIp = std::make_unique<PublicIpLookup>();
+    }
+    const bool publicIpShown = !publicIp || publicIp->ready();
+    info.publicIp = !publicIp ? "Skipped" : publicIpShown ? publicIp->get() : "Resolving...";
 
     if (!jsonOutput) {
-        printCompactNetworkInfo(info, threadCount, mode, port, thoroughScan, timeoutMs);
+        printCompactNetworkInfo(info, threadCount, mode, port, thoroughScan, timeoutMs, ports);
     }
 
     // Use actual subnet mask instead of hardcoded /24
@@ -430,36 +673,95 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    bool differentSubnets = (localSubnet != gatewaySubnet) && !info.gatewayIp.empty();
-
-    // Warn if subnet is larger than /16
-    {
-        auto [start, end] = Utils::parseCIDR(localSubnet);
-        uint32_t hostCount = end - start + 1;
-        if (hostCount > 65536 && !jsonOutput) {
+    std::vector<Interfaces::Interface> localInterfaces;
+    if (allInterfaces && targetsPath.empty()) {
+        Trace::Span span("interfaces");
+        localInterfaces = Interfaces::list();
+        if (localInterfaces.empty()) {
+            Logger::warn("No IPv4 interfaces found, scanning ", localSubnet, " only");
+        } else if (!jsonOutput) {
             using namespace Colors;
-            std::cout << RED << "[!] WARNING: Subnet " << localSubnet << " contains " << hostCount
-                      << " hosts. This scan may take a very long time." << RESET << std::endl;
-            std::cout << RED << "[!] Consider using a smaller subnet range." << RESET << std::endl;
+            for (const auto& iface : localInterfaces) {
+                std::cout << GREEN << "[+] Interface " << YELLOW << iface.name << GREEN << ": "
+                          << YELLOW << iface.cidr() << RESET << std::endl;
+            }
         }
     }
 
+    // Explicit target lists replace the auto-detected subnet; exclusions apply to both
+    TargetSet excluded;
+    TargetSet targets;
+    std::string scanLabel = localSubnet;
+    try {
+        Trace::Span span("targets");
+        if (!excludePath.empty()) {
+            excluded.load(excludePath);
+        }
+        if (!targetsPath.empty()) {
+            targets.load(targetsPath);
+            scanLabel = targetsPath == "-" ? "stdin" : targetsPath;
+        } else if (!localInterfaces.empty()) {
+            // Every attached subnet plus the gateway's, scanned together instead of one after another
+            targets = Interfaces::subnetsOf(localInterfaces);
+            std::vector<std::string> subnets;
+            for (const auto& iface : localInterfaces) {
+                if (std::find(subnets.begin(), subnets.end(), iface.cidr()) == subnets.end()) subnets.push_back(iface.cidr());
+            }
+            if (!gatewaySubnet.empty() && !targets.contains(Utils::ipToUint(info.gatewayIp))) {
+                targets.add(TargetSet::hostsOf(gatewaySubnet));
+                subnets.push_back(gatewaySubnet);
+            }
+            scanLabel.clear();
+            for (const auto& subnet : subnets) scanLabel += (scanLabel.empty() ? "" : ", ") + subnet;
+        } else {
+            targets = TargetSet::hostsOf(localSubnet);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << Colors::RED << "[!] " << e.what() << Colors::RESET << std::endl;
+        return 1;
+    }
+    targets.subtract(excluded);
+
+    // The deny list is also enforced per address by the scanner, so hosts that
+    // reach it by other routes than the target set are never probed either
+    auto exclusionTrie = std::make_shared<PrefixTrie>();
+    for (const auto& [first, last] : excluded.ranges()) {
+        exclusionTrie->insertRange(first, last);
+    }
+
+    bool differentSubnets = targetsPath.empty() && localInterfaces.empty() && (localSubnet != gatewaySubnet) && !info.gatewayIp.empty();
+
+    // Warn if the target set is larger than a /16
+    if (targets.size() > 65536 && !jsonOutput) {
+        using namespace Colors;
+        std::cout << RED << "[!] WARNING: " << scanLabel << " contains " << targets.size()
+                  << " hosts. This scan may take a very long time." << RESET << std::endl;
+        std::cout << RED << "[!] Consider using a smaller subnet range." << RESET << std::endl;
+    }
+
+    if (targets.empty()) {
+        std::cerr << Colors::RED << "[!] Nothing to scan: target set is empty" << Colors::RESET << std::endl;
+        return 1;
+    }
+
     if (skipScan) {
         if (!jsonOutput) {
             using namespace Colors;
             std::cout << GREEN << "[!] Skipping network scan as requested." << RESET << std::endl;
+            if (!publicIpShown) {
+                const std::string address = publicIp->get();
+                std::cout << GREEN << "[+] Public IP address: " << YELLOW << address << RESET << std::endl;
+            }
         }
-        curl_global_cleanup();
         return returnCode;
     }
 
-    // In JSON mode, skip the prompt and auto-scan
-    if (!jsonOutput) {
-        promptScan(localSubnet);
+    // In JSON mode (or when targets came from stdin), skip the prompt and auto-scan
+    if (!jsonOutput && targetsPath != "-") {
+        promptScan(scanLabel, !targetsPath.empty(), targets.size());
         char response;
         std::cin >> response;
         if (tolower(response) != 'y') {
-            curl_global_cleanup();
             return returnCode;
         }
     }
@@ -469,33 +771,167 @@ int main(int argc, char* argv[]) {
         DeviceIdentifier deviceId;
 
         if (!jsonOutput) {
-            std::cout << std::endl << GREEN << "[+] Starting scan of " << YELLOW << localSubnet << RESET << std::endl;
+            std::cout << std::endl << GREEN << "[+] Starting scan of " << YELLOW << scanLabel << RESET << std::endl;
         }
 
         NetworkScanner scanner(threadCount, mode, port, timeoutMs);
+        if (!exclusionTrie->empty()) {
+            scanner.setExclusions(exclusionTrie);
+        }
+        scanner.setInterface(info.interfaceName);
+        scanner.setRate(rate);
+        if (!localInterfaces.empty()) {
+            scanner.setInterfaces(std::make_shared<Interfaces::Router>(localInterfaces));
+        }
+
+        // Likely-alive targets are probed before all others, so a scan cut short still finds most hosts
+        auto priority = std::make_shared<TargetSet>();
+        const auto addPriority = [&](const uint32_t ip) {
+            if (targets.contains(ip) && !exclusionTrie->contains(ip)) priority->add(ip, ip);
+        };
+        if (useHistory) {
+            Trace::Span span("history");
+            for (const uint32_t ip : ScanHistory::load(ScanHistory::defaultPath())) addPriority(ip);
+        }
+        if (!info.gatewayIp.empty()) {
+            addPriority(Utils::ipToUint(info.gatewayIp));
+        }
+
+        // Hosts the kernel resolved recently need no probe; failed resolutions get a short one.
+        // Only connect-style discovery uses this: SYN and ARP sweeps are cheap per host anyway.
+        uint64_t probesSaved = 0;
+        if (useNeighbors && mode != "arp") {
+            Trace::Span span("neighbors");
+            const bool connectMode = mode == "icmp" || mode == "tcp" || mode == "fallback";
+            auto hints = std::make_shared<NeighborHints>();
+            uint64_t failedTargets = 0;
+            for (const auto& entry : Neighbors::dump()) {
+                if (!targets.contains(entry.ip) || exclusionTrie->contains(entry.ip)) continue;
+                if (entry.state == Neighbors::State::Alive) {
+                    hints->alive.insert(entry.ip);
+                    addPriority(entry.ip);
+                    if (!entry.mac.empty()) deviceId.setMacAddress(Utils::uintToIp(entry.ip), entry.mac);
+                } else if (entry.state == Neighbors::State::Failed) {
+                    hints->failed.insert(entry.ip);
+                    ++failedTargets;
+                } else {
+                    addPriority(entry.ip);
+                }
+            }
+            // A port scan still has to probe every port, so only host discovery saves probes
+            if (ports.empty() && connectMode) {
+                probesSaved = hints->alive.size() * (thoroughScan ? 4 : 1);
+            } else {
+                hints->alive.clear();
+            }
+            if (!jsonOutput && (!hints->alive.empty() || failedTargets > 0)) {
+                std::cout << GREEN << "[+] Neighbor table: " << YELLOW << hints->alive.size() << GREEN << " targets known alive, "
+                          << YELLOW << failedTargets << GREEN << " failed resolution" << RESET << std::endl;
+            }
+            if (connectMode) {
+                scanner.setNeighborHints(hints);
+            }
+        }
+
+        if (!priority->empty()) {
+            Logger::verbose("Scheduling ", priority->size(), " likely-alive targets first");
+            scanner.setPriorityHosts(priority);
+        }
 
         auto scanStart = std::chrono::steady_clock::now();
 
-        std::vector<std::string> localHosts;
-        try {
-            if (thoroughScan) {
+        // Limits run from here, so the survey counts against --max-duration too
+        auto budget = std::make_shared<ScanBudget>(limits);
+        scanner.setBudget(budget);
+
+        // Sparse /16 and larger sweeps: find the /24 blocks with signs of life before probing every address
+        std::shared_ptr<const BlockSurvey::Result> survey;
+        SurveyReport surveyReport;
+        if (useSurvey && mode != "arp") {
+            Trace::Span span("survey");
+            BlockSurvey::Options surveyOptions;
+            surveyOptions.timeoutMs = timeoutMs;
+            surveyOptions.rate = rate;
+            surveyOptions.exclusions = exclusionTrie.get();
+            surveyOptions.budget = budget.get();
+            auto result = std::make_shared<BlockSurvey::Result>(BlockSurvey::run(targets, surveyOptions));
+
+            if (result->ran) {
+                surveyReport.enabled = true;
+                surveyReport.pruned = pruneSilent;
+                surveyReport.blocks = result->blocks;
+                surveyReport.liveBlocks = result->liveBlocks.size();
+                surveyReport.silentTargets = result->silent.size();
+
                 if (!jsonOutput) {
-                    std::cout << GREEN << "[+] Using thorough scan mode (may take longer)" << RESET << std::endl;
+                    const double share = 100.0 * static_cast<double>(result->silent.size()) / static_cast<double>(targets.size());
+                    std::ostringstream shareStr;
+                    shareStr << std::fixed << std::setprecision(1) << share << "%";
+                    std::cout << GREEN << "[+] Block survey: " << YELLOW << result->liveBlocks.size() << GREEN << " of "
+                              << YELLOW << result->blocks << GREEN << " /24 blocks answered; " << YELLOW << result->silent.size()
+                              << GREEN << " targets (" << YELLOW << shareStr.str() << GREEN << ") in silent blocks "
+                              << (pruneSilent ? "will be skipped" : "are probed last") << RESET << std::endl;
                 }
-                localHosts = scanner.thoroughScan(localSubnet);
-            } else {
-                localHosts = scanner.scan(localSubnet);
+                survey = result;
+                scanner.setBlockSurvey(survey, pruneSilent);
+            }
+        }
+
+        // Two multicast queries identify most consumer devices at once; they
+        // run while the scan is in flight and are merged before identification
+        std::future<std::map<std::string, Discovery::DeviceHint>> discovery;
+        if (useDiscovery && !info.localIp.empty()) {
+            discovery = std::async(std::launch::async, [localIp = info.localIp] {
+                Trace::Span span("discovery");
+                return Discovery::run(localIp, 1500);
+            });
+        }
+
+        std::vector<std::string> localHosts;
+        OpenPortMap openPorts;
+        try {
+            if (thoroughScan && ports.empty() && !jsonOutput) {
+                std::cout << GREEN << "[+] Using thorough scan mode (may take longer)" << RESET << std::endl;
             }
+            Trace::Span span("scan");
+            localHosts = runScan(scanner, targets, thoroughScan, ports, openPorts, mode, deviceId);
         } catch (const std::exception& e) {
             std::cerr << RED << "[!] Error during scan: " << e.what() << RESET << std::endl;
-            curl_global_cleanup();
             return 1;
         }
 
-        if (SignalHandler::isInterrupted()) {
-            if (!jsonOutput) {
-                std::cout << std::endl << YELLOW << "[!] Scan interrupted by user. Showing partial results." << RESET << std::endl;
+        const BudgetReport budgetReport = reportBudget(*budget, jsonOutput);
+
+        if (discovery.valid()) {
+            auto hints = [&discovery] {
+                Trace::Span span("discovery-wait");
+                return discovery.get();
+            }();
+            // Responders are live even when they dropped our probes
+            for (const auto& [ip, hint] : hints) {
+                const uint32_t addr = Utils::ipToUint(ip);
+                if (!targets.contains(addr) || exclusionTrie->contains(addr)) continue;
+                if (std::find(localHosts.begin(), localHosts.end(), ip) == localHosts.end()) {
+                    localHosts.push_back(ip);
+                }
             }
+            deviceId.setDiscoveryHints(std::move(hints));
+        }
+
+        if (survey) {
+            surveyReport.hostsFound = localHosts.size();
+            for (const auto& ip : localHosts) {
+                if (survey->liveBlocks.count(Utils::ipToUint(ip) >> 8)) ++surveyReport.hostsInLiveBlocks;
+            }
+        }
+
+        UdpProbes::Options udpOptions;
+        udpOptions.community = snmpCommunity;
+        udpOptions.timeoutMs = timeoutMs;
+        // Out of time: identify what was found without another round of probes
+        if (useUdpProbes && !SignalHandler::isInterrupted() && budget->reason() != ScanBudget::Limit::Duration) {
+            Trace::Span span("udp-probes");
+            deviceId.addUdpResults(UdpProbes::probe(localHosts, udpOptions));
         }
 
         if (!jsonOutput) {
@@ -507,9 +943,11 @@ int main(int argc, char* argv[]) {
         auto scanEnd = std::chrono::steady_clock::now();
         double durationSec = std::chrono::duration<double>(scanEnd - scanStart).count();
 
-        // Calculate total IPs scanned
-        auto [start, end] = Utils::parseCIDR(localSubnet);
-        uint32_t totalScanned = end - start + 1;
+        // Pruned silent blocks were never probed, nor was anything past a spent budget
+        uint64_t totalScanned = targets.size() - (surveyReport.pruned ? surveyReport.silentTargets : 0);
+        if (!budgetReport.truncatedBy.empty() && ports.empty()) {
+            totalScanned = std::min(totalScanned, budgetReport.probesSent);
+        }
 
         std::vector<std::pair<std::string, std::string>> confirmedHostInfoPairs;
         for (const auto& [ip, deviceType] : hostInfoPairs) {
@@ -518,10 +956,18 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (useHistory) {
+            std::vector<uint32_t> seen;
+            for (const auto& [ip, deviceType] : confirmedHostInfoPairs) seen.push_back(Utils::ipToUint(ip));
+            ScanHistory::record(ScanHistory::defaultPath(), seen);
+        }
+
         if (jsonOutput) {
+            info.publicIp = publicIp ? publicIp->get() : "";
             auto& displayPairs = showAll ? hostInfoPairs : confirmedHostInfoPairs;
-            outputJson(info, mode, port, threadCount, thoroughScan, timeoutMs,
-                      localSubnet, displayPairs, durationSec, totalScanned);
+            std::cout << JsonOutput::render(info, mode, port, threadCount, thoroughScan, timeoutMs, scanLabel, displayPairs,
+                                            durationSec, totalScanned, ports, openPorts, deviceId, probesSaved, surveyReport,
+                                            budgetReport);
         } else {
             auto& displayPairs = showAll ? hostInfoPairs : confirmedHostInfoPairs;
 
@@ -532,10 +978,17 @@ int main(int argc, char* argv[]) {
                           << YELLOW << hostInfoPairs.size() << GREEN << " total hosts detected" << RESET << std::endl;
             }
 
-            displayScanResults(displayPairs, "SCAN RESULTS");
-            displayScanStats(durationSec, totalScanned, hostInfoPairs.size(), confirmedHostInfoPairs.size());
+            displayScanResults(displayPairs, "SCAN RESULTS", openPorts, deviceId);
+            displayScanStats(durationSec, totalScanned, hostInfoPairs.size(), confirmedHostInfoPairs.size(), probesSaved, surveyReport, budgetReport);
+            if (showLatency) displayLatencyStats(Metrics::snapshot());
 
-            if (differentSubnets && !SignalHandler::isInterrupted()) {
+            if (!publicIpShown) {
+                const std::string address = publicIp->get();
+                std::cout << GREEN << "[+] Public IP address: " << YELLOW << address << RESET << std::endl;
+            }
+
+            if (differentSubnets && budgetReport.truncatedBy.empty()) {
+                Logger::flush();
                 std::cout << GREEN << "[ GATEWAY ]" << RESET << std::endl;
                 std::cout << GREEN << "--- Your gateway (" << YELLOW << info.gatewayIp << GREEN
                           << ") is in a different subnet (" << YELLOW << gatewaySubnet << GREEN << ")" << RESET << std::endl;
@@ -548,19 +1001,29 @@ int main(int argc, char* argv[]) {
 
                     auto gwScanStart = std::chrono::steady_clock::now();
 
+                    TargetSet gatewayTargets = TargetSet::hostsOf(gatewaySubnet);
+                    gatewayTargets.subtract(excluded);
+
+                    // The limits apply afresh: the clock ran on while the prompt waited
+                    auto gatewayBudget = std::make_shared<ScanBudget>(limits);
+                    scanner.setBudget(gatewayBudget);
+
                     std::vector<std::string> gatewayHosts;
+                    OpenPortMap gatewayOpenPorts;
                     try {
-                        if (thoroughScan) {
-                            gatewayHosts = scanner.thoroughScan(gatewaySubnet);
-                        } else {
-                            gatewayHosts = scanner.scan(gatewaySubnet);
-                        }
+                        Trace::Span span("gateway-scan");
+                        gatewayHosts = runScan(scanner, gatewayTargets, thoroughScan, ports, gatewayOpenPorts, mode, deviceId);
                     } catch (const std::exception& e) {
                         std::cerr << RED << "[!] Error during gateway scan: " << e.what() << RESET << std::endl;
-                        curl_global_cleanup();
                         return 1;
                     }
 
+                    const BudgetReport gatewayBudgetReport = reportBudget(*gatewayBudget, jsonOutput);
+
+                    if (useUdpProbes && !SignalHandler::isInterrupted() && gatewayBudget->reason() != ScanBudget::Limit::Duration) {
+                        deviceId.addUdpResults(UdpProbes::probe(gatewayHosts, udpOptions));
+                    }
+
                     std::cout << GREEN << "[+] Processing results..." << RESET << std::endl;
 
                     auto gatewayHostInfoPairs = processHosts(deviceId, gatewayHosts, jsonOutput);
@@ -568,8 +1031,10 @@ int main(int argc, char* argv[]) {
                     auto gwScanEnd = std::chrono::steady_clock::now();
                     double gwDuration = std::chrono::duration<double>(gwScanEnd - gwScanStart).count();
 
-                    auto [gwStart, gwEnd] = Utils::parseCIDR(gatewaySubnet);
-                    uint32_t gwTotalScanned = gwEnd - gwStart + 1;
+                    uint64_t gwTotalScanned = gatewayTargets.size();
+                    if (!gatewayBudgetReport.truncatedBy.empty() && ports.empty()) {
+                        gwTotalScanned = std::min(gwTotalScanned, gatewayBudgetReport.probesSent);
+                    }
 
                     std::vector<std::pair<std::string, std::string>> confirmedGatewayHostInfoPairs;
                     for (const auto& [ip, deviceType] : gatewayHostInfoPairs) {
@@ -587,14 +1052,13 @@ int main(int argc, char* argv[]) {
                                   << YELLOW << gatewayHostInfoPairs.size() << GREEN << " total hosts detected on gateway subnet" << RESET << std::endl;
                     }
 
-                    displayScanResults(displayGatewayPairs, "GATEWAY RESULTS");
-                    displayScanStats(gwDuration, gwTotalScanned, gatewayHostInfoPairs.size(), confirmedGatewayHostInfoPairs.size());
+                    displayScanResults(displayGatewayPairs, "GATEWAY RESULTS", gatewayOpenPorts, deviceId);
+                    displayScanStats(gwDuration, gwTotalScanned, gatewayHostInfoPairs.size(), confirmedGatewayHostInfoPairs.size(),
+                                     0, {}, gatewayBudgetReport);
                 }
             }
         }
     }
 
-    curl_global_cleanup();
-
     return returnCode;
 }
@@ -0,0 +1,263 @@
+#include "../include/metrics.hpp"
+#include "../include/signal_handler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace Metrics {
+    namespace {
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<Shard>> shards;   // every shard ever handed out
+        std::vector<Shard*> freeShards;               // shards of threads that have exited
+
+        // Returns its shard to the free list when the owning thread exits; the counts stay
+        struct Lease {
+            Shard* shard;
+
+            Lease() {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                if (!freeShards.empty()) {
+                    shard = freeShards.back();
+                    freeShards.pop_back();
+                } else {
+                    shards.push_back(std::make_unique<Shard>());
+                    shard = shards.back().get();
+                }
+            }
+
+            ~Lease() {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                freeShards.push_back(shard);
+            }
+        };
+    }
+
+    Shard& localShard() {
+        thread_local Lease lease;
+        return *lease.shard;
+    }
+
+    size_t bucketOf(const uint64_t micros) {
+        constexpr uint64_t exact = 1U << SUB_BUCKET_BITS;
+        if (micros < exact) return static_cast<size_t>(micros);
+
+        const int octave = 63 - __builtin_clzll(micros);
+        if (octave > MAX_OCTAVE) return BUCKETS - 1;
+        const uint64_t sub = (micros >> (octave - SUB_BUCKET_BITS)) & (exact - 1);
+        return (static_cast<size_t>(octave - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + static_cast<size_t>(sub);
+    }
+
+    uint64_t bucketLowerBound(const size_t bucket) {
+        constexpr size_t exact = 1U << SUB_BUCKET_BITS;
+        if (bucket < exact) return bucket;
+
+        const int octave = static_cast<int>(bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+        const uint64_t sub = bucket & (exact - 1);
+        return (exact + sub) << (octave - SUB_BUCKET_BITS);
+    }
+
+    namespace {
+        thread_local int stageOverride = -1;
+
+        void bump(std::atomic<uint64_t>& value, const uint64_t n = 1) {
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+
+    void recordProbe(ProbeType type, const Outcome outcome, const std::chrono::microseconds rtt) {
+        if (stageOverride >= 0) type = static_cast<ProbeType>(stageOverride);
+        Shard& shard = localShard();
+        auto& latency = shard.latency[static_cast<size_t>(type)];
+
+        bump(shard.counters[static_cast<size_t>(Counter::ProbesSent)]);
+        switch (outcome) {
+            case Outcome::Reply: {
+                bump(shard.counters[static_cast<size_t>(Counter::Replies)]);
+                const auto micros = static_cast<uint64_t>(std::max<int64_t>(0, rtt.count()));
+                bump(latency.buckets[bucketOf(micros)]);
+                bump(latency.sumMicros, micros);
+                if (micros > latency.maxMicros.load(std::memory_order_relaxed)) {
+                    latency.maxMicros.store(micros, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case Outcome::Timeout:
+                bump(shard.counters[static_cast<size_t>(Counter::Timeouts)]);
+                bump(latency.timeouts);
+                break;
+            case Outcome::Error:
+                bump(shard.counters[static_cast<size_t>(Counter::Errors)]);
+                bump(latency.errors);
+                break;
+        }
+    }
+
+    StageScope::StageScope(const ProbeType type) : previous(stageOverride) {
+        stageOverride = static_cast<int>(type);
+    }
+
+    StageScope::~StageScope() {
+        stageOverride = previous;
+    }
+
+    void Histogram::add(const uint64_t micros) {
+        ++buckets[bucketOf(micros)];
+        ++replies;
+        sumMicros += micros;
+        maxMicros = std::max(maxMicros, micros);
+    }
+
+    uint64_t Histogram::quantile(const double q) const {
+        if (replies == 0) return 0;
+
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(replies))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                const uint64_t upper = i + 1 < BUCKETS ? bucketLowerBound(i + 1) - 1 : maxMicros;
+                return std::min(upper, maxMicros);
+            }
+        }
+        return maxMicros;
+    }
+
+    Snapshot Snapshot::since(const Snapshot& earlier) const {
+        Snapshot delta = *this;
+        for (size_t i = 0; i < COUNTERS; ++i) delta.values[i] = values[i] - earlier.values[i];
+        return delta;
+    }
+
+    Snapshot snapshot() {
+        Snapshot total;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& shard : shards) {
+            for (size_t i = 0; i < COUNTERS; ++i) {
+                total.values[i] += shard->counters[i].load(std::memory_order_relaxed);
+            }
+            for (size_t t = 0; t < PROBE_TYPES; ++t) {
+                const auto& source = shard->latency[t];
+                Histogram& histogram = total.latency[t];
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    const uint64_t count = source.buckets[b].load(std::memory_order_relaxed);
+                    histogram.buckets[b] += count;
+                    histogram.replies += count;
+                }
+                histogram.timeouts += source.timeouts.load(std::memory_order_relaxed);
+                histogram.errors += source.errors.load(std::memory_order_relaxed);
+                histogram.maxMicros = std::max(histogram.maxMicros, source.maxMicros.load(std::memory_order_relaxed));
+                histogram.sumMicros += source.sumMicros.load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+    const char* name(const Counter counter) {
+        switch (counter) {
+            case Counter::ProbesSent: return "probes_sent";
+            case Counter::Replies: return "replies";
+            case Counter::Timeouts: return "timeouts";
+            case Counter::Errors: return "errors";
+            case Counter::HostsFound: return "hosts_found";
+            case Counter::JobsDone: return "jobs_done";
+            case Counter::Count: break;
+        }
+        return "";
+    }
+
+    const char* name(const ProbeType type) {
+        switch (type) {
+            case ProbeType::Icmp: return "icmp";
+            case ProbeType::Tcp: return "tcp";
+            case ProbeType::Identify: return "identify";
+            case ProbeType::Count: break;
+        }
+        return "";
+    }
+
+    std::string toJson(const Snapshot& snapshot) {
+        std::ostringstream json;
+        json << "{";
+        for (size_t i = 0; i < COUNTERS; ++i) {
+            json << (i ? ", " : "") << "\"" << name(static_cast<Counter>(i)) << "\": " << snapshot.values[i];
+        }
+        json << "}";
+        return json.str();
+    }
+
+    std::string latencyJson(const Snapshot& snapshot, const int indent) {
+        const std::string pad(static_cast<size_t>(indent), ' ');
+        const auto ms = [](const uint64_t micros) { return static_cast<double>(micros) / 1000.0; };
+
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3) << "{\n";
+        for (size_t t = 0; t < PROBE_TYPES; ++t) {
+            const Histogram& h = snapshot.latency[t];
+            json << pad << "  \"" << name(static_cast<ProbeType>(t)) << "\": {"
+                 << "\"replies\": " << h.replies << ", \"timeouts\": " << h.timeouts << ", \"errors\": " << h.errors
+                 << ", \"p50_ms\": " << ms(h.quantile(0.50)) << ", \"p90_ms\": " << ms(h.quantile(0.90))
+                 << ", \"p99_ms\": " << ms(h.quantile(0.99)) << ", \"max_ms\": " << ms(h.maxMicros) << "}"
+                 << (t + 1 < PROBE_TYPES ? "," : "") << "\n";
+        }
+        json << pad << "}";
+        return json.str();
+    }
+
+    Reporter::Reporter(std::string label, const uint64_t total, const bool enabled)
+        : label(std::move(label)), total(total), baseline(snapshot()), start(std::chrono::steady_clock::now()) {
+        if (enabled) thread = std::thread(&Reporter::loop, this);
+    }
+
+    Reporter::~Reporter() {
+        done = true;
+        if (thread.joinable()) {
+            thread.join();
+            std::cerr << "\r" << std::string(80, ' ') << "\r" << std::flush;
+        }
+    }
+
+    std::string Reporter::format(const std::string& label, const Snapshot& stage, const uint64_t total,
+                                 const std::chrono::duration<double> elapsed) {
+        const uint64_t current = std::min(stage[Counter::JobsDone], total);
+        constexpr int width = 30;
+        const int filled = total ? static_cast<int>((current * width) / total) : width;
+
+        std::ostringstream line;
+        if (!label.empty()) line << "[" << label << "] ";
+        line << "[";
+        for (int i = 0; i < width; ++i) line << (i < filled ? '#' : '.');
+        line << "] " << current << "/" << total;
+
+        // Rate and ETA only once there is something to extrapolate from
+        if (const double seconds = elapsed.count(); seconds >= 0.5 && current > 0) {
+            const double rate = static_cast<double>(current) / seconds;
+            line << "  " << static_cast<uint64_t>(rate) << "/s";
+            if (current < total) {
+                const auto eta = static_cast<uint64_t>(static_cast<double>(total - current) / rate);
+                line << "  ETA ";
+                if (eta >= 60) line << eta / 60 << "m" << eta % 60 << "s";
+                else line << eta << "s";
+            }
+        }
+        if (const uint64_t hosts = stage[Counter::HostsFound]; hosts > 0) {
+            line << "  " << hosts << (hosts == 1 ? " host" : " hosts");
+        }
+        return line.str();
+    }
+
+    void Reporter::loop() {
+        while (!done && !SignalHandler::isInterrupted()) {
+            const std::string line = format(label, snapshot().since(baseline), total,
+                                            std::chrono::steady_clock::now() - start);
+            // Pad over whatever a longer previous line left behind
+            std::cerr << "\r" << line << std::string(line.size() < 79 ? 79 - line.size() : 0, ' ') << std::flush;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
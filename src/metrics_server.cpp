@@ -0,0 +1,203 @@
+#include "../include/metrics_server.hpp"
+#include "../include/logger.hpp"
+#include "../include/utils.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace Metrics {
+    namespace {
+        const char* const PREFIX = "network_scanner_";
+
+        const char* help(const Counter counter) {
+            switch (counter) {
+                case Counter::ProbesSent: return "Probes put on the wire (host or host:port attempts and raw packets).";
+                case Counter::Replies: return "Probes the target answered.";
+                case Counter::Timeouts: return "Probes with no answer within the timeout.";
+                case Counter::Errors: return "Probes that could not be sent or failed locally.";
+                case Counter::HostsFound: return "Live hosts reported by the scan stages.";
+                case Counter::JobsDone: return "Units of stage progress (targets probed or skipped, hosts identified).";
+                case Counter::Count: break;
+            }
+            return "";
+        }
+
+        // Seconds with enough digits for microsecond bucket edges ("7e-06", "0.016383")
+        std::string seconds(const uint64_t micros) {
+            std::ostringstream out;
+            out.precision(9);
+            out << static_cast<double>(micros) / 1e6;
+            return out.str();
+        }
+
+        void sendAll(const int fd, const std::string& data) {
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags = MSG_NOSIGNAL;  // a scraper hanging up must not kill the scan with SIGPIPE
+#endif
+            size_t offset = 0;
+            while (offset < data.size()) {
+                const ssize_t n = send(fd, data.data() + offset, data.size() - offset, flags);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return;
+                offset += static_cast<size_t>(n);
+            }
+        }
+    }
+
+    std::string prometheusText(const Snapshot& snapshot) {
+        std::ostringstream text;
+
+        for (size_t i = 0; i < COUNTERS; ++i) {
+            const auto counter = static_cast<Counter>(i);
+            const std::string metric = std::string(PREFIX) + name(counter) + "_total";
+            text << "# HELP " << metric << " " << help(counter) << "\n"
+                 << "# TYPE " << metric << " counter\n"
+                 << metric << " " << snapshot[counter] << "\n";
+        }
+
+        const std::string outcomes = std::string(PREFIX) + "probe_outcomes_total";
+        text << "# HELP " << outcomes << " Round-trip probes by type and outcome.\n"
+             << "# TYPE " << outcomes << " counter\n";
+        for (size_t t = 0; t < PROBE_TYPES; ++t) {
+            const Histogram& h = snapshot.latency[t];
+            const std::string type = name(static_cast<ProbeType>(t));
+            text << outcomes << "{type=\"" << type << "\",outcome=\"reply\"} " << h.replies << "\n"
+                 << outcomes << "{type=\"" << type << "\",outcome=\"timeout\"} " << h.timeouts << "\n"
+                 << outcomes << "{type=\"" << type << "\",outcome=\"error\"} " << h.errors << "\n";
+        }
+
+        // Octave edges line up with histogram bucket starts, and RTTs are whole microseconds, so
+        // the count below 2^k us is exactly the count at or below 2^k - 1 us: publishing that as
+        // le keeps the cumulative counts exact under Prometheus' inclusive le.
+        // The last bucket is open-ended and only appears under +Inf
+        const std::string rtt = std::string(PREFIX) + "probe_rtt_seconds";
+        text << "# HELP " << rtt << " Round-trip time of answered probes.\n"
+             << "# TYPE " << rtt << " histogram\n";
+        for (size_t t = 0; t < PROBE_TYPES; ++t) {
+            const Histogram& h = snapshot.latency[t];
+            const std::string type = name(static_cast<ProbeType>(t));
+
+            uint64_t cumulative = 0;
+            size_t bucket = 0;
+            for (int octave = SUB_BUCKET_BITS; octave <= MAX_OCTAVE; ++octave) {
+                const uint64_t edge = uint64_t{1} << octave;
+                for (; bucket < BUCKETS && bucketLowerBound(bucket) < edge; ++bucket) cumulative += h.buckets[bucket];
+                text << rtt << "_bucket{type=\"" << type << "\",le=\"" << seconds(edge - 1) << "\"} " << cumulative << "\n";
+            }
+            text << rtt << "_bucket{type=\"" << type << "\",le=\"+Inf\"} " << h.replies << "\n"
+                 << rtt << "_sum{type=\"" << type << "\"} " << seconds(h.sumMicros) << "\n"
+                 << rtt << "_count{type=\"" << type << "\"} " << h.replies << "\n";
+        }
+
+        return text.str();
+    }
+
+    Server::Server(const std::string& listen) {
+        const size_t colon = listen.rfind(':');
+        if (colon == std::string::npos) throw std::invalid_argument("expected ADDR:PORT, got " + listen);
+
+        const std::string address = listen.substr(0, colon);
+        if (!address.empty() && !Utils::isValidIpv4(address)) throw std::invalid_argument("invalid listen address: " + address);
+
+        int port = -1;
+        try {
+            size_t used = 0;
+            port = std::stoi(listen.substr(colon + 1), &used);
+            if (used != listen.size() - colon - 1) port = -1;
+        } catch (...) {
+        }
+        if (port < 0 || port > 65535) throw std::invalid_argument("invalid listen port: " + listen.substr(colon + 1));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (!address.empty()) inet_pton(AF_INET, address.c_str(), &addr.sin_addr);
+
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0) throw std::runtime_error("cannot create metrics socket: " + std::string(std::strerror(errno)));
+
+        const int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, 16) < 0) {
+            const std::string reason = std::strerror(errno);
+            close(listenFd);
+            throw std::runtime_error("cannot listen on " + listen + ": " + reason);
+        }
+
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        boundPort = ntohs(addr.sin_port);
+
+        Logger::verbose("Metrics: serving http://", address.empty() ? "0.0.0.0" : address, ":", boundPort, "/metrics");
+        thread = std::thread(&Server::loop, this);
+    }
+
+    Server::~Server() {
+        done = true;
+        if (thread.joinable()) thread.join();
+        close(listenFd);
+    }
+
+    void Server::loop() {
+        // Wake up regularly so destruction never waits on a scrape that does not come
+        pollfd pfd{listenFd, POLLIN, 0};
+        while (!done) {
+            if (poll(&pfd, 1, 200) <= 0) continue;
+            const int client = accept(listenFd, nullptr, nullptr);
+            if (client < 0) continue;
+            serve(client);
+            close(client);
+        }
+    }
+
+    void Server::serve(const int client) const {
+        // A stalled client gets one second, then the next scrape is served
+        timeval timeout{1, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            const ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        // Request line: METHOD SP PATH[?QUERY] SP VERSION
+        std::istringstream line(request.substr(0, request.find("\r\n")));
+        std::string method, target;
+        line >> method >> target;
+        const std::string path = target.substr(0, target.find('?'));
+
+        std::string status = "200 OK";
+        std::string body;
+        if (method != "GET" && method != "HEAD") {
+            status = "405 Method Not Allowed";
+            body = "only GET and HEAD are supported\n";
+        } else if (path == "/metrics") {
+            body = prometheusText(snapshot());
+        } else if (path == "/") {
+            body = "network-scanner metrics: /metrics\n";
+        } else {
+            status = "404 Not Found";
+            body = "not found\n";
+        }
+
+        std::string response = "HTTP/1.1 " + status + "\r\n"
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n";
+        if (method != "HEAD") response += body;
+        sendAll(client, response);
+    }
+}
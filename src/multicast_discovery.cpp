@@ -0,0 +1,296 @@
+#include "../include/multicast_discovery.hpp"
+#include "../include/logger.hpp"
+#include "../include/signal_handler.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+namespace Discovery {
+    namespace {
+        constexpr uint16_t DNS_TYPE_A = 1;
+        constexpr uint16_t DNS_TYPE_PTR = 12;
+        constexpr uint16_t DNS_TYPE_SRV = 33;
+        constexpr uint16_t DNS_CLASS_IN = 1;
+        constexpr uint16_t MDNS_UNICAST_RESPONSE = 0x8000;
+
+        const char* const MDNS_GROUP = "224.0.0.251";
+        constexpr uint16_t MDNS_PORT = 5353;
+        const char* const SSDP_GROUP = "239.255.255.250";
+        constexpr uint16_t SSDP_PORT = 1900;
+
+        // DNS-SD service types worth asking for directly, besides the enumeration meta-query
+        const std::vector<std::string> QUERY_NAMES = {
+            "_services._dns-sd._udp.local",
+            "_airplay._tcp.local",
+            "_raop._tcp.local",
+            "_companion-link._tcp.local",
+            "_googlecast._tcp.local",
+            "_ipp._tcp.local",
+            "_printer._tcp.local",
+            "_hap._tcp.local",
+            "_spotify-connect._tcp.local",
+            "_workstation._tcp.local",
+        };
+
+        // Service substring -> device type, most specific first
+        const std::vector<std::pair<std::string, std::string>> SERVICE_TYPES = {
+            {"_googlecast._tcp", "Google Chromecast"},
+            {"_airplay._tcp", "Apple TV"},
+            {"_companion-link._tcp", "Apple Device"},
+            {"_raop._tcp", "AirPlay Speaker"},
+            {"_ipp._tcp", "Printer"},
+            {"_printer._tcp", "Printer"},
+            {"_pdl-datastream._tcp", "Printer"},
+            {"_hap._tcp", "HomeKit Accessory"},
+            {"_spotify-connect._tcp", "Network Speaker"},
+            {"_smb._tcp", "File Server"},
+            {"_workstation._tcp", "Workstation"},
+        };
+
+        uint16_t get16(const uint8_t* p) {
+            return static_cast<uint16_t>((p[0] << 8) | p[1]);
+        }
+
+        void put16(std::vector<uint8_t>& out, const uint16_t v) {
+            out.push_back(static_cast<uint8_t>(v >> 8));
+            out.push_back(static_cast<uint8_t>(v));
+        }
+
+        // Read a possibly compressed name at offset; offset ends up after the name in the record
+        bool readName(const uint8_t* msg, const size_t len, size_t& offset, std::string& out) {
+            out.clear();
+            size_t pos = offset;
+            bool jumped = false;
+
+            for (int hops = 0; hops < 32; ++hops) {
+                if (pos >= len) return false;
+                const uint8_t labelLen = msg[pos];
+
+                if (labelLen == 0) {
+                    if (!jumped) offset = pos + 1;
+                    return true;
+                }
+                if ((labelLen & 0xc0) == 0xc0) {
+                    if (pos + 1 >= len) return false;
+                    if (!jumped) offset = pos + 2;
+                    pos = ((labelLen & 0x3f) << 8) | msg[pos + 1];
+                    jumped = true;
+                    continue;
+                }
+                if (pos + 1 + labelLen > len) return false;
+                if (!out.empty()) out += '.';
+                out.append(reinterpret_cast<const char*>(msg + pos + 1), labelLen);
+                pos += 1 + labelLen;
+            }
+            return false;  // pointer loop
+        }
+
+        std::string stripLocal(std::string name) {
+            if (const std::string suffix = ".local"; name.size() > suffix.size() &&
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                name.erase(name.size() - suffix.size());
+            }
+            return name;
+        }
+
+        std::string lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](const unsigned char c) { return std::tolower(c); });
+            return s;
+        }
+
+        int openSocket(const in_addr& iface) {
+            const int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+            if (sockfd < 0) return -1;
+            if (iface.s_addr != 0) {
+                setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+            }
+            const unsigned char ttl = 1;
+            setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            return sockfd;
+        }
+
+        bool sendTo(const int sockfd, const void* data, const size_t len, const char* group, const uint16_t port) {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            inet_pton(AF_INET, group, &addr.sin_addr);
+            return sendto(sockfd, data, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) >= 0;
+        }
+    }
+
+    std::vector<uint8_t> buildMdnsQuery(const std::vector<std::string>& names) {
+        std::vector<uint8_t> out;
+        put16(out, 0);                                  // id
+        put16(out, 0);                                  // flags: standard query
+        put16(out, static_cast<uint16_t>(names.size())); // questions
+        put16(out, 0);
+        put16(out, 0);
+        put16(out, 0);
+
+        for (const auto& name : names) {
+            size_t start = 0;
+            while (start < name.size()) {
+                size_t dot = name.find('.', start);
+                if (dot == std::string::npos) dot = name.size();
+                out.push_back(static_cast<uint8_t>(dot - start));
+                out.insert(out.end(), name.begin() + static_cast<long>(start), name.begin() + static_cast<long>(dot));
+                start = dot + 1;
+            }
+            out.push_back(0);
+            put16(out, DNS_TYPE_PTR);
+            // QU bit: ask responders to answer us directly rather than the whole group
+            put16(out, DNS_CLASS_IN | MDNS_UNICAST_RESPONSE);
+        }
+        return out;
+    }
+
+    bool parseMdnsResponse(const uint8_t* msg, const size_t len, MdnsRecords& out) {
+        if (len < 12) return false;
+
+        const uint16_t questions = get16(msg + 4);
+        const uint16_t records = get16(msg + 6) + get16(msg + 8) + get16(msg + 10);
+        size_t offset = 12;
+        std::string name;
+
+        for (uint16_t i = 0; i < questions; ++i) {
+            if (!readName(msg, len, offset, name) || offset + 4 > len) return false;
+            offset += 4;
+        }
+
+        for (uint16_t i = 0; i < records; ++i) {
+            if (!readName(msg, len, offset, name) || offset + 10 > len) return false;
+            const uint16_t type = get16(msg + offset);
+            const uint16_t rdLength = get16(msg + offset + 8);
+            offset += 10;
+            if (offset + rdLength > len) return false;
+
+            size_t rdata = offset;
+            std::string target;
+            switch (type) {
+                case DNS_TYPE_PTR:
+                    if (!readName(msg, len, rdata, target)) return false;
+                    out.services.push_back(name);
+                    out.services.push_back(target);
+                    break;
+                case DNS_TYPE_SRV:
+                    rdata += 6;  // priority, weight, port
+                    if (rdLength < 7 || !readName(msg, len, rdata, target)) return false;
+                    out.services.push_back(name);
+                    if (out.hostname.empty()) out.hostname = stripLocal(target);
+                    break;
+                case DNS_TYPE_A:
+                    if (out.hostname.empty() && name.find("._") == std::string::npos) out.hostname = stripLocal(name);
+                    break;
+                default:
+                    break;
+            }
+            offset += rdLength;
+        }
+        return true;
+    }
+
+    std::string classifyServices(const std::vector<std::string>& services) {
+        for (const auto& [service, deviceType] : SERVICE_TYPES) {
+            for (const auto& name : services) {
+                if (lower(name).find(service) != std::string::npos) return deviceType;
+            }
+        }
+        return "";
+    }
+
+    std::string classifySsdpResponse(const std::string& response) {
+        const std::string text = lower(response);
+        if (text.rfind("http/1.1 200", 0) != 0) return "";
+
+        if (text.find("roku") != std::string::npos) return "Roku Device";
+        if (text.find("internetgatewaydevice") != std::string::npos) return "Router (UPnP IGD)";
+        if (text.find("mediarenderer") != std::string::npos) return "Media Renderer";
+        if (text.find("mediaserver") != std::string::npos) return "Media Server";
+        if (text.find("dial-multiscreen") != std::string::npos) return "Smart TV";
+        if (text.find("printer") != std::string::npos) return "Printer";
+        if (text.find("sonos") != std::string::npos) return "Sonos Speaker";
+        return "UPnP Device";
+    }
+
+    std::map<std::string, DeviceHint> run(const std::string& localIp, const int windowMs) {
+        std::map<std::string, DeviceHint> hints;
+
+        in_addr iface{};
+        inet_pton(AF_INET, localIp.c_str(), &iface);
+
+        const int mdnsSock = openSocket(iface);
+        const int ssdpSock = openSocket(iface);
+        if (mdnsSock < 0 || ssdpSock < 0) {
+            Logger::debug("Discovery: cannot open UDP sockets");
+            if (mdnsSock >= 0) close(mdnsSock);
+            if (ssdpSock >= 0) close(ssdpSock);
+            return hints;
+        }
+
+        // Sent from an ephemeral port, so responders reply to us with unicast (RFC 6762 section 6.7)
+        const std::vector<uint8_t> query = buildMdnsQuery(QUERY_NAMES);
+        if (!sendTo(mdnsSock, query.data(), query.size(), MDNS_GROUP, MDNS_PORT)) {
+            Logger::debug("Discovery: mDNS query could not be sent");
+        }
+
+        const std::string search =
+            "M-SEARCH * HTTP/1.1\r\n"
+            "HOST: 239.255.255.250:1900\r\n"
+            "MAN: \"ssdp:discover\"\r\n"
+            "MX: 1\r\n"
+            "ST: ssdp:all\r\n\r\n";
+        if (!sendTo(ssdpSock, search.data(), search.size(), SSDP_GROUP, SSDP_PORT)) {
+            Logger::debug("Discovery: SSDP M-SEARCH could not be sent");
+        }
+
+        pollfd fds[2] = {{mdnsSock, POLLIN, 0}, {ssdpSock, POLLIN, 0}};
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(windowMs);
+        uint8_t buf[9000];
+
+        while (!SignalHandler::isInterrupted()) {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0 || poll(fds, 2, static_cast<int>(remaining)) <= 0) break;
+
+            for (const auto& pfd : fds) {
+                if (!(pfd.revents & POLLIN)) continue;
+
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                const ssize_t n = recvfrom(pfd.fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+                if (n <= 0) continue;
+
+                char ipBuf[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &from.sin_addr, ipBuf, sizeof(ipBuf));
+
+                if (pfd.fd == mdnsSock) {
+                    MdnsRecords records;
+                    if (!parseMdnsResponse(buf, static_cast<size_t>(n), records)) continue;
+                    DeviceHint& hint = hints[ipBuf];
+                    if (hint.hostname.empty()) hint.hostname = records.hostname;
+                    // mDNS service types are more specific than SSDP's, so they win
+                    if (const std::string type = classifyServices(records.services); !type.empty()) {
+                        hint.deviceType = type;
+                    }
+                } else {
+                    const std::string type = classifySsdpResponse(std::string(reinterpret_cast<const char*>(buf), static_cast<size_t>(n)));
+                    if (type.empty()) continue;
+                    if (DeviceHint& hint = hints[ipBuf]; hint.deviceType.empty()) hint.deviceType = type;
+                }
+            }
+        }
+
+        close(mdnsSock);
+        close(ssdpSock);
+
+        Logger::verbose("Discovery: ", hints.size(), " devices answered mDNS/SSDP");
+        return hints;
+    }
+}
@@ -0,0 +1,112 @@
+#include "../include/neighbors.hpp"
+#include "../include/netlink.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/neighbour.h>
+#include <linux/rtnetlink.h>
+#endif
+
+namespace Neighbors {
+    namespace {
+        // /proc/net/arp flag bits (ATF_COM, ATF_PERM)
+        constexpr unsigned long ARP_FLAG_COMPLETE = 0x2;
+        constexpr unsigned long ARP_FLAG_PERMANENT = 0x4;
+    }
+
+    std::vector<Entry> parseProcArp(std::istream& in) {
+        std::vector<Entry> entries;
+        std::string line;
+        std::getline(in, line); // skip header
+
+        while (std::getline(in, line)) {
+            std::istringstream iss(line);
+            std::string arpIp, hwType, flags, hwAddr;
+            if (!(iss >> arpIp >> hwType >> flags >> hwAddr) || !Utils::isValidIpv4(arpIp)) continue;
+
+            const unsigned long flagBits = std::strtoul(flags.c_str(), nullptr, 16);
+            const bool resolved = hwAddr != "00:00:00:00:00:00";
+
+            Entry entry{Utils::ipToUint(arpIp), resolved ? hwAddr : "", State::Failed};
+            if (flagBits & ARP_FLAG_PERMANENT) entry.state = State::Other;
+            else if ((flagBits & ARP_FLAG_COMPLETE) && resolved) entry.state = State::Alive;
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+#ifdef __linux__
+    bool parseNeighborMessage(const void* payload, const size_t len, Entry& out) {
+        if (len < NLMSG_ALIGN(sizeof(ndmsg))) return false;
+
+        const auto* nd = static_cast<const ndmsg*>(payload);
+        if (nd->ndm_family != AF_INET) return false;
+
+        bool haveIp = false;
+        out.mac.clear();
+
+        auto attrLen = static_cast<unsigned int>(len - NLMSG_ALIGN(sizeof(ndmsg)));
+        for (auto* attr = reinterpret_cast<const rtattr*>(reinterpret_cast<const uint8_t*>(payload) + NLMSG_ALIGN(sizeof(ndmsg)));
+             RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+            if (attr->rta_type == NDA_DST && RTA_PAYLOAD(attr) == 4) {
+                uint32_t addr;
+                std::memcpy(&addr, RTA_DATA(attr), 4);
+                out.ip = ntohl(addr);
+                haveIp = true;
+            } else if (attr->rta_type == NDA_LLADDR && RTA_PAYLOAD(attr) == 6) {
+                const auto* mac = static_cast<const uint8_t*>(RTA_DATA(attr));
+                char buf[18];
+                std::snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+                              mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+                out.mac = buf;
+            }
+        }
+
+        if (nd->ndm_state & (NUD_REACHABLE | NUD_STALE | NUD_DELAY | NUD_PROBE)) out.state = State::Alive;
+        else if (nd->ndm_state & (NUD_FAILED | NUD_INCOMPLETE)) out.state = State::Failed;
+        else out.state = State::Other;
+
+        return haveIp;
+    }
+#else
+    bool parseNeighborMessage(const void*, size_t, Entry&) {
+        return false;
+    }
+#endif
+
+    std::vector<Entry> dump() {
+        std::vector<Entry> entries;
+
+#ifdef __linux__
+        ndmsg request{};
+        request.ndm_family = AF_INET;
+
+        const bool ok = Netlink::dump(RTM_GETNEIGH, &request, sizeof(request),
+            [&entries](const uint16_t type, const void* payload, const size_t len) {
+                Entry entry{};
+                if (type == RTM_NEWNEIGH && parseNeighborMessage(payload, len, entry)) {
+                    entries.push_back(entry);
+                }
+            });
+        if (ok) {
+            Logger::debug("Neighbors: ", entries.size(), " entries via rtnetlink");
+            return entries;
+        }
+
+        entries.clear();
+        if (std::ifstream arpFile("/proc/net/arp"); arpFile.is_open()) {
+            entries = parseProcArp(arpFile);
+            Logger::debug("Neighbors: ", entries.size(), " entries via /proc/net/arp");
+        }
+#endif
+
+        return entries;
+    }
+}
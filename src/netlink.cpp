@@ -0,0 +1,78 @@
+#include "../include/netlink.hpp"
+#include "../include/logger.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <linux/netlink.h>
+#endif
+
+namespace Netlink {
+#ifdef __linux__
+    bool dump(const uint16_t type, const void* request, const size_t requestLen, const MessageHandler& onMessage) {
+        const int sockfd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (sockfd < 0) {
+            Logger::debug("Netlink: cannot open socket: ", std::strerror(errno));
+            return false;
+        }
+
+        // Request: header followed by the family-specific body, 4-byte aligned
+        std::vector<uint8_t> message(NLMSG_SPACE(requestLen), 0);
+        auto* header = reinterpret_cast<nlmsghdr*>(message.data());
+        header->nlmsg_len = static_cast<uint32_t>(NLMSG_LENGTH(requestLen));
+        header->nlmsg_type = type;
+        header->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        header->nlmsg_seq = 1;
+        std::memcpy(NLMSG_DATA(header), request, requestLen);
+
+        sockaddr_nl kernel{};
+        kernel.nl_family = AF_NETLINK;
+        if (sendto(sockfd, message.data(), header->nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+            Logger::debug("Netlink: dump request failed: ", std::strerror(errno));
+            close(sockfd);
+            return false;
+        }
+
+        std::vector<uint8_t> buf(32768);
+        bool done = false;
+        bool ok = true;
+
+        while (!done) {
+            const ssize_t n = recv(sockfd, buf.data(), buf.size(), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+
+            auto len = static_cast<unsigned int>(n);
+            for (auto* reply = reinterpret_cast<const nlmsghdr*>(buf.data()); NLMSG_OK(reply, len);
+                 reply = NLMSG_NEXT(reply, len)) {
+                if (reply->nlmsg_type == NLMSG_DONE) {
+                    done = true;
+                    break;
+                }
+                if (reply->nlmsg_type == NLMSG_ERROR) {
+                    Logger::debug("Netlink: kernel returned an error for dump type ", type);
+                    done = true;
+                    ok = false;
+                    break;
+                }
+                onMessage(reply->nlmsg_type, NLMSG_DATA(reply), reply->nlmsg_len - NLMSG_LENGTH(0));
+            }
+        }
+
+        close(sockfd);
+        return ok;
+    }
+#else
+    bool dump(uint16_t, const void*, size_t, const MessageHandler&) {
+        return false;
+    }
+#endif
+}
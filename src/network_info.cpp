@@ -1,11 +1,16 @@
 #include "../include/network_info.hpp"
+#include "../include/netlink.hpp"
 #include "../include/utils.hpp"
 #include "../include/logger.hpp"
+#include "../include/trace.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -15,6 +20,10 @@
 #include <ifaddrs.h>
 #include <curl/curl.h>
 
+#ifdef __linux__
+#include <linux/rtnetlink.h>
+#endif
+
 #ifdef __APPLE__
 #include <sys/sysctl.h>
 #include <net/route.h>
@@ -28,7 +37,13 @@ size_t WriteCallback(void* contents, const size_t size, const size_t nmemb, std:
     return size * nmemb;
 }
 
-std::string getPublicIP() {
+// Returning non-zero from the transfer callback makes curl abort the request
+static int CancelCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    const auto* cancel = static_cast<const std::atomic<bool>*>(clientp);
+    return cancel && cancel->load() ? 1 : 0;
+}
+
+std::string getPublicIP(const std::atomic<bool>* cancel) {
     std::string readBuffer;
 
     if (CURL* curl = curl_easy_init()) {
@@ -36,23 +51,172 @@ std::string getPublicIP() {
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+        // Runs off the main thread: no SIGALRM-based DNS timeouts
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        if (cancel) {
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, CancelCallback);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(cancel));
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        }
 
         const CURLcode res = curl_easy_perform(curl);
         curl_easy_cleanup(curl);
 
         if (res != CURLE_OK) {
-            Logger::debug("Failed to get public IP: " + std::string(curl_easy_strerror(res)));
+            Logger::debug("Failed to get public IP: ", curl_easy_strerror(res));
             return "Error: " + std::string(curl_easy_strerror(res));
         }
     }
 
-    Logger::debug("Public IP: " + readBuffer);
+    readBuffer.erase(readBuffer.find_last_not_of(" \t\r\n") + 1);
+    Logger::debug("Public IP: ", readBuffer);
     return readBuffer;
 }
 
+std::string publicIpCachePath() {
+    return Utils::cachePath("public_ip");
+}
+
+std::string readCachedPublicIP(const std::string& path, const long ttlSeconds) {
+    if (path.empty()) return "";
+
+    std::ifstream cacheFile(path);
+    long long stamp = 0;
+    std::string ip;
+    if (!(cacheFile >> stamp >> ip) || !Utils::isValidIpv4(ip)) return "";
+
+    const long long age = static_cast<long long>(std::time(nullptr)) - stamp;
+    if (age < 0 || age > ttlSeconds) {
+        Logger::debug("Public IP cache expired (", age, "s old)");
+        return "";
+    }
+    return ip;
+}
+
+bool writeCachedPublicIP(const std::string& path, const std::string& ip) {
+    if (!Utils::isValidIpv4(ip)) return false;
+    return Utils::writeFileAtomically(path, std::to_string(static_cast<long long>(std::time(nullptr))) + " " + ip + "\n");
+}
+
+PublicIpLookup::PublicIpLookup(const long ttlSeconds, std::string cachePath) : cachePath(std::move(cachePath)) {
+    if (std::string cached = readCachedPublicIP(this->cachePath, ttlSeconds); !cached.empty()) {
+        Logger::debug("Public IP from cache: ", cached);
+        std::promise<std::string> ready;
+        ready.set_value(std::move(cached));
+        result = ready.get_future().share();
+        return;
+    }
+
+    result = std::async(std::launch::async, [this] {
+        Trace::Span span("public-ip");
+        std::string ip = getPublicIP(&cancelled);
+        if (!cancelled.load()) writeCachedPublicIP(this->cachePath, ip);
+        return ip;
+    }).share();
+}
+
+PublicIpLookup::~PublicIpLookup() {
+    cancelled.store(true);
+    if (result.valid()) result.wait();
+}
+
+bool PublicIpLookup::ready() const {
+    return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::string PublicIpLookup::get() {
+    return result.get();
+}
+
+#ifdef __linux__
+// Interface, address and default gateway from rtnetlink: the default route in
+// the main table picks the interface, and its primary IPv4 address is used
+static bool detectViaNetlink(NetworkInfo& info) {
+    int routeIfIndex = 0;
+    uint32_t gateway = 0;
+
+    rtmsg routeRequest{};
+    routeRequest.rtm_family = AF_INET;
+    const bool routesOk = Netlink::dump(RTM_GETROUTE, &routeRequest, sizeof(routeRequest),
+        [&](const uint16_t type, const void* payload, const size_t len) {
+            if (type != RTM_NEWROUTE || routeIfIndex != 0 || len < NLMSG_ALIGN(sizeof(rtmsg))) return;
+
+            const auto* rt = static_cast<const rtmsg*>(payload);
+            if (rt->rtm_family != AF_INET || rt->rtm_dst_len != 0 || rt->rtm_table != RT_TABLE_MAIN) return;
+
+            int ifIndex = 0;
+            uint32_t via = 0;
+            auto attrLen = static_cast<unsigned int>(len - NLMSG_ALIGN(sizeof(rtmsg)));
+            for (auto* attr = RTM_RTA(rt); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+                if (attr->rta_type == RTA_OIF && RTA_PAYLOAD(attr) >= sizeof(int)) {
+                    std::memcpy(&ifIndex, RTA_DATA(attr), sizeof(int));
+                } else if (attr->rta_type == RTA_GATEWAY && RTA_PAYLOAD(attr) == 4) {
+                    std::memcpy(&via, RTA_DATA(attr), 4);
+                }
+            }
+            routeIfIndex = ifIndex;
+            gateway = via;
+        });
+    if (!routesOk) return false;
+
+    bool found = false;
+    ifaddrmsg addrRequest{};
+    addrRequest.ifa_family = AF_INET;
+    const bool addrsOk = Netlink::dump(RTM_GETADDR, &addrRequest, sizeof(addrRequest),
+        [&](const uint16_t type, const void* payload, const size_t len) {
+            if (type != RTM_NEWADDR || found || len < NLMSG_ALIGN(sizeof(ifaddrmsg))) return;
+
+            const auto* ifa = static_cast<const ifaddrmsg*>(payload);
+            if (ifa->ifa_family != AF_INET) return;
+            if (routeIfIndex != 0 && static_cast<int>(ifa->ifa_index) != routeIfIndex) return;
+
+            uint32_t local = 0;
+            uint32_t address = 0;
+            auto attrLen = static_cast<unsigned int>(len - NLMSG_ALIGN(sizeof(ifaddrmsg)));
+            for (auto* attr = IFA_RTA(ifa); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+                if (attr->rta_type == IFA_LOCAL && RTA_PAYLOAD(attr) == 4) {
+                    std::memcpy(&local, RTA_DATA(attr), 4);
+                } else if (attr->rta_type == IFA_ADDRESS && RTA_PAYLOAD(attr) == 4) {
+                    std::memcpy(&address, RTA_DATA(attr), 4);
+                }
+            }
+
+            // IFA_LOCAL is our address on point-to-point links, where IFA_ADDRESS is the peer
+            const std::string ip = Utils::uintToIp(ntohl(local ? local : address));
+            if (ip.find("127.") == 0 || ip.find("169.254.") == 0 || ip == "0.0.0.0") return;
+
+            char name[IF_NAMESIZE] = {};
+            if (!if_indextoname(ifa->ifa_index, name)) return;
+
+            const uint32_t mask = ifa->ifa_prefixlen == 0 ? 0 : (~0U << (32 - ifa->ifa_prefixlen));
+            info.localIp = ip;
+            info.interfaceName = name;
+            info.subnetMask = Utils::uintToIp(mask);
+            found = true;
+        });
+    if (!addrsOk || !found) return false;
+
+    if (gateway != 0) {
+        info.gatewayIp = Utils::uintToIp(ntohl(gateway));
+        Logger::debug("Gateway detected (netlink): ", info.gatewayIp);
+    } else {
+        Logger::debug("Gateway not detected");
+    }
+    Logger::debug("Detected interface (netlink): ", info.interfaceName, " IP: ", info.localIp, " mask: ", info.subnetMask);
+    return true;
+}
+#endif
+
 NetworkInfo getNetworkInfo() {
     NetworkInfo info;
 
+#ifdef __linux__
+    if (detectViaNetlink(info)) {
+        return info;
+    }
+    info = NetworkInfo{};
+#endif
+
     // Get local IP and interface name
     struct ifaddrs* ifap;
     if (getifaddrs(&ifap) == 0) {
@@ -77,7 +241,7 @@ NetworkInfo getNetworkInfo() {
                     info.subnetMask = maskBuffer;
                 }
 
-                Logger::debug("Detected interface: " + info.interfaceName + " IP: " + info.localIp + " mask: " + info.subnetMask);
+                Logger::debug("Detected interface: ", info.interfaceName, " IP: ", info.localIp, " mask: ", info.subnetMask);
                 break;
             }
         }
@@ -109,7 +273,7 @@ NetworkInfo getNetworkInfo() {
                 std::string gw(buffer);
                 auto parts = Utils::ipToUint(gw);
                 info.gatewayIp = Utils::uintToIp(parts);
-                Logger::debug("Gateway detected (Linux): " + info.gatewayIp);
+                Logger::debug("Gateway detected (Linux): ", info.gatewayIp);
                 break;
             }
         }
@@ -154,7 +318,7 @@ NetworkInfo getNetworkInfo() {
                         gw.erase(gw.find_last_not_of(" \t\r\n") + 1);
                         if (Utils::isValidIpv4(gw)) {
                             info.gatewayIp = gw;
-                            Logger::debug("Gateway detected (macOS): " + info.gatewayIp);
+                            Logger::debug("Gateway detected (macOS): ", info.gatewayIp);
                         }
                         break;
                     }
@@ -171,8 +335,6 @@ NetworkInfo getNetworkInfo() {
         Logger::debug("Gateway not detected");
     }
 
-    info.publicIp = getPublicIP();
-
     return info;
 }
 
@@ -0,0 +1,109 @@
+#include "../include/prefix_trie.hpp"
+#include "../include/utils.hpp"
+
+#include <algorithm>
+
+namespace {
+    uint32_t maskOf(const int length) {
+        return length == 0 ? 0 : (~0U << (32 - length));
+    }
+
+    // Bit at position `index` counted from the most significant bit
+    int bitAt(const uint32_t value, const int index) {
+        return static_cast<int>((value >> (31 - index)) & 1U);
+    }
+
+    int commonLength(const uint32_t a, const uint32_t b) {
+        const uint32_t diff = a ^ b;
+        return diff == 0 ? 32 : __builtin_clz(diff);
+    }
+}
+
+uint32_t PrefixTrie::newNode(const uint32_t prefix, const int length, const bool terminal) {
+    nodes.push_back({prefix, {NONE, NONE}, static_cast<uint8_t>(length), terminal});
+    if (terminal) ++prefixes;
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void PrefixTrie::insert(const std::string& cidr) {
+    const auto [start, end] = Utils::parseCIDR(cidr);
+    insertRange(start, end);
+}
+
+void PrefixTrie::insert(uint32_t prefix, const int length) {
+    prefix &= maskOf(length);
+
+    if (root == NONE) {
+        root = newNode(prefix, length, true);
+        return;
+    }
+
+    // (parent, side) identify the link that points at idx; parent NONE means root
+    uint32_t parent = NONE;
+    int side = 0;
+    uint32_t idx = root;
+
+    for (;;) {
+        const Node node = nodes[idx];
+        const int common = std::min({commonLength(node.prefix, prefix), static_cast<int>(node.length), length});
+
+        if (common < node.length) {
+            // The new prefix diverges inside this node's compressed path: split it
+            uint32_t split;
+            if (common == length) {
+                split = newNode(prefix, length, true);
+            } else {
+                split = newNode(prefix & maskOf(common), common, false);
+                const uint32_t leaf = newNode(prefix, length, true);
+                nodes[split].child[bitAt(prefix, common)] = leaf;
+            }
+            nodes[split].child[bitAt(node.prefix, common)] = idx;
+
+            if (parent == NONE) root = split;
+            else nodes[parent].child[side] = split;
+            return;
+        }
+
+        if (node.length == length) {
+            if (!node.terminal) {
+                nodes[idx].terminal = true;
+                ++prefixes;
+            }
+            return;
+        }
+
+        const int bit = bitAt(prefix, node.length);
+        if (node.child[bit] == NONE) {
+            const uint32_t leaf = newNode(prefix, length, true);
+            nodes[idx].child[bit] = leaf;
+            return;
+        }
+
+        parent = idx;
+        side = bit;
+        idx = node.child[bit];
+    }
+}
+
+void PrefixTrie::insertRange(const uint32_t first, const uint32_t last) {
+    uint64_t cursor = first;
+    while (cursor <= last) {
+        // Largest aligned block starting at cursor that doesn't pass last
+        int length = cursor == 0 ? 0 : 32 - __builtin_ctz(static_cast<uint32_t>(cursor));
+        while (length < 32 && cursor + (1ULL << (32 - length)) - 1 > last) ++length;
+
+        insert(static_cast<uint32_t>(cursor), length);
+        cursor += 1ULL << (32 - length);
+    }
+}
+
+bool PrefixTrie::contains(const uint32_t ip) const {
+    uint32_t idx = root;
+    while (idx != NONE) {
+        const Node& node = nodes[idx];
+        if ((ip & maskOf(node.length)) != node.prefix) return false;
+        if (node.terminal) return true;
+        idx = node.child[bitAt(ip, node.length)];
+    }
+    return false;
+}
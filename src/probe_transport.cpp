@@ -0,0 +1,242 @@
+#include "../include/probe_transport.hpp"
+#include "../include/icmp.hpp"
+#include "../include/tcp.hpp"
+#include "../include/fd_budget.hpp"
+#include "../include/signal_handler.hpp"
+#include "../include/logger.hpp"
+#include "../include/metrics.hpp"
+#include "../include/trace.hpp"
+#include "../include/usdt.hpp"
+
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <utility>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+    class SocketTransport final : public ProbeTransport {
+    public:
+        bool echo(uint32_t, const std::string& ipStr, const int timeoutMs, const Interfaces::Interface* via) override {
+            return Icmp::ping(ipStr, true, timeoutMs, via);
+        }
+
+        bool connect(uint32_t, const std::string& ipStr, const int port, const int timeoutMs,
+                     const Interfaces::Interface* via) override {
+            return Tcp::ping(ipStr, port, true, timeoutMs, via);
+        }
+
+        bool verify(uint32_t, const std::string& ip, const std::vector<int>& ports, const int quorum,
+                    const int timeoutMs, const Interfaces::Interface* via) override {
+            const size_t probes = 1 + ports.size();
+            Trace::Span span("verify", Trace::Category::Probe, ip);
+
+            // All probes are in flight at once, so a host costs at most one timeout
+            FdBudget::Slot slots(probes);
+            std::vector<pollfd> fds(probes);
+            fds[0] = {Icmp::sendEcho(ip, via), POLLIN, 0};
+            for (size_t i = 0; i < ports.size(); ++i) {
+                fds[i + 1] = {Tcp::startConnect(ip, ports[i], via), POLLOUT, 0};
+            }
+
+            const auto typeOf = [](const size_t i) { return i == 0 ? Metrics::ProbeType::Icmp : Metrics::ProbeType::Tcp; };
+            const auto start = std::chrono::steady_clock::now();
+            const auto rtt = [&start] {
+                return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            };
+
+            int pending = 0;
+            for (size_t i = 0; i < probes; ++i) {
+                if (fds[i].fd >= 0) {
+                    ++pending;
+                    SCANNER_PROBE(probe_send, static_cast<int>(typeOf(i)), ip.c_str(), i == 0 ? 0 : ports[i - 1]);
+                } else {
+                    Metrics::recordProbe(typeOf(i), Metrics::Outcome::Error);
+                }
+            }
+
+            const auto closeProbe = [&fds, &pending](const size_t i) {
+                if (i == 0) close(fds[i].fd);
+                else Tcp::closeAbortive(fds[i].fd);
+                fds[i].fd = -1;  // poll() ignores negative descriptors
+                --pending;
+            };
+
+            int successCount = 0;
+            const auto deadline = start + std::chrono::milliseconds(timeoutMs);
+            bool timedOut = false;
+
+            // Stop as soon as the quorum is met or can no longer be reached
+            while (successCount < quorum && successCount + pending >= quorum && !SignalHandler::isInterrupted()) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (remaining <= 0) {
+                    timedOut = true;
+                    break;
+                }
+
+                const int ready = poll(fds.data(), fds.size(), static_cast<int>(remaining));
+                if (ready < 0 && errno == EINTR) continue;
+                if (ready <= 0) {
+                    timedOut = ready == 0;
+                    break;
+                }
+
+                for (size_t i = 0; i < probes; ++i) {
+                    if (fds[i].fd < 0 || fds[i].revents == 0) continue;
+
+                    if (i == 0) {
+                        // A raw socket also sees unrelated ICMP traffic; keep waiting for our reply
+                        if (Icmp::readEchoReply(fds[i].fd, ip)) {
+                            ++successCount;
+                            const auto elapsed = rtt();
+                            SCANNER_PROBE(probe_reply, 0, ip.c_str(), 0, static_cast<long long>(elapsed.count()));
+                            Metrics::recordProbe(Metrics::ProbeType::Icmp, Metrics::Outcome::Reply, elapsed);
+                            closeProbe(i);
+                        } else if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                            Metrics::recordProbe(Metrics::ProbeType::Icmp, Metrics::Outcome::Error);
+                            closeProbe(i);
+                        }
+                    } else {
+                        const int error = Tcp::connectError(fds[i].fd);
+                        if (error == 0) ++successCount;
+                        if (error == 0 || error == ECONNREFUSED) {
+                            const auto elapsed = rtt();
+                            SCANNER_PROBE(probe_reply, 1, ip.c_str(), ports[i - 1], static_cast<long long>(elapsed.count()));
+                            Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Reply, elapsed);
+                        } else {
+                            Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Error);
+                        }
+                        closeProbe(i);
+                    }
+                }
+            }
+
+            // Probes abandoned once the verdict was settled are neither answers nor timeouts
+            for (size_t i = 0; i < probes; ++i) {
+                if (fds[i].fd < 0) continue;
+                if (timedOut) {
+                    SCANNER_PROBE(probe_timeout, static_cast<int>(typeOf(i)), ip.c_str(), i == 0 ? 0 : ports[i - 1]);
+                    Metrics::recordProbe(typeOf(i), Metrics::Outcome::Timeout);
+                } else {
+                    Metrics::add(Metrics::Counter::ProbesSent);
+                }
+                closeProbe(i);
+            }
+
+            Logger::debug("Verify ", ip, ": ", successCount, " of ", probes,
+                          " probes answered", (successCount >= quorum ? " (verified)" : ""));
+            return successCount >= quorum;
+        }
+    };
+
+    // splitmix64: every simulated property is one of these over (seed, address, ...)
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t hash(const uint64_t seed, const uint64_t a, const uint64_t b = 0, const uint64_t c = 0) {
+        return mix(mix(mix(seed ^ a) ^ b) ^ c);
+    }
+
+    // Uniform in [0, 1)
+    double unit(const uint64_t h) {
+        return static_cast<double>(h >> 11) * 0x1.0p-53;
+    }
+
+    // Standard normal from one hash (Box-Muller over its two halves)
+    double normal(const uint64_t h) {
+        const double u1 = (static_cast<double>(h >> 32) + 1) / 4294967297.0;
+        const double u2 = static_cast<double>(h & 0xffffffffULL) / 4294967296.0;
+        return std::sqrt(-2 * std::log(u1)) * std::cos(2 * M_PI * u2);
+    }
+
+    // Salts that keep the hashed properties independent of one another
+    enum Salt : uint64_t { Alive = 1, Echo, Port, Rtt, Jitter, Loss };
+}
+
+ProbeTransport& ProbeTransport::sockets() {
+    static SocketTransport transport;
+    return transport;
+}
+
+SimulatedTransport::SimulatedTransport(Model model) : model(std::move(model)), shards(new Shard[SHARDS]) {}
+
+bool SimulatedTransport::alive(const uint32_t ip) const {
+    return unit(hash(model.seed, Alive, ip)) < model.liveFraction;
+}
+
+bool SimulatedTransport::answersEcho(const uint32_t ip) const {
+    return alive(ip) && unit(hash(model.seed, Echo, ip)) < model.echoFraction;
+}
+
+bool SimulatedTransport::portOpen(const uint32_t ip, const int port) const {
+    if (!alive(ip)) return false;
+    bool listed = false;
+    for (const int p : model.ports) listed = listed || p == port;
+    return listed && unit(hash(model.seed, Port, ip, static_cast<uint64_t>(port))) < model.portFraction;
+}
+
+uint32_t SimulatedTransport::rttMicros(const uint32_t ip) const {
+    if (!alive(ip)) return 0;
+    return static_cast<uint32_t>(model.rttMedianMicros * std::exp(model.rttSpread * normal(hash(model.seed, Rtt, ip))));
+}
+
+uint32_t SimulatedTransport::bump(const uint64_t key) {
+    Shard& shard = shards[mix(key) % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.attempts[key]++;
+}
+
+uint32_t SimulatedTransport::nextAttempt(const uint32_t ip, const Kind kind, const int port) {
+    return bump(uint64_t{ip} << 32 | uint64_t{static_cast<uint8_t>(kind)} << 16 | static_cast<uint16_t>(port));
+}
+
+bool SimulatedTransport::takeReply(const uint32_t ip, const Kind kind) {
+    // Port numbers stop at 65535, so bit 24 never collides with an attempt key
+    return model.replyLimit == 0 || bump(uint64_t{ip} << 32 | uint64_t{1} << 24 | static_cast<uint8_t>(kind)) < model.replyLimit;
+}
+
+SimulatedTransport::Answer SimulatedTransport::probe(const uint32_t ip, const Kind kind, const int port,
+                                                    const int timeoutMs) {
+    probeCount.fetch_add(1, std::memory_order_relaxed);
+    const Metrics::ProbeType type = kind == Kind::Echo ? Metrics::ProbeType::Icmp : Metrics::ProbeType::Tcp;
+    const auto timeout = [type] {
+        Metrics::recordProbe(type, Metrics::Outcome::Timeout);
+        return Answer::Timeout;
+    };
+
+    // Nothing there: the probe vanishes, as it would on a quiet LAN
+    if (!alive(ip) || (kind == Kind::Echo && !answersEcho(ip))) return timeout();
+
+    const uint32_t attempt = nextAttempt(ip, kind, port);
+    const uint64_t probeKey = static_cast<uint64_t>(port) << 40 | uint64_t{static_cast<uint8_t>(kind)} << 32 | attempt;
+    if (unit(hash(model.seed, Loss, ip, probeKey)) < model.loss) return timeout();
+
+    const double rtt = rttMicros(ip) * std::exp(model.rttJitter * normal(hash(model.seed, Jitter, ip, probeKey)));
+    if (rtt > timeoutMs * 1000.0 || !takeReply(ip, kind)) return timeout();
+
+    Metrics::recordProbe(type, Metrics::Outcome::Reply, std::chrono::microseconds(static_cast<int64_t>(rtt)));
+    return kind == Kind::Connect && !portOpen(ip, port) ? Answer::Refused : Answer::Reply;
+}
+
+bool SimulatedTransport::echo(const uint32_t ip, const std::string&, const int timeoutMs, const Interfaces::Interface*) {
+    return probe(ip, Kind::Echo, 0, timeoutMs) == Answer::Reply;
+}
+
+bool SimulatedTransport::connect(const uint32_t ip, const std::string&, const int port, const int timeoutMs,
+                                 const Interfaces::Interface*) {
+    return probe(ip, Kind::Connect, port, timeoutMs) == Answer::Reply;
+}
+
+bool SimulatedTransport::verify(const uint32_t ip, const std::string& ipStr, const std::vector<int>& ports,
+                                const int quorum, const int timeoutMs, const Interfaces::Interface* via) {
+    // Every probe goes out at once, so each gets the full timeout
+    int successCount = echo(ip, ipStr, timeoutMs, via) ? 1 : 0;
+    for (const int port : ports) successCount += connect(ip, ipStr, port, timeoutMs, via) ? 1 : 0;
+    return successCount >= quorum;
+}
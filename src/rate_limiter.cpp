@@ -0,0 +1,28 @@
+#include "../include/rate_limiter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+RateLimiter::RateLimiter(const double ratePerSecond, const double burst)
+    : ratePerSecond(ratePerSecond), burst(std::max(1.0, burst)), tokens(this->burst), last(Clock::now()) {
+}
+
+void RateLimiter::acquire() {
+    if (ratePerSecond <= 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        const Clock::time_point now = Clock::now();
+        tokens = std::min(burst, tokens + std::chrono::duration<double>(now - last).count() * ratePerSecond);
+        last = now;
+
+        if (tokens >= 1.0) {
+            tokens -= 1.0;
+            return;
+        }
+
+        // Sleep until one token has accumulated; other senders wait on the lock
+        const auto wait = std::chrono::duration<double>((1.0 - tokens) / ratePerSecond);
+        std::this_thread::sleep_for(std::chrono::duration_cast<Clock::duration>(wait));
+    }
+}
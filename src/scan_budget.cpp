@@ -0,0 +1,53 @@
+#include "../include/scan_budget.hpp"
+#include "../include/logger.hpp"
+
+ScanBudget::ScanBudget() : ScanBudget(Limits{}) {
+}
+
+ScanBudget::ScanBudget(const Limits& limits) : limits(limits), deadline(Clock::now() + limits.maxDuration) {
+}
+
+void ScanBudget::trip(const Limit limit) {
+    // The first limit reached is the one reported
+    int expected = static_cast<int>(Limit::None);
+    if (tripped.compare_exchange_strong(expected, static_cast<int>(limit))) {
+        Logger::verbose("Scan budget: ", describe(limit), " reached after ", issued.load(),
+                        " probes and ", found.load(), " hosts; draining in-flight probes");
+    }
+}
+
+bool ScanBudget::exhausted() {
+    if (tripped.load() != static_cast<int>(Limit::None)) return true;
+    if (limits.maxDuration.count() > 0 && Clock::now() >= deadline) {
+        trip(Limit::Duration);
+        return true;
+    }
+    return false;
+}
+
+bool ScanBudget::acquire() {
+    if (exhausted()) return false;
+
+    if (const uint64_t previous = issued.fetch_add(1); limits.maxProbes > 0 && previous >= limits.maxProbes) {
+        issued.fetch_sub(1);
+        trip(Limit::Probes);
+        return false;
+    }
+    return true;
+}
+
+void ScanBudget::addHosts(const uint64_t count) {
+    if (count == 0) return;
+    const uint64_t total = found.fetch_add(count) + count;
+    if (limits.maxHosts > 0 && total >= limits.maxHosts) trip(Limit::Hosts);
+}
+
+std::string ScanBudget::describe(const Limit limit) {
+    switch (limit) {
+        case Limit::Duration: return "max-duration";
+        case Limit::Hosts: return "max-hosts";
+        case Limit::Probes: return "max-probes";
+        case Limit::None: break;
+    }
+    return "";
+}
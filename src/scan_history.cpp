@@ -0,0 +1,59 @@
+#include "../include/scan_history.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace ScanHistory {
+    std::string defaultPath() {
+        return Utils::cachePath("hosts");
+    }
+
+    std::map<uint32_t, long long> parse(std::istream& in, const long long now, const long maxAgeSeconds) {
+        std::map<uint32_t, long long> seen;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream iss(line);
+            std::string ip;
+            long long lastSeen = 0;
+            if (!(iss >> ip >> lastSeen) || !Utils::isValidIpv4(ip)) continue;
+            if (now - lastSeen > maxAgeSeconds) continue;
+
+            long long& entry = seen[Utils::ipToUint(ip)];
+            if (lastSeen > entry) entry = lastSeen;
+        }
+        return seen;
+    }
+
+    std::vector<uint32_t> load(const std::string& path, const long maxAgeSeconds) {
+        std::vector<uint32_t> hosts;
+        std::ifstream in(path);
+        if (!in.is_open()) return hosts;
+
+        for (const auto& [ip, lastSeen] : parse(in, std::time(nullptr), maxAgeSeconds)) {
+            hosts.push_back(ip);
+        }
+        Logger::debug("Scan history: ", hosts.size(), " previously seen hosts from ", path);
+        return hosts;
+    }
+
+    bool record(const std::string& path, const std::vector<uint32_t>& hosts, const long maxAgeSeconds) {
+        if (path.empty()) return false;
+
+        const long long now = std::time(nullptr);
+        std::map<uint32_t, long long> seen;
+        if (std::ifstream in(path); in.is_open()) {
+            seen = parse(in, now, maxAgeSeconds);
+        }
+        for (const uint32_t ip : hosts) {
+            seen[ip] = now;
+        }
+
+        std::ostringstream out;
+        for (const auto& [ip, lastSeen] : seen) {
+            out << Utils::uintToIp(ip) << " " << lastSeen << "\n";
+        }
+        return Utils::writeFileAtomically(path, out.str());
+    }
+}
@@ -1,290 +1,503 @@
 #include "../include/scanner.hpp"
 #include "../include/utils.hpp"
-#include "../include/icmp.hpp"
-#include "../include/tcp.hpp"
-#include "../include/thread_pool.hpp"
-#include "../include/signal_handler.hpp"
+#include "../include/syn.hpp"
+#include "../include/arp.hpp"
+#include "../include/rate_limiter.hpp"
+#include "../include/fd_budget.hpp"
 #include "../include/logger.hpp"
+#include "../include/target_set.hpp"
+#include "../include/prefix_trie.hpp"
+#include "../include/scan_pipeline.hpp"
+#include "../include/interfaces.hpp"
+#include "../include/block_survey.hpp"
+#include "../include/scan_budget.hpp"
+#include "../include/probe_transport.hpp"
+#include "../include/metrics.hpp"
 
-#include <atomic>
 #include <iostream>
-#include <mutex>
+#include <stdexcept>
 #include <vector>
 #include <thread>
-#include <chrono>
 #include <algorithm>
+#include <map>
+#include <chrono>
+#include <iterator>
+#include <memory>
+
+namespace {
+    // Default pace for ARP sweeps; broadcast storms upset switches and Wi-Fi access points
+    constexpr double ARP_DEFAULT_RATE = 1000;
+
+    // Probe strategies for ScanPipeline::run, one concrete type per scan mode
+
+    // Per-scan state every probe consults: its timeout, outgoing interface, pace and transport
+    struct ProbeContext {
+        int timeoutMs;
+        const std::unordered_set<uint32_t>* failed;
+        const Interfaces::Router* router;
+        RateLimiter* pacer;
+        ProbeTransport* transport;
+
+        // Hosts whose address resolution already failed get a quarter of the timeout
+        [[nodiscard]] int timeoutFor(const uint32_t ip) const {
+            return failed && failed->count(ip) ? std::max(100, timeoutMs / 4) : timeoutMs;
+        }
 
-Scanner::Scanner(const size_t threads, std::string mode, int port, int timeoutMs)
-    : threadCount(threads ? threads : std::thread::hardware_concurrency()),
-      mode(std::move(mode)),
-      port(port),
-      timeoutMs(timeoutMs) {
-}
+        // Wait for the shared rate budget, then pick the interface to probe ip from
+        [[nodiscard]] const Interfaces::Interface* start(const uint32_t ip) const {
+            pacer->acquire();
+            return router ? router->route(ip) : nullptr;
+        }
+    };
 
-void Scanner::run(const std::string &cidr) const {
-    auto [fst, snd] = Utils::parseCIDR(cidr);
-    uint32_t startIp = fst;
-    uint32_t endIp = snd;
-    ThreadPool pool(threadCount);
-
-    std::atomic<uint32_t> counter = 0;
-    const uint32_t total = endIp - startIp + 1;
-
-    std::mutex resultsMutex;
-    std::vector<std::string> discoveredIps;
-
-    std::atomic<bool> scanComplete = false;
-    std::thread progressThread([&counter, total, &scanComplete]() {
-        while (!scanComplete && !SignalHandler::isInterrupted()) {
-            const uint32_t done = counter.load();
-            constexpr int width = 30;
-            const int filled = static_cast<int>((done * width) / total);
-
-            std::cerr << "\r[";
-            for (int i = 0; i < width; ++i)
-                std::cerr << (i < filled ? '#' : '.');
-            std::cerr << "] " << done << "/" << total << std::flush;
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    struct IcmpProbe : ProbeContext {
+        bool operator()(const uint32_t ip, const std::string& ipStr, int) const {
+            const auto* via = start(ip);
+            return transport->echo(ip, ipStr, timeoutFor(ip), via);
         }
-    });
+    };
 
-    for (uint32_t ip = startIp; ip <= endIp; ++ip) {
-        pool.enqueue([ip, &counter, &resultsMutex, &discoveredIps, this] {
-            if (SignalHandler::isInterrupted()) { ++counter; return; }
+    struct TcpProbe : ProbeContext {
+        bool operator()(const uint32_t ip, const std::string& ipStr, const int port) const {
+            const auto* via = start(ip);
+            return transport->connect(ip, ipStr, port, timeoutFor(ip), via);
+        }
+    };
 
-            const std::string ipStr = Utils::uintToIp(ip);
-            bool isAlive = false;
+    struct FallbackProbe : ProbeContext {
+        bool operator()(const uint32_t ip, const std::string& ipStr, const int port) const {
+            const auto* via = start(ip);
+            const int timeout = timeoutFor(ip);
+            return transport->echo(ip, ipStr, timeout, via) || transport->connect(ip, ipStr, port, timeout, via);
+        }
+    };
+
+    // Credits the hosts an engine's receiver thread has seen so far to the metrics and the budget
+    class HostTally {
+    public:
+        explicit HostTally(ScanBudget* budget) : budget(budget) {}
+
+        void update(const size_t answered) {
+            if (answered <= counted) return;
+            Metrics::add(Metrics::Counter::HostsFound, answered - counted);
+            if (budget) budget->addHosts(answered - counted);
+            counted = answered;
+        }
 
-            if (mode == "icmp") {
-                isAlive = Icmp::ping(ipStr, true, timeoutMs);
-            } else if (mode == "tcp") {
-                isAlive = Tcp::ping(ipStr, port, true, timeoutMs);
-            } else if (mode == "fallback") {
-                isAlive = Icmp::ping(ipStr, true, timeoutMs) || Tcp::ping(ipStr, port, true, timeoutMs);
-            }
+    private:
+        ScanBudget* budget;
+        size_t counted = 0;
+    };
 
-            ++counter;
+    // Router-like block addresses get their own tier only while the extra ranges stay cheap
+    constexpr size_t MAX_PATTERN_BLOCKS = 65536;
 
-            if (isAlive) {
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                discoveredIps.push_back(ipStr);
-            }
-        });
+    std::vector<uint32_t> uniqueHosts(const std::vector<ScanPipeline::Hit>& hits) {
+        std::vector<uint32_t> hosts;
+        for (const auto& hit : hits) {
+            if (hosts.empty() || hosts.back() != hit.ip) hosts.push_back(hit.ip);
+        }
+        return hosts;
     }
 
-    while (counter < total && !SignalHandler::isInterrupted()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Sorted union of two sorted host lists
+    std::vector<uint32_t> mergeHosts(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        std::vector<uint32_t> merged;
+        merged.reserve(a.size() + b.size());
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged));
+        return merged;
     }
 
-    if (SignalHandler::isInterrupted()) {
-        pool.shutdown();
+    std::vector<std::string> toStrings(const std::vector<uint32_t>& hosts) {
+        std::vector<std::string> out;
+        out.reserve(hosts.size());
+        for (const uint32_t ip : hosts) out.push_back(Utils::uintToIp(ip));
+        return out;
     }
+}
 
-    scanComplete = true;
-    progressThread.join();
+ScanMode parseScanMode(const std::string& mode) {
+    if (mode == "icmp") return ScanMode::Icmp;
+    if (mode == "tcp") return ScanMode::Tcp;
+    if (mode == "fallback") return ScanMode::Fallback;
+    if (mode == "syn") return ScanMode::Syn;
+    if (mode == "arp") return ScanMode::Arp;
+    throw std::invalid_argument("unknown scan mode: " + mode);
+}
 
-    std::cerr << "\r" << std::string(80, ' ') << "\r";
+Scanner::Scanner(const size_t threads, const std::string& mode, int port, int timeoutMs)
+    : threadCount(threads ? threads : std::thread::hardware_concurrency()),
+      mode(parseScanMode(mode)),
+      port(port),
+      timeoutMs(timeoutMs) {
+    // Each worker holds at most one probe socket at a time; more threads than
+    // the descriptor budget would only queue on FdBudget::acquire().
+    if (const size_t budget = FdBudget::capacity(); threadCount > budget) {
+        Logger::warn("Limiting threads from ", threadCount, " to ", budget, " (file descriptor limit)");
+        threadCount = budget;
+    }
+}
 
-    std::sort(discoveredIps.begin(), discoveredIps.end(), [](const std::string& a, const std::string& b) {
-        return Utils::ipToUint(a) < Utils::ipToUint(b);
-    });
+void Scanner::setExclusions(std::shared_ptr<const PrefixTrie> trie) {
+    exclusions = std::move(trie);
+}
 
-    discoveredIps.erase(
-        std::remove_if(discoveredIps.begin(), discoveredIps.end(),
-            [startIp, endIp](const std::string& ip) {
-                uint32_t ipInt = Utils::ipToUint(ip);
-                return (ipInt == startIp || ipInt == endIp);
-            }),
-        discoveredIps.end()
-    );
+void Scanner::setInterface(const std::string& name) {
+    interfaceName = name;
+}
 
-    std::cout << "Discovered " << discoveredIps.size() << " live hosts:" << std::endl;
-    for (const auto& ip : discoveredIps) {
-        std::cout << ip << std::endl;
-    }
+void Scanner::setRate(const double packetsPerSecond) {
+    rate = packetsPerSecond;
+}
 
-    std::cerr << "Scan completed." << std::endl;
+void Scanner::setInterfaces(std::shared_ptr<const Interfaces::Router> interfaces) {
+    router = std::move(interfaces);
 }
 
-NetworkScanner::NetworkScanner(const size_t threads, std::string mode, int port, int timeoutMs)
-    : Scanner(threads, std::move(mode), port, timeoutMs) {
+void Scanner::setNeighborHints(std::shared_ptr<const NeighborHints> hints) {
+    neighbors = std::move(hints);
 }
 
-std::vector<std::string> NetworkScanner::scan(const std::string &cidr) const {
-    auto result = Utils::parseCIDR(cidr);
-    uint32_t startIp = result.first;
-    uint32_t endIp = result.second;
+void Scanner::setBlockSurvey(std::shared_ptr<const BlockSurvey::Result> result, const bool prune) {
+    survey = std::move(result);
+    pruneSilent = prune;
+}
 
-    Logger::verbose("Starting scan of " + cidr + " (" + std::to_string(endIp - startIp + 1) + " hosts)");
+void Scanner::setPriorityHosts(std::shared_ptr<const TargetSet> hosts) {
+    priorityHosts = std::move(hosts);
+}
 
-    ThreadPool pool(threadCount);
+void Scanner::setBudget(std::shared_ptr<ScanBudget> limits) {
+    budget = std::move(limits);
+}
 
-    std::atomic<uint32_t> counter = 0;
-    const uint32_t total = endIp - startIp + 1;
+void Scanner::setTransport(std::shared_ptr<ProbeTransport> probes) {
+    transport = std::move(probes);
+}
 
-    std::mutex resultsMutex;
-    std::vector<std::string> discoveredIps;
+ProbeTransport* Scanner::probeTransport() const {
+    return transport ? transport.get() : &ProbeTransport::sockets();
+}
 
-    std::atomic<bool> scanComplete = false;
-    std::thread progressThread([&counter, total, &scanComplete]() {
-        while (!scanComplete && !SignalHandler::isInterrupted()) {
-            const uint32_t done = counter.load();
-            constexpr int width = 30;
-            const int filled = static_cast<int>((done * width) / total);
+std::vector<TargetSet> Scanner::schedule(const TargetSet& targets) const {
+    std::vector<TargetSet> tiers;
+    TargetSet rest = targets;
+
+    // Move the part of tier still in rest into its own tier
+    const auto take = [&tiers, &rest](TargetSet tier) {
+        tier.intersect(rest);
+        if (tier.empty()) return;
+        rest.subtract(tier);
+        tiers.push_back(std::move(tier));
+    };
+
+    if (priorityHosts) take(*priorityHosts);
+
+    // Addresses conventionally given to routers and infrastructure, same as the survey's sentinels
+    if (const auto blocks = BlockSurvey::blocksOf(rest); blocks.size() <= MAX_PATTERN_BLOCKS) {
+        TargetSet pattern;
+        for (const uint32_t block : blocks) {
+            for (const uint32_t ip : BlockSurvey::probeAddresses(block, rest, nullptr)) pattern.add(ip, ip);
+        }
+        take(std::move(pattern));
+    }
 
-            std::cerr << "\r[";
-            for (int i = 0; i < width; ++i)
-                std::cerr << (i < filled ? '#' : '.');
-            std::cerr << "] " << done << "/" << total << std::flush;
+    // Only addresses the survey covered can be silent; anything else is scanned normally
+    TargetSet silent;
+    if (survey && survey->ran) {
+        silent = survey->silent;
+        silent.intersect(rest);
+        rest.subtract(silent);
+    }
+    take(rest);
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (!silent.empty()) {
+        if (pruneSilent) {
+            Logger::verbose("Block survey: skipping ", silent.size(), " targets in silent blocks");
+        } else {
+            tiers.push_back(std::move(silent));
         }
-    });
+    }
+    return tiers;
+}
 
-    for (uint32_t ip = startIp; ip <= endIp; ++ip) {
-        pool.enqueue([ip, &counter, &resultsMutex, &discoveredIps, this] {
-            if (SignalHandler::isInterrupted()) { ++counter; return; }
+TargetSet Scanner::withoutKnownAlive(const TargetSet& targets, std::vector<uint32_t>& knownAlive) const {
+    knownAlive.clear();
+    if (!neighbors || neighbors->alive.empty()) return targets;
 
-            const std::string ipStr = Utils::uintToIp(ip);
-            bool isAlive = false;
+    for (const uint32_t ip : neighbors->alive) {
+        if (!targets.contains(ip) || (exclusions && exclusions->contains(ip))) continue;
+        knownAlive.push_back(ip);
+    }
+    std::sort(knownAlive.begin(), knownAlive.end());
 
-            if (mode == "icmp") {
-                isAlive = Icmp::ping(ipStr, true, timeoutMs);
-            } else if (mode == "tcp") {
-                isAlive = Tcp::ping(ipStr, port, true, timeoutMs);
-            } else if (mode == "fallback") {
-                isAlive = Icmp::ping(ipStr, true, timeoutMs) || Tcp::ping(ipStr, port, true, timeoutMs);
-            }
+    // In ascending order every add() appends or extends the last range
+    TargetSet known;
+    for (const uint32_t ip : knownAlive) known.add(ip, ip);
 
-            ++counter;
+    if (!knownAlive.empty()) {
+        Logger::verbose("Neighbor table: ", knownAlive.size(), " targets already known alive, not probed");
+        Metrics::add(Metrics::Counter::HostsFound, knownAlive.size());
+        if (budget) budget->addHosts(knownAlive.size());
+    }
 
-            if (isAlive) {
-                Logger::debug("Host alive: " + ipStr);
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                discoveredIps.push_back(ipStr);
-            }
-        });
+    TargetSet remaining = targets;
+    remaining.subtract(known);
+    return remaining;
+}
+
+std::vector<uint32_t> Scanner::discover(const TargetSet& targets) const {
+    const PrefixTrie* deny = exclusions.get();
+    RateLimiter pacer(rate);
+    const ProbeContext context{timeoutMs, neighbors ? &neighbors->failed : nullptr, router.get(), &pacer, probeTransport()};
+
+    std::vector<uint32_t> knownAlive;
+
+    // The mode is resolved here, once per scan, into a concrete probe type
+    switch (mode) {
+        case ScanMode::Icmp: {
+            const TargetSet remaining = withoutKnownAlive(targets, knownAlive);
+            return mergeHosts(knownAlive, uniqueHosts(ScanPipeline::run(schedule(remaining), {0}, threadCount, deny, budget.get(), IcmpProbe{context})));
+        }
+        case ScanMode::Tcp: {
+            const TargetSet remaining = withoutKnownAlive(targets, knownAlive);
+            return mergeHosts(knownAlive, uniqueHosts(ScanPipeline::run(schedule(remaining), {port}, threadCount, deny, budget.get(), TcpProbe{context})));
+        }
+        case ScanMode::Fallback: {
+            const TargetSet remaining = withoutKnownAlive(targets, knownAlive);
+            return mergeHosts(knownAlive, uniqueHosts(ScanPipeline::run(schedule(remaining), {port}, threadCount, deny, budget.get(), FallbackProbe{context})));
+        }
+        case ScanMode::Syn: {
+            std::vector<uint32_t> hosts;
+            for (const auto& [ip, openPorts] : synScan(targets, {port}, false)) hosts.push_back(ip);
+            return hosts;
+        }
+        case ScanMode::Arp: {
+            std::vector<uint32_t> hosts;
+            for (const auto& [ip, mac] : arpSweep(targets)) hosts.push_back(ip);
+            return hosts;
+        }
     }
+    return {};
+}
+
+void Scanner::run(const std::string &cidr) const {
+    const std::vector<std::string> discoveredIps = toStrings(discover(TargetSet::hostsOf(cidr)));
 
-    while (counter < total && !SignalHandler::isInterrupted()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::cout << "Discovered " << discoveredIps.size() << " live hosts:" << std::endl;
+    for (const auto& ip : discoveredIps) {
+        std::cout << ip << std::endl;
     }
 
-    if (SignalHandler::isInterrupted()) {
-        pool.shutdown();
-        Logger::verbose("Scan interrupted by user");
+    std::cerr << "Scan completed." << std::endl;
+}
+
+std::map<uint32_t, std::vector<int>> Scanner::synScan(const TargetSet& targets, const std::vector<int>& ports,
+                                                      const bool openOnly) const {
+    Syn::Engine engine(timeoutMs);
+    RateLimiter pacer(rate);
+
+    const std::vector<TargetSet> tiers = schedule(targets);
+    uint64_t total = 0;
+    for (const auto& tier : tiers) total += tier.size() * ports.size();
+    uint64_t sent = 0;
+    HostTally tally(budget.get());
+
+    std::vector<Syn::Reply> replies;
+    {
+        Metrics::Reporter progress("SYN", total);
+
+        // A single sender walks the matrix port-major; replies are matched by the
+        // engine's receiver thread, so no per-probe socket or thread is needed.
+        const uint64_t skipped = ScanPipeline::forEachJob(tiers, ports, exclusions.get(), budget.get(),
+            [&](const uint32_t ip, const int p) {
+                tally.update(engine.hostsAnswered(openOnly));
+                if (budget && !budget->acquire()) return;
+                pacer.acquire();
+                if (engine.send(ip, static_cast<uint16_t>(p))) ++sent;
+                Metrics::add(Metrics::Counter::JobsDone);
+            });
+        Metrics::add(Metrics::Counter::JobsDone, skipped);
+
+        replies = engine.finish();
+        tally.update(engine.hostsAnswered(openOnly));
     }
+    Metrics::add(Metrics::Counter::Timeouts, sent - std::min<uint64_t>(sent, replies.size()));
 
-    scanComplete = true;
-    progressThread.join();
+    std::map<uint32_t, std::vector<int>> hosts;
+    for (const auto& reply : replies) {
+        auto& hostPorts = hosts[reply.ip];
+        if (reply.state == Syn::PortState::Open) {
+            hostPorts.push_back(reply.port);
+        }
+    }
+    for (auto& [ip, hostPorts] : hosts) {
+        std::sort(hostPorts.begin(), hostPorts.end());
+    }
 
-    std::cerr << "\r" << std::string(80, ' ') << "\r";
+    Logger::verbose("SYN scan: ", sent, " probes sent, ", replies.size(), " replies");
+    return hosts;
+}
 
-    std::sort(discoveredIps.begin(), discoveredIps.end(), [](const std::string& a, const std::string& b) {
-        return Utils::ipToUint(a) < Utils::ipToUint(b);
-    });
+std::map<uint32_t, std::string> Scanner::arpSweep(const TargetSet& targets) const {
+    // One engine per link: the configured interface, or every interface when scanning them all
+    std::vector<std::unique_ptr<Arp::Engine>> engines;
+    std::vector<std::string> engineNames;
+    if (router) {
+        for (const auto& iface : router->interfaces()) {
+            try {
+                engines.push_back(std::make_unique<Arp::Engine>(iface.name, timeoutMs));
+                engineNames.push_back(iface.name);
+            } catch (const std::runtime_error& e) {
+                Logger::verbose("ARP sweep skips ", iface.name, ": ", e.what());
+            }
+        }
+        if (engines.empty()) {
+            throw std::runtime_error("ARP scan: no interface can send ARP requests");
+        }
+    } else {
+        engines.push_back(std::make_unique<Arp::Engine>(interfaceName, timeoutMs));
+        engineNames.push_back(interfaceName);
+    }
 
-    discoveredIps.erase(
-        std::remove_if(discoveredIps.begin(), discoveredIps.end(),
-            [startIp, endIp](const std::string& ip) {
-                uint32_t ipInt = Utils::ipToUint(ip);
-                return (ipInt == startIp || ipInt == endIp);
-            }),
-        discoveredIps.end()
-    );
+    // All links draw from one budget, so adding interfaces never multiplies the packet rate
+    RateLimiter pacer(rate > 0 ? rate : ARP_DEFAULT_RATE);
+
+    const uint64_t total = targets.size();
+    uint64_t sent = 0;
+    uint64_t offLink = 0;
+    HostTally tally(budget.get());
+    const auto answered = [&engines] {
+        size_t hosts = 0;
+        for (const auto& engine : engines) hosts += engine->hostsAnswered();
+        return hosts;
+    };
+
+    std::vector<Arp::Reply> replies;
+    {
+        Metrics::Reporter progress("ARP", total);
+
+        const uint64_t skipped = ScanPipeline::forEachJob(targets, {0}, exclusions.get(), budget.get(), [&](const uint32_t ip, int) {
+            Metrics::add(Metrics::Counter::JobsDone);
+            // Addresses behind a router never answer ARP on any of our links
+            const auto engine = std::find_if(engines.begin(), engines.end(),
+                                             [ip](const auto& candidate) { return candidate->onLink(ip); });
+            if (engine == engines.end()) {
+                ++offLink;
+                return;
+            }
+            tally.update(answered());
+            if (budget && !budget->acquire()) return;
+            pacer.acquire();
+            if ((*engine)->send(ip)) ++sent;
+        });
+        Metrics::add(Metrics::Counter::JobsDone, skipped);
 
-    Logger::verbose("Scan complete: " + std::to_string(discoveredIps.size()) + " hosts found");
-    return discoveredIps;
-}
+        for (const auto& engine : engines) {
+            std::vector<Arp::Reply> engineReplies = engine->finish();
+            replies.insert(replies.end(), engineReplies.begin(), engineReplies.end());
+        }
+        tally.update(answered());
+    }
+    Metrics::add(Metrics::Counter::Timeouts, sent - std::min<uint64_t>(sent, replies.size()));
 
-bool NetworkScanner::verifyHost(const std::string& ip) const {
-    int successCount = 0;
+    if (offLink > 0) {
+        std::string links;
+        for (const auto& name : engineNames) links += (links.empty() ? "" : ", ") + name;
+        Logger::warn(offLink, " targets are not on the subnet of ", links, " and were skipped by the ARP sweep");
+    }
 
-    if (Icmp::ping(ip, true, timeoutMs)) successCount++;
-    if (Tcp::ping(ip, 80, true, timeoutMs)) successCount++;
-    if (Tcp::ping(ip, 443, true, timeoutMs)) successCount++;
-    if (Tcp::ping(ip, 22, true, timeoutMs)) successCount++;
+    std::map<uint32_t, std::string> hosts;
+    for (const auto& reply : replies) {
+        // Gratuitous or unsolicited replies from outside the target set are ignored
+        if (!targets.contains(reply.ip)) continue;
+        hosts.emplace(reply.ip, Arp::formatMac(reply.mac));
+    }
 
-    return successCount >= 2;
+    Logger::verbose("ARP sweep: ", sent, " requests sent, ", hosts.size(), " replies");
+    return hosts;
 }
 
-std::vector<std::string> NetworkScanner::thoroughScan(const std::string& cidr) const {
-    auto [fst, snd] = Utils::parseCIDR(cidr);
-    uint32_t startIp = fst;
-    uint32_t endIp = snd;
+NetworkScanner::NetworkScanner(const size_t threads, const std::string& mode, int port, int timeoutMs)
+    : Scanner(threads, mode, port, timeoutMs) {
+}
 
-    Logger::verbose("Starting thorough scan of " + cidr);
+std::vector<std::string> NetworkScanner::scan(const std::string &cidr) const {
+    return scan(TargetSet::hostsOf(cidr));
+}
 
-    ThreadPool pool(threadCount);
+std::vector<std::string> NetworkScanner::scan(const TargetSet& targets) const {
+    Logger::verbose("Starting scan of ", targets.size(), " hosts in ", targets.ranges().size(), " ranges");
 
-    std::atomic<uint32_t> counter = 0;
-    const uint32_t total = endIp - startIp + 1;
+    std::vector<std::string> discoveredIps = toStrings(discover(targets));
 
-    std::mutex resultsMutex;
-    std::vector<std::string> discoveredIps;
+    Logger::verbose("Scan complete: ", discoveredIps.size(), " hosts found");
+    return discoveredIps;
+}
 
-    std::atomic<bool> scanComplete = false;
-    std::thread progressThread([&counter, total, &scanComplete]() {
-        while (!scanComplete && !SignalHandler::isInterrupted()) {
-            const uint32_t done = counter.load();
-            constexpr int width = 30;
-            const int filled = static_cast<int>((done * width) / total);
+const std::vector<int> NetworkScanner::VERIFY_PORTS = {80, 443, 22};
 
-            std::cerr << "\r[";
-            for (int i = 0; i < width; ++i)
-                std::cerr << (i < filled ? '#' : '.');
-            std::cerr << "] " << done << "/" << total << std::flush;
+std::vector<std::string> NetworkScanner::thoroughScan(const std::string& cidr) const {
+    return thoroughScan(TargetSet::hostsOf(cidr));
+}
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-    });
+std::vector<std::string> NetworkScanner::thoroughScan(const TargetSet& targets) const {
+    Logger::verbose("Starting thorough scan of ", targets.size(), " hosts");
 
-    for (uint32_t ip = startIp; ip <= endIp; ++ip) {
-        pool.enqueue([ip, &counter, &resultsMutex, &discoveredIps, this] {
-            if (SignalHandler::isInterrupted()) { ++counter; return; }
+    RateLimiter pacer(rate);
+    const ProbeContext context{timeoutMs, neighbors ? &neighbors->failed : nullptr, router.get(), &pacer, probeTransport()};
+    std::vector<uint32_t> knownAlive;
+    const TargetSet remaining = withoutKnownAlive(targets, knownAlive);
 
-            const std::string ipStr = Utils::uintToIp(ip);
+    const auto hits = ScanPipeline::run(schedule(remaining), {0}, threadCount, exclusions.get(), budget.get(),
+        [this, &context](const uint32_t ip, const std::string& ipStr, int) {
+            const auto* via = context.start(ip);
+            return context.transport->verify(ip, ipStr, VERIFY_PORTS, VERIFY_QUORUM, context.timeoutFor(ip), via);
+        });
+    std::vector<std::string> discoveredIps = toStrings(mergeHosts(knownAlive, uniqueHosts(hits)));
 
-            bool isAlive = verifyHost(ipStr);
+    Logger::verbose("Thorough scan complete: ", discoveredIps.size(), " hosts verified");
+    return discoveredIps;
+}
 
-            ++counter;
+std::vector<HostPorts> NetworkScanner::portScan(const std::string& cidr, const std::vector<int>& ports) const {
+    return portScan(TargetSet::hostsOf(cidr), ports);
+}
 
-            if (isAlive) {
-                Logger::debug("Host verified (thorough): " + ipStr);
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                discoveredIps.push_back(ipStr);
-            }
-        });
-    }
+std::vector<HostPorts> NetworkScanner::portScan(const TargetSet& targets, const std::vector<int>& ports) const {
+    Logger::verbose("Starting port scan of ", targets.size(), " hosts x ", ports.size(), " ports");
 
-    while (counter < total && !SignalHandler::isInterrupted()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    std::vector<HostPorts> results;
 
-    if (SignalHandler::isInterrupted()) {
-        pool.shutdown();
-        Logger::verbose("Thorough scan interrupted by user");
+    if (mode == ScanMode::Syn) {
+        for (auto& [ip, hostPorts] : synScan(targets, ports, true)) {
+            if (hostPorts.empty()) continue;
+            results.push_back({Utils::uintToIp(ip), std::move(hostPorts)});
+        }
+    } else {
+        // Hits arrive sorted by address then port, so grouping is a single pass
+        RateLimiter pacer(rate);
+        const ProbeContext context{timeoutMs, neighbors ? &neighbors->failed : nullptr, router.get(), &pacer, probeTransport()};
+        for (const auto& hit : ScanPipeline::run(schedule(targets), ports, threadCount, exclusions.get(), budget.get(), TcpProbe{context})) {
+            const std::string ip = Utils::uintToIp(hit.ip);
+            if (results.empty() || results.back().ip != ip) results.push_back({ip, {}});
+            results.back().openPorts.push_back(hit.port);
+        }
     }
 
-    scanComplete = true;
-    progressThread.join();
-
-    std::cerr << "\r" << std::string(80, ' ') << "\r";
+    Logger::verbose("Port scan complete: ", results.size(), " hosts with open ports");
+    return results;
+}
 
-    std::sort(discoveredIps.begin(), discoveredIps.end(), [](const std::string& a, const std::string& b) {
-        return Utils::ipToUint(a) < Utils::ipToUint(b);
-    });
+std::vector<HostMac> NetworkScanner::arpScan(const TargetSet& targets) const {
+    Logger::verbose("Starting ARP sweep of ", targets.size(), " hosts on ",
+                    (router ? std::to_string(router->interfaces().size()) + " interfaces" : interfaceName));
 
-    discoveredIps.erase(
-        std::remove_if(discoveredIps.begin(), discoveredIps.end(),
-            [startIp, endIp](const std::string& ip) {
-                uint32_t ipInt = Utils::ipToUint(ip);
-                return (ipInt == startIp || ipInt == endIp);
-            }),
-        discoveredIps.end()
-    );
+    std::vector<HostMac> results;
+    for (auto& [ip, mac] : arpSweep(targets)) {
+        results.push_back({Utils::uintToIp(ip), std::move(mac)});
+    }
 
-    Logger::verbose("Thorough scan complete: " + std::to_string(discoveredIps.size()) + " hosts verified");
-    return discoveredIps;
+    Logger::verbose("ARP sweep complete: ", results.size(), " hosts found");
+    return results;
 }
@@ -0,0 +1,235 @@
+#include "../include/syn.hpp"
+#include "../include/icmp.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+#include "../include/metrics.hpp"
+#include "../include/signal_handler.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace Syn {
+    namespace {
+        constexpr uint8_t TCP_FLAG_FIN = 0x01;
+        constexpr uint8_t TCP_FLAG_SYN = 0x02;
+        constexpr uint8_t TCP_FLAG_RST = 0x04;
+        constexpr uint8_t TCP_FLAG_ACK = 0x10;
+        constexpr size_t TCP_HEADER_LEN = 20;
+
+        void put16(uint8_t* p, uint16_t v) {
+            p[0] = static_cast<uint8_t>(v >> 8);
+            p[1] = static_cast<uint8_t>(v);
+        }
+
+        void put32(uint8_t* p, uint32_t v) {
+            p[0] = static_cast<uint8_t>(v >> 24);
+            p[1] = static_cast<uint8_t>(v >> 16);
+            p[2] = static_cast<uint8_t>(v >> 8);
+            p[3] = static_cast<uint8_t>(v);
+        }
+
+        uint16_t get16(const uint8_t* p) {
+            return static_cast<uint16_t>((p[0] << 8) | p[1]);
+        }
+
+        uint32_t get32(const uint8_t* p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+    }
+
+    uint32_t cookie(const uint32_t secret, const uint32_t dstIp, const uint16_t dstPort, const uint16_t srcPort) {
+        // murmur3 finalizer over the probe tuple, keyed by the per-scan secret
+        uint32_t h = secret ^ dstIp;
+        h ^= (static_cast<uint32_t>(dstPort) << 16) | srcPort;
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+        return h;
+    }
+
+    uint16_t tcpChecksum(const uint32_t srcIp, const uint32_t dstIp, const uint8_t* segment, const size_t len) {
+        uint8_t buf[12 + 60]{};
+        if (len > 60) return 0;
+
+        put32(buf, srcIp);
+        put32(buf + 4, dstIp);
+        buf[9] = IPPROTO_TCP;
+        put16(buf + 10, static_cast<uint16_t>(len));
+        std::memcpy(buf + 12, segment, len);
+
+        return Icmp::checksum(buf, static_cast<int>(12 + len));
+    }
+
+    size_t buildSyn(uint8_t* buf, const uint32_t srcIp, const uint32_t dstIp,
+                    const uint16_t srcPort, const uint16_t dstPort, const uint32_t seq) {
+        std::memset(buf, 0, TCP_HEADER_LEN);
+        put16(buf, srcPort);
+        put16(buf + 2, dstPort);
+        put32(buf + 4, seq);
+        buf[12] = (TCP_HEADER_LEN / 4) << 4;
+        buf[13] = TCP_FLAG_SYN;
+        put16(buf + 14, 1024);
+
+        // Checksum is stored exactly as computed (already in network byte order)
+        const uint16_t sum = tcpChecksum(srcIp, dstIp, buf, TCP_HEADER_LEN);
+        std::memcpy(buf + 16, &sum, sizeof(sum));
+        return TCP_HEADER_LEN;
+    }
+
+    bool parseReply(const uint8_t* packet, const size_t len, const uint32_t secret, const uint16_t srcPort, Reply& out) {
+        if (len < 20 || (packet[0] >> 4) != 4 || packet[9] != IPPROTO_TCP) return false;
+
+        const size_t ipHeaderLen = (packet[0] & 0x0f) * 4u;
+        if (ipHeaderLen < 20 || len < ipHeaderLen + TCP_HEADER_LEN) return false;
+
+        const uint8_t* tcp = packet + ipHeaderLen;
+        const uint32_t fromIp = get32(packet + 12);
+        const uint16_t fromPort = get16(tcp);
+        const uint16_t toPort = get16(tcp + 2);
+        const uint32_t ack = get32(tcp + 8);
+        const uint8_t flags = tcp[13];
+
+        if (toPort != srcPort || !(flags & TCP_FLAG_ACK)) return false;
+        if (ack != cookie(secret, fromIp, fromPort, srcPort) + 1) return false;
+
+        if ((flags & (TCP_FLAG_SYN | TCP_FLAG_ACK)) == (TCP_FLAG_SYN | TCP_FLAG_ACK) && !(flags & TCP_FLAG_FIN)) {
+            out = {fromIp, fromPort, PortState::Open};
+            return true;
+        }
+        if (flags & TCP_FLAG_RST) {
+            out = {fromIp, fromPort, PortState::Closed};
+            return true;
+        }
+        return false;
+    }
+
+#ifdef __linux__
+    Engine::Engine(const int timeoutMs) : timeoutMs(timeoutMs) {
+        sockfd = socket(AF_INET, SOCK_RAW, IPPROTO_TCP);
+        if (sockfd < 0) {
+            throw std::runtime_error("SYN scan needs a raw socket (run as root): " + std::string(std::strerror(errno)));
+        }
+
+        std::random_device rd;
+        secret = rd();
+        srcPort = static_cast<uint16_t>(40000 + rd() % 20000);
+
+        Logger::debug("SYN: engine started on source port ", srcPort);
+        receiver = std::thread(&Engine::receiveLoop, this);
+    }
+#else
+    Engine::Engine(const int timeoutMs) : timeoutMs(timeoutMs), secret(0), srcPort(0) {
+        throw std::runtime_error("SYN scan is only supported on Linux");
+    }
+#endif
+
+    Engine::~Engine() {
+        stop.store(true);
+        if (receiver.joinable()) receiver.join();
+        if (sockfd >= 0) close(sockfd);
+    }
+
+    uint32_t Engine::sourceFor(const uint32_t dstIp) {
+        // The route (and thus source address) is the same for a whole /24 in practice
+        if (cachedSrc != 0 && cachedNet == (dstIp & 0xffffff00U)) return cachedSrc;
+
+        uint32_t src = 0;
+        if (const int udp = socket(AF_INET, SOCK_DGRAM, 0); udp >= 0) {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(9);
+            addr.sin_addr.s_addr = htonl(dstIp);
+            if (connect(udp, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+                sockaddr_in local{};
+                socklen_t localLen = sizeof(local);
+                if (getsockname(udp, reinterpret_cast<sockaddr*>(&local), &localLen) == 0) {
+                    src = ntohl(local.sin_addr.s_addr);
+                }
+            }
+            close(udp);
+        }
+
+        cachedNet = dstIp & 0xffffff00U;
+        cachedSrc = src;
+        return src;
+    }
+
+    bool Engine::send(const uint32_t ip, const uint16_t port) {
+        const uint32_t src = sourceFor(ip);
+        Metrics::add(Metrics::Counter::ProbesSent);
+        if (src == 0) {
+            Logger::debug("SYN: no route to ", Utils::uintToIp(ip));
+            Metrics::add(Metrics::Counter::Errors);
+            return false;
+        }
+
+        uint8_t segment[TCP_HEADER_LEN];
+        const size_t len = buildSyn(segment, src, ip, srcPort, port, cookie(secret, ip, port, srcPort));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(ip);
+
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            if (sendto(sockfd, segment, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) >= 0) return true;
+            if (errno != ENOBUFS && errno != EAGAIN) break;
+            // Transmit queue is full: back off briefly instead of dropping the probe
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        Logger::debug("SYN: sendto failed for ", Utils::uintToIp(ip), ":", port, " (", std::strerror(errno), ")");
+        Metrics::add(Metrics::Counter::Errors);
+        return false;
+    }
+
+    void Engine::receiveLoop() {
+        uint8_t buf[1500];
+        pollfd pfd{sockfd, POLLIN, 0};
+
+        while (!stop.load()) {
+            if (poll(&pfd, 1, 50) <= 0) continue;
+
+            const ssize_t n = recv(sockfd, buf, sizeof(buf), 0);
+            if (n <= 0) continue;
+
+            Reply reply{};
+            if (!parseReply(buf, static_cast<size_t>(n), secret, srcPort, reply)) continue;
+
+            std::lock_guard<std::mutex> lock(repliesMutex);
+            if (seen.emplace(reply.ip, reply.port).second) {
+                if (Logger::enabled(Logger::Level::DEBUG)) {
+                    Logger::debug("SYN: ", Utils::uintToIp(reply.ip), ":", reply.port,
+                                  reply.state == PortState::Open ? " open" : " closed");
+                }
+                replies.push_back(reply);
+                Metrics::add(Metrics::Counter::Replies);
+                if (answered.insert(reply.ip).second) ++answeredHosts;
+                if (reply.state == PortState::Open && open.insert(reply.ip).second) ++openHosts;
+            }
+        }
+    }
+
+    std::vector<Reply> Engine::finish() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (std::chrono::steady_clock::now() < deadline && !SignalHandler::isInterrupted()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        stop.store(true);
+        if (receiver.joinable()) receiver.join();
+
+        std::lock_guard<std::mutex> lock(repliesMutex);
+        return replies;
+    }
+}
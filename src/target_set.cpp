@@ -0,0 +1,275 @@
+#include "../include/target_set.hpp"
+#include "../include/utils.hpp"
+#include "../include/logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    bool isSeparator(const char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ';';
+    }
+
+    // Parse a decimal number of at most maxDigits digits, advancing p
+    bool parseNumber(const char*& p, const char* end, uint32_t& out, const int maxDigits) {
+        const char* start = p;
+        uint32_t value = 0;
+        while (p < end && *p >= '0' && *p <= '9' && p - start < maxDigits) {
+            value = value * 10 + static_cast<uint32_t>(*p - '0');
+            ++p;
+        }
+        out = value;
+        return p > start && (p == end || *p < '0' || *p > '9');
+    }
+
+    bool parseOctet(const char*& p, const char* end, uint32_t& out) {
+        return parseNumber(p, end, out, 3) && out <= 255;
+    }
+
+    bool parseIpv4(const char*& p, const char* end, uint32_t& out) {
+        uint32_t ip = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint32_t octet;
+            if (!parseOctet(p, end, octet)) return false;
+            ip = (ip << 8) | octet;
+            if (i < 3) {
+                if (p == end || *p != '.') return false;
+                ++p;
+            }
+        }
+        out = ip;
+        return true;
+    }
+
+    // Parse one entry occupying exactly [p, end)
+    bool parseEntry(const char* p, const char* end, uint32_t& first, uint32_t& last) {
+        if (!parseIpv4(p, end, first)) return false;
+
+        if (p == end) {
+            last = first;
+            return true;
+        }
+
+        if (*p == '/') {
+            ++p;
+            uint32_t prefix;
+            if (!parseNumber(p, end, prefix, 2) || prefix > 32 || p != end) return false;
+            const uint32_t mask = prefix == 0 ? 0 : (~0U << (32 - prefix));
+            first &= mask;
+            last = first | ~mask;
+            return true;
+        }
+
+        if (*p == '-') {
+            ++p;
+            const char* rest = p;
+            if (parseIpv4(p, end, last) && p == end) {
+                return first <= last;
+            }
+            p = rest;
+            uint32_t octet;
+            if (!parseOctet(p, end, octet) || p != end) return false;
+            last = (first & 0xffffff00U) | octet;
+            return first <= last;
+        }
+
+        return false;
+    }
+}
+
+TargetSet TargetSet::hostsOf(const std::string& cidr) {
+    auto [start, end] = Utils::parseCIDR(cidr);
+    TargetSet set;
+    if (end - start >= 2) {
+        ++start;
+        --end;
+    }
+    set.add(start, end);
+    return set;
+}
+
+void TargetSet::add(uint32_t first, uint32_t last) {
+    if (first > last) std::swap(first, last);
+
+    // First range that overlaps, touches or follows the new one
+    auto it = std::lower_bound(rangeList.begin(), rangeList.end(), first, [](const Range& r, const uint32_t value) {
+        return static_cast<uint64_t>(r.second) + 1 < value;
+    });
+    if (it == rangeList.end() || static_cast<uint64_t>(last) + 1 < it->first) {
+        rangeList.emplace(it, first, last);
+        return;
+    }
+
+    // Absorb every following range the new one reaches
+    auto next = it + 1;
+    uint32_t reach = std::max(it->second, last);
+    while (next != rangeList.end() && static_cast<uint64_t>(reach) + 1 >= next->first) {
+        reach = std::max(reach, next->second);
+        ++next;
+    }
+    it->first = std::min(it->first, first);
+    it->second = reach;
+    rangeList.erase(it + 1, next);
+}
+
+void TargetSet::add(const TargetSet& other) {
+    if (&other == this) return;
+    rangeList.insert(rangeList.end(), other.rangeList.begin(), other.rangeList.end());
+    normalize();
+}
+
+void TargetSet::subtract(const TargetSet& other) {
+    const auto& cut = other.rangeList;
+    if (cut.empty() || rangeList.empty()) return;
+
+    std::vector<Range> result;
+    result.reserve(rangeList.size());
+
+    // Both lists are sorted and disjoint, so one merge-style pass suffices
+    size_t j = 0;
+    for (auto [first, last] : rangeList) {
+        while (j < cut.size() && cut[j].second < first) ++j;
+
+        uint64_t cursor = first;
+        size_t k = j;
+        while (k < cut.size() && cut[k].first <= last && cursor <= last) {
+            if (cut[k].first > cursor) {
+                result.emplace_back(static_cast<uint32_t>(cursor), cut[k].first - 1);
+            }
+            cursor = std::max<uint64_t>(cursor, static_cast<uint64_t>(cut[k].second) + 1);
+            ++k;
+        }
+        if (cursor <= last) {
+            result.emplace_back(static_cast<uint32_t>(cursor), last);
+        }
+    }
+
+    rangeList = std::move(result);
+}
+
+void TargetSet::intersect(const TargetSet& other) {
+    TargetSet outside = *this;
+    outside.subtract(other);
+    subtract(outside);
+}
+
+size_t TargetSet::parse(const char* data, const size_t len) {
+    const char* p = data;
+    const char* const end = data + len;
+    size_t invalid = 0;
+
+    while (p < end) {
+        if (isSeparator(*p)) {
+            ++p;
+            continue;
+        }
+        if (*p == '#') {
+            const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            p = nl ? static_cast<const char*>(nl) : end;
+            continue;
+        }
+
+        const char* tokenEnd = p;
+        while (tokenEnd < end && !isSeparator(*tokenEnd) && *tokenEnd != '#') ++tokenEnd;
+
+        uint32_t first;
+        uint32_t last;
+        if (parseEntry(p, tokenEnd, first, last)) {
+            rangeList.emplace_back(first, last);
+        } else {
+            ++invalid;
+            if (invalid <= 10) {
+                Logger::warn("Ignoring invalid target entry: ", std::string(p, tokenEnd));
+            }
+        }
+        p = tokenEnd;
+    }
+
+    normalize();
+    return invalid;
+}
+
+size_t TargetSet::load(const std::string& path) {
+    if (path == "-") {
+        std::string buffer;
+        char chunk[65536];
+        ssize_t n;
+        while ((n = read(STDIN_FILENO, chunk, sizeof(chunk))) > 0) {
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        return parse(buffer.data(), buffer.size());
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+    }
+
+    madvise(mapped, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    const size_t invalid = parse(static_cast<const char*>(mapped), static_cast<size_t>(st.st_size));
+    munmap(mapped, static_cast<size_t>(st.st_size));
+
+    Logger::verbose("Loaded ", rangeList.size(), " target ranges (", size(), " addresses) from ", path);
+    return invalid;
+}
+
+void TargetSet::normalize() {
+    std::sort(rangeList.begin(), rangeList.end());
+
+    size_t out = 0;
+    for (size_t i = 0; i < rangeList.size(); ++i) {
+        if (out > 0 && static_cast<uint64_t>(rangeList[i].first) <= static_cast<uint64_t>(rangeList[out - 1].second) + 1) {
+            rangeList[out - 1].second = std::max(rangeList[out - 1].second, rangeList[i].second);
+        } else {
+            rangeList[out++] = rangeList[i];
+        }
+    }
+    rangeList.resize(out);
+}
+
+const std::vector<TargetSet::Range>& TargetSet::ranges() const {
+    return rangeList;
+}
+
+uint64_t TargetSet::size() const {
+    uint64_t total = 0;
+    for (const auto& [first, last] : rangeList) {
+        total += static_cast<uint64_t>(last - first) + 1;
+    }
+    return total;
+}
+
+bool TargetSet::empty() const {
+    return rangeList.empty();
+}
+
+bool TargetSet::contains(const uint32_t ip) const {
+    auto it = std::upper_bound(rangeList.begin(), rangeList.end(), ip,
+                               [](const uint32_t value, const Range& r) { return value < r.first; });
+    if (it == rangeList.begin()) return false;
+    --it;
+    return ip <= it->second;
+}
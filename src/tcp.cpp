@@ -1,10 +1,17 @@
 #include "../include/tcp.hpp"
 #include "../include/logger.hpp"
+#include "../include/fd_budget.hpp"
+#include "../include/interfaces.hpp"
+#include "../include/metrics.hpp"
+#include "../include/trace.hpp"
+#include "../include/usdt.hpp"
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 #include <fcntl.h>
 #include <unistd.h>
-#include <sys/select.h>
+#include <poll.h>
+#include <cerrno>
 #include <chrono>
 #include <iostream>
 #include <mutex>
@@ -12,40 +19,79 @@
 namespace Tcp {
     static std::mutex outputMutex;
 
-    bool ping(const std::string& ip, int port, bool quiet, int timeoutMs) {
+    // Abortive close: SO_LINGER 0 makes close() send RST instead of FIN, so
+    // large sweeps don't leave a TIME_WAIT entry (and ephemeral port) per probe.
+    void closeAbortive(const int sockfd) {
+        linger lin{1, 0};
+        setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+        close(sockfd);
+    }
+
+    int startConnect(const std::string& ip, const int port, const Interfaces::Interface* via) {
         const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
         if (sockfd < 0) {
-            Logger::debug("TCP: cannot create socket for " + ip + ":" + std::to_string(port));
-            return false;
+            Logger::debug("TCP: cannot create socket for ", ip, ":", port);
+            return -1;
         }
 
         fcntl(sockfd, F_SETFL, O_NONBLOCK);
+        Interfaces::bindSocket(sockfd, via);
 
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
         addr.sin_port = htons(port);
         inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
 
-        const auto start = std::chrono::steady_clock::now();
-
         if (const int connResult = connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
             connResult < 0 && errno != EINPROGRESS) {
             close(sockfd);
+            return -1;
+        }
+        return sockfd;
+    }
+
+    int connectError(const int sockfd) {
+        int so_error = -1;
+        socklen_t len = sizeof(so_error);
+        getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+        return so_error;
+    }
+
+    bool connected(const int sockfd) {
+        return connectError(sockfd) == 0;
+    }
+
+    bool ping(const std::string& ip, int port, bool quiet, int timeoutMs, const Interfaces::Interface* via) {
+        FdBudget::Slot slot;
+        Trace::Span span("tcp", Trace::Category::Probe, ip);
+        const auto start = std::chrono::steady_clock::now();
+
+        const int sockfd = startConnect(ip, port, via);
+        if (sockfd < 0) {
+            Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Error);
             return false;
         }
+        SCANNER_PROBE(probe_send, 1, ip.c_str(), port);
 
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(sockfd, &fds);
-        timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        pollfd pfd{sockfd, POLLOUT, 0};
 
         bool success = false;
 
-        if (select(sockfd + 1, nullptr, &fds, nullptr, &timeout) > 0) {
-            int so_error = -1;
-            socklen_t len = sizeof(so_error);
-            getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &so_error, &len);
-            if (so_error == 0) {
+        if (poll(&pfd, 1, timeoutMs) <= 0) {
+            SCANNER_PROBE(probe_timeout, 1, ip.c_str(), port);
+            Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Timeout);
+        } else {
+            // A refusal (RST) is still an answer from the target; unreachable errors are not
+            const int error = connectError(sockfd);
+            if (error == 0 || error == ECONNREFUSED) {
+                const auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                SCANNER_PROBE(probe_reply, 1, ip.c_str(), port, static_cast<long long>(rtt.count()));
+                Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Reply, rtt);
+            } else {
+                Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Error);
+            }
+
+            if (error == 0) {
                 auto end = std::chrono::steady_clock::now();
                 auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
@@ -61,12 +107,12 @@ namespace Tcp {
                               << " (RTT: " << ms << " ms)\033[0m" << std::endl;
                 }
 
-                Logger::debug("TCP: " + ip + ":" + std::to_string(port) + " alive (RTT: " + std::to_string(ms) + "ms)");
+                Logger::debug("TCP: ", ip, ":", port, " alive (RTT: ", ms, "ms)");
                 success = true;
             }
         }
 
-        close(sockfd);
+        closeAbortive(sockfd);
         return success;
     }
 }
@@ -1,6 +1,6 @@
 #include "../include/thread_pool.hpp"
 
-ThreadPool::ThreadPool(const size_t threads) {
+ThreadPool::ThreadPool(const size_t threads, const size_t queueLimit) : maxQueued(queueLimit) {
     for (size_t i = 0; i < threads; ++i) {
         workers.emplace_back([this] {
             for (;;) {
@@ -14,6 +14,7 @@ ThreadPool::ThreadPool(const size_t threads) {
                     task = std::move(tasks.front());
                     tasks.pop();
                 }
+                if (maxQueued) space.notify_one();
                 task();
             }
         });
@@ -23,6 +24,9 @@ ThreadPool::ThreadPool(const size_t threads) {
 void ThreadPool::enqueue(std::function<void()> task) {
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
+        if (maxQueued) {
+            space.wait(lock, [this] { return stop.load() || tasks.size() < maxQueued; });
+        }
         if (stop.load()) return;
         tasks.push(std::move(task));
     }
@@ -30,8 +34,12 @@ void ThreadPool::enqueue(std::function<void()> task) {
 }
 
 void ThreadPool::shutdown() {
-    stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stop.store(true);
+    }
     condition.notify_all();
+    space.notify_all();
 }
 
 ThreadPool::~ThreadPool() {
@@ -0,0 +1,166 @@
+#include "../include/trace.hpp"
+#include "../include/logger.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Trace {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // Timestamps count from process start, so every thread shares one origin
+        const Clock::time_point epoch = Clock::now();
+
+        int64_t now() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - epoch).count();
+        }
+
+        struct Event {
+            const char* name;
+            Category category;
+            std::string detail;
+            int64_t startMicros;
+            int64_t durationMicros;
+        };
+
+        // One thread's events; the lock is only ever contended by Session::write()
+        struct Buffer {
+            std::mutex mutex;
+            std::vector<Event> events;
+            size_t next = 0;          // slot the next event overwrites once the ring is full
+            uint64_t dropped = 0;
+            uint32_t tid = 0;
+
+            void push(Event event) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (events.size() < RING_CAPACITY) {
+                    events.push_back(std::move(event));
+                    return;
+                }
+                events[next] = std::move(event);
+                next = (next + 1) % RING_CAPACITY;
+                ++dropped;
+            }
+        };
+
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<Buffer>> buffers;   // kept after their threads exit
+
+        Buffer& localBuffer() {
+            thread_local Buffer* buffer = [] {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                buffers.push_back(std::make_unique<Buffer>());
+                buffers.back()->tid = static_cast<uint32_t>(buffers.size());
+                return buffers.back().get();
+            }();
+            return *buffer;
+        }
+
+        thread_local uint32_t probeCounter = 0;
+
+        const char* categoryName(const Category category) {
+            switch (category) {
+                case Category::Phase: return "phase";
+                case Category::Host: return "host";
+                case Category::Probe: return "probe";
+            }
+            return "";
+        }
+
+        std::string escape(const std::string& s) {
+            std::string out;
+            for (const char c : s) {
+                if (c == '"' || c == '\\') out += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20) out += c;
+            }
+            return out;
+        }
+    }
+
+    void Span::begin(const char* spanName, const Category spanCategory, const std::string& spanDetail) {
+        if (spanCategory == Category::Probe && probeCounter++ % PROBE_SAMPLE != 0) return;
+        name = spanName;
+        category = spanCategory;
+        detail = spanDetail;
+        startMicros = now();
+    }
+
+    void Span::end() {
+        localBuffer().push({name, category, std::move(detail), startMicros, now() - startMicros});
+    }
+
+    Session::Session(const std::string& path) : path(path), out(path, std::ios::trunc) {
+        if (!out) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        mainTid = localBuffer().tid;
+
+        // Start from an empty trace even if an earlier session recorded into these buffers
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (const auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->events.clear();
+            buffer->next = 0;
+            buffer->dropped = 0;
+        }
+        detail::recording.store(true, std::memory_order_relaxed);
+    }
+
+    Session::~Session() {
+        detail::recording.store(false, std::memory_order_relaxed);
+        if (!written) write();
+    }
+
+    size_t Session::write() {
+        struct Record {
+            Event event;
+            uint32_t tid;
+        };
+        std::vector<Record> records;
+        uint64_t dropped = 0;
+        uint32_t threads = 0;
+        {
+            std::lock_guard<std::mutex> registryLock(registryMutex);
+            threads = static_cast<uint32_t>(buffers.size());
+            for (const auto& buffer : buffers) {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                for (const auto& event : buffer->events) records.push_back({event, buffer->tid});
+                dropped += buffer->dropped;
+            }
+        }
+        std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.event.startMicros < b.event.startMicros;
+        });
+
+        const int pid = static_cast<int>(getpid());
+        out << "{\"traceEvents\": [\n";
+        out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << mainTid << ", \"args\": {\"name\": \"network-scanner\"}}";
+        for (uint32_t tid = 1; tid <= threads; ++tid) {
+            out << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << tid
+                << ", \"args\": {\"name\": \"" << (tid == mainTid ? "main" : "thread " + std::to_string(tid)) << "\"}}";
+        }
+        for (const auto& [event, tid] : records) {
+            out << ",\n  {\"name\": \"" << event.name << "\", \"cat\": \"" << categoryName(event.category)
+                << "\", \"ph\": \"X\", \"ts\": " << event.startMicros << ", \"dur\": " << event.durationMicros
+                << ", \"pid\": " << pid << ", \"tid\": " << tid;
+            if (!event.detail.empty()) out << ", \"args\": {\"target\": \"" << escape(event.detail) << "\"}";
+            out << "}";
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": " << dropped << "}}\n";
+        out.flush();
+        written = true;
+
+        if (!out) {
+            Logger::error("Trace: cannot write ", path);
+        } else {
+            Logger::verbose("Trace: ", records.size(), " events written to ", path);
+            if (dropped) Logger::verbose("Trace: ", dropped, " older events were overwritten");
+        }
+        return records.size();
+    }
+}
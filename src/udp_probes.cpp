@@ -0,0 +1,296 @@
+#include "../include/udp_probes.hpp"
+#include "../include/logger.hpp"
+#include "../include/signal_handler.hpp"
+#include "../include/rate_limiter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+namespace UdpProbes {
+    namespace {
+        constexpr uint16_t NETBIOS_TYPE_NBSTAT = 0x21;
+        constexpr uint8_t BER_INTEGER = 0x02;
+        constexpr uint8_t BER_OCTET_STRING = 0x04;
+        constexpr uint8_t BER_NULL = 0x05;
+        constexpr uint8_t BER_OID = 0x06;
+        constexpr uint8_t BER_SEQUENCE = 0x30;
+        constexpr uint8_t SNMP_GET_REQUEST = 0xa0;
+        constexpr uint8_t SNMP_GET_RESPONSE = 0xa2;
+
+        // 1.3.6.1.2.1.1.1.0 (sysDescr.0), BER-encoded
+        const std::vector<uint8_t> SYS_DESCR_OID = {0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00};
+
+        // Requests go out at this pace so a /16 of results doesn't burst thousands of datagrams
+        constexpr double SEND_RATE = 2000;
+
+        std::vector<uint8_t> tlv(const uint8_t tag, const std::vector<uint8_t>& value) {
+            std::vector<uint8_t> out{tag};
+            if (value.size() < 0x80) {
+                out.push_back(static_cast<uint8_t>(value.size()));
+            } else {
+                out.push_back(0x82);
+                out.push_back(static_cast<uint8_t>(value.size() >> 8));
+                out.push_back(static_cast<uint8_t>(value.size()));
+            }
+            out.insert(out.end(), value.begin(), value.end());
+            return out;
+        }
+
+        std::vector<uint8_t> berInteger(const uint32_t v) {
+            std::vector<uint8_t> bytes;
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                const auto b = static_cast<uint8_t>(v >> shift);
+                if (bytes.empty() && b == 0 && shift > 0) continue;
+                // Keep the value positive: a leading byte with the top bit set needs a 0 prefix
+                if (bytes.empty() && (b & 0x80)) bytes.push_back(0);
+                bytes.push_back(b);
+            }
+            return tlv(BER_INTEGER, bytes);
+        }
+
+        std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts) {
+            std::vector<uint8_t> out;
+            for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+            return out;
+        }
+
+        // Read one TLV header at pos; value spans [pos, pos + length) afterwards
+        bool readTlv(const uint8_t* msg, const size_t len, size_t& pos, uint8_t& tag, size_t& length) {
+            if (pos + 2 > len) return false;
+            tag = msg[pos++];
+            length = msg[pos++];
+            if (length & 0x80) {
+                const size_t octets = length & 0x7f;
+                if (octets == 0 || octets > 2 || pos + octets > len) return false;
+                length = 0;
+                for (size_t i = 0; i < octets; ++i) length = (length << 8) | msg[pos++];
+            }
+            return pos + length <= len;
+        }
+
+        // Enter a constructed TLV of the expected tag
+        bool enter(const uint8_t* msg, const size_t len, size_t& pos, const uint8_t expected) {
+            uint8_t tag;
+            size_t length;
+            return readTlv(msg, len, pos, tag, length) && tag == expected;
+        }
+
+        // Skip a primitive TLV of the expected tag
+        bool skip(const uint8_t* msg, const size_t len, size_t& pos, const uint8_t expected) {
+            uint8_t tag;
+            size_t length;
+            if (!readTlv(msg, len, pos, tag, length) || tag != expected) return false;
+            pos += length;
+            return true;
+        }
+
+        std::string trim(const std::string& s) {
+            const size_t first = s.find_first_not_of(" \t\r\n");
+            if (first == std::string::npos) return "";
+            return s.substr(first, s.find_last_not_of(" \t\r\n") - first + 1);
+        }
+
+        std::string lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](const unsigned char c) { return std::tolower(c); });
+            return s;
+        }
+    }
+
+    std::vector<uint8_t> buildNetbiosStatusRequest(const uint16_t transactionId) {
+        std::vector<uint8_t> out = {
+            static_cast<uint8_t>(transactionId >> 8), static_cast<uint8_t>(transactionId),
+            0x00, 0x00,  // flags: query
+            0x00, 0x01,  // one question
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x20         // encoded name length
+        };
+        // First-level encoding of "*" padded with NULs: each nibble + 'A'
+        out.push_back('C');
+        out.push_back('K');
+        for (int i = 0; i < 15; ++i) {
+            out.push_back('A');
+            out.push_back('A');
+        }
+        out.push_back(0);
+        out.insert(out.end(), {0x00, NETBIOS_TYPE_NBSTAT, 0x00, 0x01});
+        return out;
+    }
+
+    bool parseNetbiosStatusResponse(const uint8_t* msg, const size_t len, std::string& name) {
+        // The answer's name starts right after the 12-byte header
+        if (len <= 12 || !(msg[2] & 0x80) || ((msg[6] << 8) | msg[7]) == 0) return false;
+
+        size_t pos = 12;
+        if ((msg[pos] & 0xc0) == 0xc0) {
+            pos += 2;
+        } else {
+            while (pos < len && msg[pos] != 0) pos += 1 + msg[pos];
+            ++pos;
+        }
+        // type, class, ttl, rdlength
+        if (pos + 10 > len || msg[pos + 1] != NETBIOS_TYPE_NBSTAT) return false;
+        pos += 10;
+
+        if (pos >= len) return false;
+        const size_t count = msg[pos++];
+        for (size_t i = 0; i < count && pos + 18 <= len; ++i, pos += 18) {
+            const uint8_t suffix = msg[pos + 15];
+            const bool group = msg[pos + 16] & 0x80;
+            // <00> unique is the workstation (computer) name
+            if (suffix == 0x00 && !group) {
+                name = trim(std::string(reinterpret_cast<const char*>(msg + pos), 15));
+                return !name.empty();
+            }
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> buildSnmpGet(const std::string& community, const uint32_t requestId) {
+        const std::vector<uint8_t> varbind = tlv(BER_SEQUENCE, concat({tlv(BER_OID, SYS_DESCR_OID), tlv(BER_NULL, {})}));
+        const std::vector<uint8_t> pdu = tlv(SNMP_GET_REQUEST, concat({
+            berInteger(requestId), berInteger(0), berInteger(0), tlv(BER_SEQUENCE, varbind)}));
+        return tlv(BER_SEQUENCE, concat({
+            berInteger(1),  // SNMPv2c
+            tlv(BER_OCTET_STRING, std::vector<uint8_t>(community.begin(), community.end())),
+            pdu}));
+    }
+
+    bool parseSnmpResponse(const uint8_t* msg, const size_t len, std::string& sysDescr) {
+        size_t pos = 0;
+        if (!enter(msg, len, pos, BER_SEQUENCE) ||
+            !skip(msg, len, pos, BER_INTEGER) ||
+            !skip(msg, len, pos, BER_OCTET_STRING) ||
+            !enter(msg, len, pos, SNMP_GET_RESPONSE) ||
+            !skip(msg, len, pos, BER_INTEGER) ||    // request id
+            !skip(msg, len, pos, BER_INTEGER) ||    // error status
+            !skip(msg, len, pos, BER_INTEGER) ||    // error index
+            !enter(msg, len, pos, BER_SEQUENCE) ||  // varbind list
+            !enter(msg, len, pos, BER_SEQUENCE) ||  // first varbind
+            !skip(msg, len, pos, BER_OID)) {
+            return false;
+        }
+
+        uint8_t tag;
+        size_t length;
+        if (!readTlv(msg, len, pos, tag, length) || tag != BER_OCTET_STRING) return false;
+        sysDescr = trim(std::string(reinterpret_cast<const char*>(msg + pos), length));
+        return !sysDescr.empty();
+    }
+
+    std::vector<uint8_t> buildNtpRequest() {
+        std::vector<uint8_t> out(48, 0);
+        out[0] = 0x23;  // LI 0, version 4, mode 3 (client)
+        return out;
+    }
+
+    bool parseNtpResponse(const uint8_t* msg, const size_t len, int& stratum) {
+        if (len < 48 || (msg[0] & 0x07) != 4) return false;
+        stratum = msg[1];
+        return true;
+    }
+
+    std::string describe(const Result& result) {
+        std::string type;
+        if (!result.sysDescr.empty()) {
+            const std::string descr = lower(result.sysDescr);
+            if (descr.find("windows") != std::string::npos) type = "Windows Host";
+            else if (descr.find("jetdirect") != std::string::npos || descr.find("printer") != std::string::npos ||
+                     descr.find("laserjet") != std::string::npos) type = "Printer";
+            else if (descr.find("cisco") != std::string::npos || descr.find("routeros") != std::string::npos ||
+                     descr.find("junos") != std::string::npos || descr.find("switch") != std::string::npos) type = "Network Device";
+            else if (descr.find("linux") != std::string::npos) type = "Linux Host";
+            else type = "SNMP Device";
+        } else if (!result.netbiosName.empty()) {
+            type = "Windows/SMB Host";
+        } else if (result.ntpStratum >= 0) {
+            type = "NTP Server";
+        }
+
+        if (type.empty()) return "";
+        return result.netbiosName.empty() ? type : type + " (" + result.netbiosName + ")";
+    }
+
+    std::map<std::string, Result> probe(const std::vector<std::string>& hosts, const Options& options) {
+        std::map<std::string, Result> results;
+        if (hosts.empty()) return results;
+
+        int socks[3];
+        for (int& sockfd : socks) sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (socks[0] < 0 || socks[1] < 0 || socks[2] < 0) {
+            Logger::debug("UDP probes: cannot open sockets");
+            for (const int sockfd : socks) if (sockfd >= 0) close(sockfd);
+            return results;
+        }
+        const int netbiosSock = socks[0];
+        const int snmpSock = socks[1];
+        const int ntpSock = socks[2];
+
+        const std::vector<uint8_t> netbiosRequest = buildNetbiosStatusRequest(0x4e42);
+        const std::vector<uint8_t> snmpRequest = buildSnmpGet(options.community, 0x5344);
+        const std::vector<uint8_t> ntpRequest = buildNtpRequest();
+
+        RateLimiter pacer(SEND_RATE);
+        const auto sendTo = [](const int sockfd, const std::vector<uint8_t>& data, const in_addr& ip, const uint16_t port) {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr = ip;
+            sendto(sockfd, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        };
+
+        for (const auto& host : hosts) {
+            if (SignalHandler::isInterrupted()) break;
+            in_addr ip{};
+            if (inet_pton(AF_INET, host.c_str(), &ip) != 1) continue;
+            pacer.acquire();
+            sendTo(netbiosSock, netbiosRequest, ip, options.netbiosPort);
+            sendTo(snmpSock, snmpRequest, ip, options.snmpPort);
+            sendTo(ntpSock, ntpRequest, ip, options.ntpPort);
+        }
+
+        pollfd fds[3] = {{netbiosSock, POLLIN, 0}, {snmpSock, POLLIN, 0}, {ntpSock, POLLIN, 0}};
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeoutMs);
+        uint8_t buf[2048];
+
+        while (!SignalHandler::isInterrupted()) {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0 || poll(fds, 3, static_cast<int>(remaining)) <= 0) break;
+
+            for (const auto& pfd : fds) {
+                if (!(pfd.revents & POLLIN)) continue;
+
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                const ssize_t n = recvfrom(pfd.fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+                if (n <= 0) continue;
+
+                char ipBuf[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &from.sin_addr, ipBuf, sizeof(ipBuf));
+                const auto len = static_cast<size_t>(n);
+
+                std::string text;
+                int stratum;
+                if (pfd.fd == netbiosSock && parseNetbiosStatusResponse(buf, len, text)) {
+                    results[ipBuf].netbiosName = text;
+                } else if (pfd.fd == snmpSock && parseSnmpResponse(buf, len, text)) {
+                    results[ipBuf].sysDescr = text;
+                } else if (pfd.fd == ntpSock && parseNtpResponse(buf, len, stratum)) {
+                    results[ipBuf].ntpStratum = stratum;
+                }
+            }
+        }
+
+        for (const int sockfd : socks) close(sockfd);
+
+        Logger::verbose("UDP probes: ", results.size(), " of ", hosts.size(), " hosts answered NetBIOS/SNMP/NTP");
+        return results;
+    }
+}
@@ -1,8 +1,17 @@
 #include <string>
 #include <utility>
 #include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "../include/utils.hpp"
 
@@ -36,4 +45,77 @@ namespace Utils {
         struct in_addr addr{};
         return inet_pton(AF_INET, ip.c_str(), &addr) == 1;
     }
+
+    // Parse a port specification such as "22,80,443,8000-8100" into a sorted,
+    // de-duplicated list. Throws std::invalid_argument on malformed input.
+    std::vector<int> parsePortList(const std::string& spec) {
+        std::vector<int> ports;
+        std::istringstream iss(spec);
+        std::string token;
+
+        while (std::getline(iss, token, ',')) {
+            if (token.empty()) continue;
+
+            const auto dash = token.find('-');
+            size_t consumed = 0;
+            int first = std::stoi(token.substr(0, dash), &consumed);
+            if (consumed != (dash == std::string::npos ? token.size() : dash)) {
+                throw std::invalid_argument("invalid port: " + token);
+            }
+            int last = first;
+            if (dash != std::string::npos) {
+                const std::string upper = token.substr(dash + 1);
+                last = std::stoi(upper, &consumed);
+                if (consumed != upper.size()) {
+                    throw std::invalid_argument("invalid port range: " + token);
+                }
+            }
+
+            if (first < 1 || last > 65535 || first > last) {
+                throw std::invalid_argument("port out of range: " + token);
+            }
+            for (int port = first; port <= last; ++port) {
+                ports.push_back(port);
+            }
+        }
+
+        if (ports.empty()) {
+            throw std::invalid_argument("empty port list");
+        }
+
+        std::sort(ports.begin(), ports.end());
+        ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
+        return ports;
+    }
+
+    std::string cachePath(const std::string& name) {
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+            return std::string(xdg) + "/network-scanner/" + name;
+        }
+        if (const char* home = std::getenv("HOME"); home && *home) {
+            return std::string(home) + "/.cache/network-scanner/" + name;
+        }
+        return "";
+    }
+
+    bool writeFileAtomically(const std::string& path, const std::string& contents) {
+        if (path.empty()) return false;
+
+        // Create missing parent directories; existing ones just fail with EEXIST
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            mkdir(path.substr(0, slash).c_str(), 0700);
+        }
+
+        // Concurrent runs never read a partial file
+        const std::string tmpPath = path + "." + std::to_string(getpid());
+        {
+            std::ofstream out(tmpPath, std::ios::trunc);
+            if (!(out << contents)) return false;
+        }
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
 }
@@ -0,0 +1,49 @@
+#!/bin/bash
+# --all-interfaces scans the subnets of every interface in one pass: a second
+# veth pair puts 10.201.0.0/24 next to the default 10.200.0.0/24.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/all_interfaces.sh
+
+source "$(dirname "$0")/common.sh"
+
+SECOND_NS=ns-target2
+SECOND_IP=10.201.0.2
+
+cleanup() {
+    ip netns pids "$SECOND_NS" 2>/dev/null | xargs -r kill 2>/dev/null || true
+    ip netns del "$SECOND_NS" 2>/dev/null || true
+    netns_teardown
+}
+
+netns_setup
+trap cleanup EXIT
+ip netns add "$SECOND_NS"
+ip link add veth-scan2 type veth peer name veth-target2
+ip link set veth-scan2 netns "$SCAN_NS"
+ip link set veth-target2 netns "$SECOND_NS"
+ip -n "$SCAN_NS" addr add 10.201.0.1/24 dev veth-scan2
+ip -n "$SECOND_NS" addr add "$SECOND_IP/24" dev veth-target2
+ip -n "$SCAN_NS" link set veth-scan2 up
+ip -n "$SECOND_NS" link set veth-target2 up
+
+netns_listen 80
+ip netns exec "$SECOND_NS" python3 -c "
+import socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('$SECOND_IP', 80))
+s.listen(64)
+time.sleep(60)
+" &
+sleep 0.3
+
+out=$(netns_scan --all-interfaces --mode tcp --port 80 --timeout 300 --threads 64 --no-discovery --no-udp --no-public-ip)
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not found"; exit 1; }
+echo "$out" | grep -q "\"ip\": \"$SECOND_IP\"" || { echo "FAIL: $SECOND_IP not found"; exit 1; }
+
+arp=$(netns_scan --all-interfaces --mode arp --timeout 300 --no-discovery --no-udp --no-public-ip)
+echo "$arp" | grep -q "\"ip\": \"$SECOND_IP\"" || { echo "FAIL: ARP sweep missed $SECOND_IP"; exit 1; }
+
+echo "PASS: all interfaces"
@@ -0,0 +1,18 @@
+#!/bin/bash
+# ARP sweep against a veth peer that drops ICMP: it must still be found, with its MAC.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/arp_scan.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+ip netns exec "$TARGET_NS" iptables -A INPUT -p icmp -j DROP 2>/dev/null || true
+target_mac=$(ip netns exec "$TARGET_NS" cat /sys/class/net/veth-target/address)
+
+out=$(netns_scan --mode arp --timeout 500)
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not found"; exit 1; }
+echo "$out" | grep -q "\"mac\": \"$target_mac\"" || { echo "FAIL: MAC $target_mac not reported"; exit 1; }
+
+echo "PASS: arp scan"
@@ -0,0 +1,27 @@
+#!/bin/bash
+# --prune-silent surveys each /24 of a sparse target list and skips the blocks
+# where no broadcast or sentinel address answered.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/block_survey.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+# The target also holds its block's .254 sentinel address
+ip -n "$TARGET_NS" addr add 10.200.0.254/24 dev veth-target
+netns_listen 80
+
+targets=$(mktemp)
+echo "10.200.0.0/22" > "$targets"
+ip -n "$SCAN_NS" route add 10.200.0.0/22 dev veth-scan
+
+out=$(netns_scan --targets "$targets" --prune-silent --mode tcp --port 80 --timeout 300 --threads 64 \
+      --no-discovery --no-udp --no-public-ip --no-neighbors)
+rm -f "$targets"
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not found"; exit 1; }
+echo "$out" | grep -q '"live_blocks": 1' || { echo "FAIL: expected one live block"; exit 1; }
+echo "$out" | grep -q '"silent_targets": 768' || { echo "FAIL: silent blocks not pruned"; exit 1; }
+
+echo "PASS: block survey"
@@ -0,0 +1,58 @@
+#!/bin/bash
+# Shared helpers for the network-namespace integration scripts.
+#
+# Builds an isolated two-namespace topology connected by a veth pair:
+#
+#   ns-scan (10.200.0.1/24, veth-scan) <----> ns-target (10.200.0.2/24, veth-target)
+#
+# The scanner runs inside ns-scan, so its auto-detected local subnet is
+# 10.200.0.0/24 and nothing leaves the host. Requires root.
+
+set -euo pipefail
+
+SCAN_NS=ns-scan
+TARGET_NS=ns-target
+SCAN_IP=10.200.0.1
+TARGET_IP=10.200.0.2
+
+BIN=${BIN:-$(dirname "$0")/../../build/bin/network-analyzer}
+
+netns_setup() {
+    netns_teardown
+    ip netns add "$SCAN_NS"
+    ip netns add "$TARGET_NS"
+    ip link add veth-scan type veth peer name veth-target
+    ip link set veth-scan netns "$SCAN_NS"
+    ip link set veth-target netns "$TARGET_NS"
+    ip -n "$SCAN_NS" addr add "$SCAN_IP/24" dev veth-scan
+    ip -n "$TARGET_NS" addr add "$TARGET_IP/24" dev veth-target
+    ip -n "$SCAN_NS" link set lo up
+    ip -n "$TARGET_NS" link set lo up
+    ip -n "$SCAN_NS" link set veth-scan up
+    ip -n "$TARGET_NS" link set veth-target up
+    trap netns_teardown EXIT
+}
+
+netns_teardown() {
+    ip netns pids "$TARGET_NS" 2>/dev/null | xargs -r kill 2>/dev/null || true
+    ip netns del "$SCAN_NS" 2>/dev/null || true
+    ip netns del "$TARGET_NS" 2>/dev/null || true
+}
+
+# Start a TCP listener on TARGET_IP:$1 inside the target namespace
+netns_listen() {
+    ip netns exec "$TARGET_NS" python3 -c "
+import socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('$TARGET_IP', $1))
+s.listen(64)
+time.sleep(60)
+" &
+    sleep 0.3
+}
+
+# Run the scanner inside the scanning namespace
+netns_scan() {
+    ip netns exec "$SCAN_NS" "$BIN" --json --no-color "$@"
+}
@@ -0,0 +1,32 @@
+#!/bin/bash
+# A device that drops ICMP but answers SSDP is found and identified by the discovery stage.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/discovery.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+ip netns exec "$TARGET_NS" iptables -A INPUT -p icmp -j DROP 2>/dev/null || true
+
+# Minimal SSDP responder: answers every M-SEARCH as a Roku
+ip netns exec "$TARGET_NS" python3 -c "
+import socket, struct
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('', 1900))
+mreq = struct.pack('4s4s', socket.inet_aton('239.255.255.250'), socket.inet_aton('$TARGET_IP'))
+s.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+s.settimeout(60)
+while True:
+    data, addr = s.recvfrom(2048)
+    if data.startswith(b'M-SEARCH'):
+        s.sendto(b'HTTP/1.1 200 OK\r\nSERVER: Roku/9.4 UPnP/1.0\r\nST: roku:ecp\r\n\r\n', addr)
+" &
+sleep 0.3
+
+out=$(netns_scan --mode icmp --timeout 300 --no-neighbors)
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\", \"device_type\": \"Roku Device\"" || { echo "FAIL: Roku not identified"; exit 1; }
+
+echo "PASS: discovery"
@@ -0,0 +1,20 @@
+#!/bin/bash
+# A host already in the neighbor table is reported without probing, even when it
+# drops ICMP and has no listening port.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/neighbor_seed.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+target_mac=$(ip netns exec "$TARGET_NS" cat /sys/class/net/veth-target/address)
+ip -n "$SCAN_NS" neigh replace "$TARGET_IP" lladdr "$target_mac" dev veth-scan nud reachable
+ip netns exec "$TARGET_NS" iptables -A INPUT -p icmp -j DROP 2>/dev/null || true
+
+out=$(netns_scan --mode icmp --timeout 300)
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not pre-seeded"; exit 1; }
+echo "$out" | grep -q '"probes_saved": 1' || { echo "FAIL: probes_saved not reported"; exit 1; }
+
+echo "PASS: neighbor seeding"
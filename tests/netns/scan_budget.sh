@@ -0,0 +1,22 @@
+#!/bin/bash
+# --max-hosts stops a sweep once enough hosts answered and still prints
+# complete JSON, flagged as truncated.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/scan_budget.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+netns_listen 80
+
+out=$(netns_scan --max-hosts 1 --mode tcp --port 80 --timeout 300 --threads 4 \
+      --no-discovery --no-udp --no-public-ip --no-neighbors --no-history)
+echo "$out"
+
+echo "$out" | python3 -c 'import json, sys; json.load(sys.stdin)' || { echo "FAIL: malformed JSON"; exit 1; }
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not found"; exit 1; }
+echo "$out" | grep -q '"truncated_by": "max-hosts"' || { echo "FAIL: scan not flagged as truncated"; exit 1; }
+sent=$(echo "$out" | sed -n 's/^ *"probes_sent": \([0-9]*\),$/\1/p')
+[ "$sent" -lt 254 ] || { echo "FAIL: $sent probes sent, expected the sweep to stop early"; exit 1; }
+
+echo "PASS: scan budget"
@@ -0,0 +1,20 @@
+#!/bin/bash
+# SYN scan against a veth peer: one open port, one closed port.
+#
+#   sudo BIN=build/bin/network-analyzer tests/netns/syn_scan.sh
+
+source "$(dirname "$0")/common.sh"
+
+netns_setup
+netns_listen 8080
+
+out=$(netns_scan --mode syn --ports 22,8080 --timeout 500)
+echo "$out"
+
+echo "$out" | grep -q "\"ip\": \"$TARGET_IP\"" || { echo "FAIL: $TARGET_IP not found"; exit 1; }
+echo "$out" | grep -q '"port": 8080' || { echo "FAIL: port 8080 not reported open"; exit 1; }
+if echo "$out" | grep -q '"port": 22,'; then
+    echo "FAIL: closed port 22 reported open"; exit 1
+fi
+
+echo "PASS: syn scan"
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "arp.hpp"
+#include "rate_limiter.hpp"
+#include "utils.hpp"
+#include <chrono>
+#include <cstring>
+
+static const Arp::MacAddress LOCAL_MAC{0x02, 0x00, 0x5e, 0x10, 0x20, 0x30};
+
+TEST(ArpTest, BuildsBroadcastRequest) {
+    uint8_t frame[Arp::FRAME_LEN];
+    const size_t len = Arp::buildRequest(frame, LOCAL_MAC, Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.7"));
+    ASSERT_EQ(len, Arp::FRAME_LEN);
+
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(frame[i], 0xff);
+    EXPECT_EQ(std::memcmp(frame + 6, LOCAL_MAC.data(), 6), 0);
+    EXPECT_EQ(frame[12], 0x08);
+    EXPECT_EQ(frame[13], 0x06);
+    EXPECT_EQ(frame[21], 1);  // who-has
+    EXPECT_EQ(frame[28], 10);
+    EXPECT_EQ(frame[31], 1);  // sender 10.0.0.1
+    EXPECT_EQ(frame[41], 7);  // target 10.0.0.7
+}
+
+TEST(ArpTest, ParsesReplyAndIgnoresRequests) {
+    uint8_t frame[Arp::FRAME_LEN];
+    const Arp::MacAddress peer{0xaa, 0xbb, 0xcc, 0x01, 0x02, 0x03};
+    Arp::buildRequest(frame, peer, Utils::ipToUint("10.0.0.7"), Utils::ipToUint("10.0.0.1"));
+
+    Arp::Reply reply{};
+    EXPECT_FALSE(Arp::parseReply(frame, sizeof(frame), reply));
+
+    frame[21] = 2;  // turn it into an is-at reply
+    ASSERT_TRUE(Arp::parseReply(frame, sizeof(frame), reply));
+    EXPECT_EQ(reply.ip, Utils::ipToUint("10.0.0.7"));
+    EXPECT_EQ(Arp::formatMac(reply.mac), "aa:bb:cc:01:02:03");
+
+    EXPECT_FALSE(Arp::parseReply(frame, 30, reply));
+}
+
+TEST(RateLimiterTest, PacesAfterBurst) {
+    RateLimiter limiter(1000, 1);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 51; ++i) limiter.acquire();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(45));
+}
+
+TEST(RateLimiterTest, ZeroRateIsUnpaced) {
+    RateLimiter limiter(0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; ++i) limiter.acquire();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "block_survey.hpp"
+#include "prefix_trie.hpp"
+#include "target_set.hpp"
+#include "utils.hpp"
+
+namespace {
+    TargetSet cidr(const std::string& block) {
+        TargetSet set;
+        set.parse(block.data(), block.size());
+        return set;
+    }
+}
+
+TEST(BlockSurveyTest, BlocksOfCoversEveryTouchedSlash24Once) {
+    TargetSet targets = cidr("10.0.0.0/23");
+    targets.add(Utils::ipToUint("10.0.5.7"), Utils::ipToUint("10.0.5.9"));
+    targets.add(Utils::ipToUint("10.0.5.200"), Utils::ipToUint("10.0.6.3"));
+
+    const auto blocks = BlockSurvey::blocksOf(targets);
+    const std::vector<uint32_t> expected = {
+        Utils::ipToUint("10.0.0.0") >> 8, Utils::ipToUint("10.0.1.0") >> 8,
+        Utils::ipToUint("10.0.5.0") >> 8, Utils::ipToUint("10.0.6.0") >> 8,
+    };
+    EXPECT_EQ(blocks, expected);
+}
+
+TEST(BlockSurveyTest, ProbeAddressesStayInsideTargetsAndExclusions) {
+    const TargetSet targets = cidr("192.168.7.0/24");
+    const uint32_t block = Utils::ipToUint("192.168.7.0") >> 8;
+
+    const auto all = BlockSurvey::probeAddresses(block, targets, nullptr);
+    EXPECT_NE(std::find(all.begin(), all.end(), Utils::ipToUint("192.168.7.255")), all.end());
+    EXPECT_NE(std::find(all.begin(), all.end(), Utils::ipToUint("192.168.7.1")), all.end());
+    EXPECT_NE(std::find(all.begin(), all.end(), Utils::ipToUint("192.168.7.254")), all.end());
+
+    PrefixTrie deny;
+    deny.insertRange(Utils::ipToUint("192.168.7.255"), Utils::ipToUint("192.168.7.255"));
+    const auto allowed = BlockSurvey::probeAddresses(block, targets, &deny);
+    EXPECT_EQ(std::find(allowed.begin(), allowed.end(), Utils::ipToUint("192.168.7.255")), allowed.end());
+    EXPECT_EQ(allowed.size(), all.size() - 1);
+
+    // A /24 scanned as its usable hosts has no broadcast entry to send to
+    const auto hostsOnly = BlockSurvey::probeAddresses(block, TargetSet::hostsOf("192.168.7.0/24"), nullptr);
+    EXPECT_EQ(std::find(hostsOnly.begin(), hostsOnly.end(), Utils::ipToUint("192.168.7.255")), hostsOnly.end());
+}
+
+TEST(BlockSurveyTest, PartitionSplitsAlongLiveBlocks) {
+    const TargetSet targets = cidr("10.1.0.0/22");
+    BlockSurvey::Result result;
+    result.liveBlocks.insert(Utils::ipToUint("10.1.2.0") >> 8);
+    BlockSurvey::partition(targets, result);
+
+    EXPECT_EQ(result.live.size(), 256u);
+    EXPECT_EQ(result.silent.size(), 768u);
+    EXPECT_TRUE(result.live.contains(Utils::ipToUint("10.1.2.77")));
+    EXPECT_TRUE(result.silent.contains(Utils::ipToUint("10.1.3.1")));
+}
+
+TEST(BlockSurveyTest, LoopbackSentinelMarksBlockLive) {
+    TargetSet targets;
+    targets.add(Utils::ipToUint("127.0.0.1"), Utils::ipToUint("127.0.0.1"));
+    targets.add(Utils::ipToUint("127.0.1.1"), Utils::ipToUint("127.0.1.1"));
+
+    BlockSurvey::Options options;
+    options.timeoutMs = 200;
+    const auto result = BlockSurvey::run(targets, options);
+    if (!result.ran) GTEST_SKIP() << "no ICMP socket available";
+
+    EXPECT_EQ(result.blocks, 2u);
+    EXPECT_EQ(result.requests, 2u);
+    // Loopback answers for all of 127/8, so both blocks are live
+    EXPECT_EQ(result.liveBlocks.size(), 2u);
+    EXPECT_TRUE(result.silent.empty());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "interfaces.hpp"
+#include "target_set.hpp"
+#include "utils.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    Interfaces::Interface make(const std::string& name, const std::string& ip, const uint8_t prefix) {
+        Interfaces::Interface iface;
+        iface.name = name;
+        iface.address = Utils::ipToUint(ip);
+        iface.prefixLength = prefix;
+        return iface;
+    }
+}
+
+TEST(InterfacesTest, SubnetArithmetic) {
+    const auto iface = make("eth0", "192.168.1.37", 24);
+    EXPECT_EQ(iface.netmask(), Utils::ipToUint("255.255.255.0"));
+    EXPECT_EQ(iface.cidr(), "192.168.1.0/24");
+    EXPECT_TRUE(iface.contains(Utils::ipToUint("192.168.1.254")));
+    EXPECT_FALSE(iface.contains(Utils::ipToUint("192.168.2.1")));
+}
+
+TEST(InterfacesTest, SubnetsOfMergesEveryInterface) {
+    const TargetSet targets = Interfaces::subnetsOf({make("eth0", "192.168.1.37", 24), make("wlan0", "10.0.0.5", 30)});
+    EXPECT_EQ(targets.size(), 254u + 2u);
+    EXPECT_TRUE(targets.contains(Utils::ipToUint("10.0.0.6")));
+    EXPECT_FALSE(targets.contains(Utils::ipToUint("192.168.1.255")));
+}
+
+TEST(InterfacesTest, RouterPrefersMostSpecificSubnet) {
+    const Interfaces::Router router({make("br0", "10.0.0.1", 8), make("vpn0", "10.8.0.2", 16)});
+
+    const auto* via = router.route(Utils::ipToUint("10.8.3.4"));
+    ASSERT_NE(via, nullptr);
+    EXPECT_EQ(via->name, "vpn0");
+
+    via = router.route(Utils::ipToUint("10.9.0.1"));
+    ASSERT_NE(via, nullptr);
+    EXPECT_EQ(via->name, "br0");
+
+    EXPECT_EQ(router.route(Utils::ipToUint("172.16.0.1")), nullptr);
+}
+
+TEST(InterfacesTest, BindSocketUsesInterfaceAddressAsSource) {
+    const int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+
+    const auto loopback = make("lo", "127.0.0.1", 8);
+    Interfaces::bindSocket(sockfd, &loopback);
+
+    sockaddr_in local{};
+    socklen_t len = sizeof(local);
+    ASSERT_EQ(getsockname(sockfd, reinterpret_cast<sockaddr*>(&local), &len), 0);
+    EXPECT_EQ(ntohl(local.sin_addr.s_addr), loopback.address);
+    close(sockfd);
+}
+
+TEST(InterfacesTest, ListSkipsLoopback) {
+    for (const auto& iface : Interfaces::list()) {
+        EXPECT_NE(iface.address >> 24, 127u) << iface.name;
+        EXPECT_LE(iface.prefixLength, 32);
+    }
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "json_output.hpp"
+#include "device_identifier.hpp"
+#include "network_info.hpp"
+#include <sstream>
+#include <string>
+
+TEST(JsonOutputTest, EscapesQuotesBackslashesAndControlCharacters) {
+    EXPECT_EQ(JsonOutput::escape("plain"), "plain");
+    EXPECT_EQ(JsonOutput::escape("a\"b\\c"), "a\\\"b\\\\c");
+    EXPECT_EQ(JsonOutput::escape("line\nnext\r\tend"), "line\\nnext\\r\\tend");
+}
+
+TEST(JsonOutputTest, RendersHostsWithMacAndOpenPorts) {
+    const NetworkInfo info{"10.0.0.2", "10.0.0.1", "", "eth0", "255.255.255.0"};
+    DeviceIdentifier deviceId;
+    deviceId.setMacAddress("10.0.0.5", "aa:bb:cc:dd:ee:ff");
+    const OpenPortMap openPorts = {{"10.0.0.5", {22, 80}}};
+    BudgetReport budget;
+    budget.probesSent = 254;
+    budget.truncatedBy = "max-hosts";
+
+    const std::string json = JsonOutput::render(info, "tcp", 80, 8, false, 500, "10.0.0.0/24",
+                                                {{"10.0.0.5", "Server \"A\""}, {"10.0.0.9", "Unknown"}}, 1.5, 254,
+                                                {22, 80}, openPorts, deviceId, 3, {}, budget);
+
+    EXPECT_NE(json.find("\"ports\": [22, 80]"), std::string::npos);
+    EXPECT_NE(json.find("\"truncated_by\": \"max-hosts\""), std::string::npos);
+    EXPECT_NE(json.find("{\"ip\": \"10.0.0.5\", \"device_type\": \"Server \\\"A\\\"\", \"mac\": \"aa:bb:cc:dd:ee:ff\", "
+                        "\"open_ports\": [{\"port\": 22, \"service\": \"SSH\"}, {\"port\": 80, \"service\": \"HTTP\"}]}"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"device_type\": \"Unknown\""), std::string::npos);
+    EXPECT_EQ(json.find("block_survey"), std::string::npos);
+    EXPECT_EQ(json.back(), '\n');
+}
+
+TEST(JsonOutputTest, MacVendorMatchesOuiInAnySeparatorOrCase) {
+    DeviceIdentifier deviceId;
+    std::istringstream table("# comment\nAABBCC Example Corp\n001122 Other Inc\nbroken\n");
+    EXPECT_EQ(deviceId.loadMacVendors(table), 2U);
+    EXPECT_EQ(deviceId.macVendor("aa:bb:cc:00:11:22"), "Example Corp");
+    EXPECT_EQ(deviceId.macVendor("00-11-22-33-44-55"), "Other Inc");
+    EXPECT_EQ(deviceId.macVendor("de:ad:be:ef:00:00"), "");
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "logger.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Counted {
+        int* formatted;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const Counted& counted) {
+        ++*counted.formatted;
+        return out << "counted";
+    }
+
+    // Captures stderr for the lifetime of the object, flushing the logger on both ends
+    class CaptureStderr {
+    public:
+        CaptureStderr() {
+            Logger::flush();
+            saved = std::cerr.rdbuf(captured.rdbuf());
+        }
+        ~CaptureStderr() { restore(); }
+
+        std::string text() {
+            restore();
+            return captured.str();
+        }
+
+    private:
+        void restore() {
+            if (!saved) return;
+            Logger::flush();
+            std::cerr.rdbuf(saved);
+            saved = nullptr;
+        }
+
+        std::ostringstream captured;
+        std::streambuf* saved = nullptr;
+    };
+
+    class LoggerTest : public ::testing::Test {
+    protected:
+        void TearDown() override { Logger::setLevel(Logger::Level::NORMAL); }
+    };
+}
+
+TEST_F(LoggerTest, FormatsPiecesByType) {
+    EXPECT_EQ(Logger::detail::format("host ", std::string("10.0.0.1"), ':', 443, " up=", true, " rtt=", 1.5),
+              "host 10.0.0.1:443 up=true rtt=" + std::to_string(1.5));
+    int formatted = 0;
+    EXPECT_EQ(Logger::detail::format(Counted{&formatted}), "counted");
+}
+
+TEST_F(LoggerTest, DisabledLevelsSkipFormatting) {
+    int formatted = 0;
+    CaptureStderr capture;
+    Logger::setLevel(Logger::Level::NORMAL);
+    Logger::debug("debug ", Counted{&formatted});
+    Logger::verbose("verbose ", Counted{&formatted});
+    EXPECT_EQ(formatted, 0);
+    EXPECT_EQ(capture.text(), "");
+
+    Logger::setLevel(Logger::Level::DEBUG);
+    {
+        CaptureStderr enabled;
+        Logger::debug("debug ", Counted{&formatted});
+        EXPECT_NE(enabled.text().find(" DBG] debug counted\n"), std::string::npos);
+    }
+    EXPECT_EQ(formatted, 1);
+}
+
+TEST_F(LoggerTest, QuietStillReportsErrors) {
+    Logger::setLevel(Logger::Level::QUIET);
+    CaptureStderr capture;
+    Logger::warn("hidden");
+    Logger::error("shown");
+    const std::string text = capture.text();
+    EXPECT_EQ(text.find("hidden"), std::string::npos);
+    EXPECT_NE(text.find(" ERR] shown\n"), std::string::npos);
+}
+
+TEST_F(LoggerTest, FlushWritesEveryThreadInOrder) {
+    constexpr int THREADS = 4;
+    constexpr int LINES = 2000;   // several times a ring, so producers also wait on the writer
+    Logger::setLevel(Logger::Level::DEBUG);
+    CaptureStderr capture;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < LINES; ++i) Logger::debug("t", t, " line ", i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    std::istringstream lines(capture.text());
+    std::vector<int> next(THREADS, 0);
+    std::string line;
+    int total = 0;
+    while (std::getline(lines, line)) {
+        const size_t body = line.find("DBG] t");
+        ASSERT_NE(body, std::string::npos) << line;
+        const int t = std::stoi(line.substr(body + 6));
+        const int i = std::stoi(line.substr(line.find(" line ") + 6));
+        EXPECT_EQ(i, next[t]++) << "thread " << t << " out of order";
+        ++total;
+    }
+    EXPECT_EQ(total, THREADS * LINES);
+}
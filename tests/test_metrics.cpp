@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "metrics.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MetricsTest, ShardsArePaddedToCacheLines) {
+    EXPECT_EQ(alignof(Metrics::Shard), Metrics::CACHE_LINE);
+    EXPECT_EQ(sizeof(Metrics::Shard) % Metrics::CACHE_LINE, 0U);
+}
+
+TEST(MetricsTest, SnapshotSumsAllThreadsIncludingFinishedOnes) {
+    const Metrics::Snapshot before = Metrics::snapshot();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) Metrics::add(Metrics::Counter::ProbesSent);
+            Metrics::add(Metrics::Counter::Replies, 10);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    Metrics::add(Metrics::Counter::HostsFound, 3);
+
+    const Metrics::Snapshot delta = Metrics::snapshot().since(before);
+    EXPECT_EQ(delta[Metrics::Counter::ProbesSent], 4000U);
+    EXPECT_EQ(delta[Metrics::Counter::Replies], 40U);
+    EXPECT_EQ(delta[Metrics::Counter::HostsFound], 3U);
+    EXPECT_EQ(delta[Metrics::Counter::Errors], 0U);
+}
+
+TEST(MetricsTest, RecycledShardsKeepTheirCounts) {
+    const Metrics::Snapshot before = Metrics::snapshot();
+    for (int round = 0; round < 3; ++round) {
+        std::thread([] { Metrics::add(Metrics::Counter::Timeouts, 5); }).join();
+    }
+    EXPECT_EQ(Metrics::snapshot().since(before)[Metrics::Counter::Timeouts], 15U);
+}
+
+TEST(MetricsTest, JsonListsEveryCounter) {
+    Metrics::Snapshot snapshot;
+    snapshot.values[static_cast<size_t>(Metrics::Counter::ProbesSent)] = 7;
+    const std::string json = Metrics::toJson(snapshot);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find("\"probes_sent\": 7"), std::string::npos);
+    for (size_t i = 0; i < Metrics::COUNTERS; ++i) {
+        EXPECT_NE(json.find(Metrics::name(static_cast<Metrics::Counter>(i))), std::string::npos);
+    }
+}
+
+TEST(MetricsTest, ReporterLineShowsRateAndEta) {
+    Metrics::Snapshot stage;
+    stage.values[static_cast<size_t>(Metrics::Counter::JobsDone)] = 50;
+    stage.values[static_cast<size_t>(Metrics::Counter::HostsFound)] = 2;
+
+    const std::string line = Metrics::Reporter::format("SCAN", stage, 200, std::chrono::seconds(5));
+    EXPECT_EQ(line.rfind("[SCAN] [#######.", 0), 0U);
+    EXPECT_NE(line.find("50/200"), std::string::npos);
+    EXPECT_NE(line.find("10/s"), std::string::npos);
+    EXPECT_NE(line.find("ETA 15s"), std::string::npos);
+    EXPECT_NE(line.find("2 hosts"), std::string::npos);
+
+    // Nothing to extrapolate from yet
+    const std::string early = Metrics::Reporter::format("", Metrics::Snapshot{}, 200, std::chrono::milliseconds(100));
+    EXPECT_EQ(early.find("ETA"), std::string::npos);
+    EXPECT_EQ(early.rfind("[..", 0), 0U);
+}
+
+TEST(MetricsTest, BucketsAreExactBelowEightThenLogLinear) {
+    for (uint64_t v = 0; v < 8; ++v) EXPECT_EQ(Metrics::bucketOf(v), v);
+    EXPECT_EQ(Metrics::bucketOf(8), 8U);
+    EXPECT_EQ(Metrics::bucketOf(15), 15U);
+    EXPECT_EQ(Metrics::bucketOf(16), 16U);
+    EXPECT_EQ(Metrics::bucketOf(17), 16U);
+
+    // Every bucket starts where bucketOf says it does, and bounds only grow
+    for (size_t b = 0; b < Metrics::BUCKETS; ++b) {
+        const uint64_t lower = Metrics::bucketLowerBound(b);
+        EXPECT_EQ(Metrics::bucketOf(lower), b);
+        if (b > 0) {
+            EXPECT_EQ(Metrics::bucketOf(lower - 1), b - 1);
+        }
+    }
+    EXPECT_EQ(Metrics::bucketOf(UINT64_MAX), Metrics::BUCKETS - 1);
+}
+
+TEST(MetricsTest, QuantilesStayWithinBucketError) {
+    Metrics::Histogram histogram;
+    for (uint64_t v = 1; v <= 1000; ++v) histogram.add(v * 100);  // 100 us .. 100 ms
+
+    EXPECT_EQ(histogram.replies, 1000U);
+    EXPECT_EQ(histogram.maxMicros, 100000U);
+    for (const double q : {0.5, 0.9, 0.99}) {
+        const auto exact = static_cast<double>(q * 1000 * 100);
+        const auto estimate = static_cast<double>(histogram.quantile(q));
+        EXPECT_GE(estimate, exact);
+        EXPECT_LE(estimate, exact * 1.125);
+    }
+    EXPECT_EQ(histogram.quantile(1.0), 100000U);
+    EXPECT_EQ(Metrics::Histogram{}.quantile(0.5), 0U);
+}
+
+TEST(MetricsTest, RecordProbeFillsCountersAndHistograms) {
+    const Metrics::Snapshot before = Metrics::snapshot();
+    std::thread([] {
+        Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Reply, std::chrono::microseconds(1500));
+        Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Timeout);
+        {
+            Metrics::StageScope stage(Metrics::ProbeType::Identify);
+            Metrics::recordProbe(Metrics::ProbeType::Icmp, Metrics::Outcome::Reply, std::chrono::microseconds(700));
+            Metrics::recordProbe(Metrics::ProbeType::Tcp, Metrics::Outcome::Error);
+        }
+    }).join();
+
+    const Metrics::Snapshot after = Metrics::snapshot();
+    const Metrics::Snapshot delta = after.since(before);
+    EXPECT_EQ(delta[Metrics::Counter::ProbesSent], 4U);
+    EXPECT_EQ(delta[Metrics::Counter::Replies], 2U);
+    EXPECT_EQ(delta[Metrics::Counter::Timeouts], 1U);
+    EXPECT_EQ(delta[Metrics::Counter::Errors], 1U);
+
+    const auto& tcp = after[Metrics::ProbeType::Tcp];
+    const auto& identify = after[Metrics::ProbeType::Identify];
+    EXPECT_EQ(tcp.replies - before[Metrics::ProbeType::Tcp].replies, 1U);
+    EXPECT_EQ(tcp.timeouts - before[Metrics::ProbeType::Tcp].timeouts, 1U);
+    EXPECT_GE(tcp.maxMicros, 1500U);
+    EXPECT_EQ(identify.replies - before[Metrics::ProbeType::Identify].replies, 1U);
+    EXPECT_EQ(identify.errors - before[Metrics::ProbeType::Identify].errors, 1U);
+    EXPECT_EQ(after[Metrics::ProbeType::Icmp].replies, before[Metrics::ProbeType::Icmp].replies);
+}
+
+TEST(MetricsTest, LatencyJsonListsEveryProbeType) {
+    Metrics::Snapshot snapshot;
+    snapshot.latency[static_cast<size_t>(Metrics::ProbeType::Icmp)].add(2000);
+    const std::string json = Metrics::latencyJson(snapshot, 2);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.substr(json.size() - 3), "  }");
+    EXPECT_NE(json.find("\"icmp\": {\"replies\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"max_ms\": 2.000"), std::string::npos);
+    for (size_t t = 0; t < Metrics::PROBE_TYPES; ++t) {
+        EXPECT_NE(json.find(Metrics::name(static_cast<Metrics::ProbeType>(t))), std::string::npos);
+    }
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "metrics_server.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    // One HTTP exchange with the server on loopback; returns the raw response
+    std::string fetch(const uint16_t port, const std::string& request) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            return "";
+        }
+        send(fd, request.data(), request.size(), 0);
+
+        std::string response;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, static_cast<size_t>(n));
+        close(fd);
+        return response;
+    }
+}
+
+TEST(MetricsServerTest, PrometheusTextHasCountersAndCumulativeBuckets) {
+    Metrics::Snapshot snapshot;
+    snapshot.values[static_cast<size_t>(Metrics::Counter::ProbesSent)] = 42;
+    auto& tcp = snapshot.latency[static_cast<size_t>(Metrics::ProbeType::Tcp)];
+    tcp.add(5);       // below the first edge (7 us)
+    tcp.add(1000);    // 1 ms
+    tcp.add(20000);   // 20 ms
+    tcp.timeouts = 3;
+
+    const std::string text = Metrics::prometheusText(snapshot);
+    EXPECT_NE(text.find("# TYPE network_scanner_probes_sent_total counter\nnetwork_scanner_probes_sent_total 42\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_outcomes_total{type=\"tcp\",outcome=\"timeout\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE network_scanner_probe_rtt_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"tcp\",le=\"7e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"tcp\",le=\"0.001023\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"tcp\",le=\"0.016383\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"tcp\",le=\"0.032767\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"tcp\",le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_sum{type=\"tcp\"} 0.021005\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_count{type=\"icmp\"} 0\n"), std::string::npos);
+}
+
+TEST(MetricsServerTest, BucketEdgesAreInclusive) {
+    Metrics::Snapshot snapshot;
+    auto& icmp = snapshot.latency[static_cast<size_t>(Metrics::ProbeType::Icmp)];
+    icmp.add(1023);   // exactly on the 2^10 - 1 us edge
+    icmp.add(1024);   // exactly 2^10 us: the first edge at or above it is 2^11 - 1 us
+    icmp.add(2047);
+
+    const std::string text = Metrics::prometheusText(snapshot);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"icmp\",le=\"0.000511\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"icmp\",le=\"0.001023\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("network_scanner_probe_rtt_seconds_bucket{type=\"icmp\",le=\"0.002047\"} 3\n"), std::string::npos);
+}
+
+TEST(MetricsServerTest, ServesMetricsOverLoopback) {
+    Metrics::Server server("127.0.0.1:0");
+    ASSERT_NE(server.port(), 0);
+
+    Metrics::add(Metrics::Counter::HostsFound);
+    const std::string response = fetch(server.port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0U);
+    EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("network_scanner_hosts_found_total "), std::string::npos);
+
+    EXPECT_EQ(fetch(server.port(), "GET /other HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0), 0U);
+    EXPECT_EQ(fetch(server.port(), "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0), 0U);
+
+    // HEAD gets the headers only
+    const std::string head = fetch(server.port(), "HEAD /metrics HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(head.substr(head.size() - 4), "\r\n\r\n");
+}
+
+TEST(MetricsServerTest, RejectsMalformedListenAddresses) {
+    EXPECT_THROW(Metrics::Server("9464"), std::invalid_argument);
+    EXPECT_THROW(Metrics::Server("localhost:9464"), std::invalid_argument);
+    EXPECT_THROW(Metrics::Server("127.0.0.1:70000"), std::invalid_argument);
+    EXPECT_THROW(Metrics::Server("127.0.0.1:80x"), std::invalid_argument);
+
+    Metrics::Server first("127.0.0.1:0");
+    EXPECT_THROW(Metrics::Server("127.0.0.1:" + std::to_string(first.port())), std::runtime_error);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "multicast_discovery.hpp"
+#include <string>
+#include <vector>
+
+// Append a name as uncompressed labels
+static void putName(std::vector<uint8_t>& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) dot = name.size();
+        out.push_back(static_cast<uint8_t>(dot - start));
+        out.insert(out.end(), name.begin() + static_cast<long>(start), name.begin() + static_cast<long>(dot));
+        start = dot + 1;
+    }
+    out.push_back(0);
+}
+
+static void put16(std::vector<uint8_t>& out, const uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+TEST(DiscoveryTest, BuildsQueryWithOneQuestionPerName) {
+    const auto query = Discovery::buildMdnsQuery({"_googlecast._tcp.local", "_ipp._tcp.local"});
+    ASSERT_GE(query.size(), 12U);
+    EXPECT_EQ((query[4] << 8) | query[5], 2);
+    EXPECT_EQ(query[12], 11);  // "_googlecast" label length
+    EXPECT_EQ(std::string(query.begin() + 13, query.begin() + 24), "_googlecast");
+}
+
+TEST(DiscoveryTest, ParsesCompressedResponse) {
+    std::vector<uint8_t> msg;
+    put16(msg, 0);
+    put16(msg, 0x8400);  // response, authoritative
+    put16(msg, 0);
+    put16(msg, 3);       // answers
+    put16(msg, 0);
+    put16(msg, 0);
+
+    // PTR _googlecast._tcp.local -> Living-Room._googlecast._tcp.local (compressed)
+    const size_t serviceOffset = msg.size();
+    putName(msg, "_googlecast._tcp.local");
+    put16(msg, 12);
+    put16(msg, 1);
+    put16(msg, 0); put16(msg, 120);
+    put16(msg, 14);
+    msg.push_back(11);
+    msg.insert(msg.end(), {'L', 'i', 'v', 'i', 'n', 'g', '-', 'R', 'o', 'o', 'm'});
+    msg.push_back(static_cast<uint8_t>(0xc0 | (serviceOffset >> 8)));
+    msg.push_back(static_cast<uint8_t>(serviceOffset));
+
+    // SRV Living-Room._googlecast._tcp.local -> chromecast-abc.local
+    putName(msg, "Living-Room._googlecast._tcp.local");
+    put16(msg, 33);
+    put16(msg, 1);
+    put16(msg, 0); put16(msg, 120);
+    std::vector<uint8_t> target;
+    putName(target, "chromecast-abc.local");
+    put16(msg, static_cast<uint16_t>(6 + target.size()));
+    put16(msg, 0); put16(msg, 0); put16(msg, 8009);
+    msg.insert(msg.end(), target.begin(), target.end());
+
+    // A chromecast-abc.local
+    putName(msg, "chromecast-abc.local");
+    put16(msg, 1);
+    put16(msg, 1);
+    put16(msg, 0); put16(msg, 120);
+    put16(msg, 4);
+    msg.insert(msg.end(), {192, 168, 1, 40});
+
+    Discovery::MdnsRecords records;
+    ASSERT_TRUE(Discovery::parseMdnsResponse(msg.data(), msg.size(), records));
+    EXPECT_EQ(records.hostname, "chromecast-abc");
+    EXPECT_EQ(Discovery::classifyServices(records.services), "Google Chromecast");
+}
+
+TEST(DiscoveryTest, RejectsTruncatedAndLoopingMessages) {
+    Discovery::MdnsRecords records;
+    const uint8_t shortMsg[6]{};
+    EXPECT_FALSE(Discovery::parseMdnsResponse(shortMsg, sizeof(shortMsg), records));
+
+    // One answer whose name is a pointer to itself
+    std::vector<uint8_t> loop = {0, 0, 0x84, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0xc0, 12};
+    EXPECT_FALSE(Discovery::parseMdnsResponse(loop.data(), loop.size(), records));
+}
+
+TEST(DiscoveryTest, ClassifiesSsdpResponses) {
+    EXPECT_EQ(Discovery::classifySsdpResponse("HTTP/1.1 200 OK\r\nSERVER: Roku/9.4 UPnP/1.0\r\nST: roku:ecp\r\n\r\n"), "Roku Device");
+    EXPECT_EQ(Discovery::classifySsdpResponse(
+                  "HTTP/1.1 200 OK\r\nST: urn:schemas-upnp-org:device:InternetGatewayDevice:1\r\n\r\n"),
+              "Router (UPnP IGD)");
+    EXPECT_EQ(Discovery::classifySsdpResponse("HTTP/1.1 200 OK\r\nST: upnp:rootdevice\r\n\r\n"), "UPnP Device");
+    EXPECT_EQ(Discovery::classifySsdpResponse("NOTIFY * HTTP/1.1\r\n\r\n"), "");
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "neighbors.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/neighbour.h>
+#include <linux/rtnetlink.h>
+#endif
+
+TEST(NeighborsTest, ParsesProcArp) {
+    std::istringstream in(
+        "IP address       HW type     Flags       HW address            Mask     Device\n"
+        "192.168.1.1      0x1         0x2         aa:bb:cc:dd:ee:01     *        eth0\n"
+        "192.168.1.20     0x1         0x0         00:00:00:00:00:00     *        eth0\n"
+        "192.168.1.30     0x1         0x6         aa:bb:cc:dd:ee:03     *        eth0\n");
+
+    const auto entries = Neighbors::parseProcArp(in);
+    ASSERT_EQ(entries.size(), 3U);
+    EXPECT_EQ(entries[0].ip, Utils::ipToUint("192.168.1.1"));
+    EXPECT_EQ(entries[0].state, Neighbors::State::Alive);
+    EXPECT_EQ(entries[0].mac, "aa:bb:cc:dd:ee:01");
+    EXPECT_EQ(entries[1].state, Neighbors::State::Failed);
+    EXPECT_TRUE(entries[1].mac.empty());
+    EXPECT_EQ(entries[2].state, Neighbors::State::Other);
+}
+
+#ifdef __linux__
+TEST(NeighborsTest, ParsesNetlinkNeighborMessage) {
+    alignas(4) uint8_t buf[NLMSG_ALIGN(sizeof(ndmsg)) + RTA_SPACE(4) + RTA_SPACE(6)]{};
+    auto* nd = reinterpret_cast<ndmsg*>(buf);
+    nd->ndm_family = AF_INET;
+    nd->ndm_state = NUD_STALE;
+
+    auto* dst = reinterpret_cast<rtattr*>(buf + NLMSG_ALIGN(sizeof(ndmsg)));
+    dst->rta_type = NDA_DST;
+    dst->rta_len = RTA_LENGTH(4);
+    const uint32_t addr = htonl(Utils::ipToUint("10.1.2.3"));
+    std::memcpy(RTA_DATA(dst), &addr, 4);
+
+    auto* lladdr = reinterpret_cast<rtattr*>(reinterpret_cast<uint8_t*>(dst) + RTA_SPACE(4));
+    lladdr->rta_type = NDA_LLADDR;
+    lladdr->rta_len = RTA_LENGTH(6);
+    const uint8_t mac[6] = {0x02, 0x42, 0xac, 0x11, 0x00, 0x02};
+    std::memcpy(RTA_DATA(lladdr), mac, 6);
+
+    Neighbors::Entry entry{};
+    ASSERT_TRUE(Neighbors::parseNeighborMessage(buf, sizeof(buf), entry));
+    EXPECT_EQ(entry.ip, Utils::ipToUint("10.1.2.3"));
+    EXPECT_EQ(entry.mac, "02:42:ac:11:00:02");
+    EXPECT_EQ(entry.state, Neighbors::State::Alive);
+
+    nd->ndm_state = NUD_FAILED;
+    ASSERT_TRUE(Neighbors::parseNeighborMessage(buf, sizeof(buf), entry));
+    EXPECT_EQ(entry.state, Neighbors::State::Failed);
+
+    nd->ndm_family = AF_INET6;
+    EXPECT_FALSE(Neighbors::parseNeighborMessage(buf, sizeof(buf), entry));
+}
+
+TEST(NeighborsTest, DumpCoversProcArp) {
+    // Every resolved /proc/net/arp entry must also come back from the netlink dump
+    std::ifstream arpFile("/proc/net/arp");
+    if (!arpFile.is_open()) {
+        GTEST_SKIP() << "/proc/net/arp not available";
+    }
+    const auto procEntries = Neighbors::parseProcArp(arpFile);
+    const auto entries = Neighbors::dump();
+
+    for (const auto& procEntry : procEntries) {
+        if (procEntry.mac.empty()) continue;
+        const bool found = std::any_of(entries.begin(), entries.end(),
+                                       [&](const Neighbors::Entry& e) { return e.ip == procEntry.ip && e.mac == procEntry.mac; });
+        EXPECT_TRUE(found) << Utils::uintToIp(procEntry.ip);
+    }
+}
+#endif
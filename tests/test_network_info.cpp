@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "network_info.hpp"
 #include "utils.hpp"
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
 
 TEST(NetworkInfoTest, GetSubnet24) {
     EXPECT_EQ(getSubnet24("192.168.1.100"), "192.168.1.0/24");
@@ -32,3 +38,66 @@ TEST(NetworkInfoTest, IpToCIDR_32) {
     std::string cidr = ipToCIDR("192.168.1.1", "255.255.255.255");
     EXPECT_EQ(cidr, "192.168.1.1/32");
 }
+
+namespace {
+    // Gives each test a cache path under a directory that is removed afterwards
+    class PublicIpCacheTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            dir = ::testing::TempDir() + "network_info_test_" + std::to_string(getpid());
+            path = dir + "/cache/public_ip";
+        }
+        void TearDown() override { std::filesystem::remove_all(dir); }
+
+        std::string dir;
+        std::string path;
+    };
+}
+
+TEST_F(PublicIpCacheTest, RoundTrip) {
+    ASSERT_TRUE(writeCachedPublicIP(path, "203.0.113.7"));
+    EXPECT_EQ(readCachedPublicIP(path, 3600), "203.0.113.7");
+}
+
+TEST_F(PublicIpCacheTest, Expires) {
+    ASSERT_TRUE(writeCachedPublicIP(path, "203.0.113.7"));
+    {
+        std::ofstream stale(path, std::ios::trunc);
+        stale << (std::time(nullptr) - 7200) << " 203.0.113.7\n";
+    }
+    EXPECT_EQ(readCachedPublicIP(path, 3600), "");
+    EXPECT_EQ(readCachedPublicIP(path, 10000), "203.0.113.7");
+}
+
+TEST_F(PublicIpCacheTest, RejectsErrorsAndGarbage) {
+    EXPECT_FALSE(writeCachedPublicIP(path, "Error: Couldn't resolve host name"));
+    EXPECT_FALSE(writeCachedPublicIP("", "203.0.113.7"));
+    std::filesystem::create_directories(dir + "/cache");
+    {
+        std::ofstream garbage(path, std::ios::trunc);
+        garbage << "not a cache entry\n";
+    }
+    EXPECT_EQ(readCachedPublicIP(path, 3600), "");
+    EXPECT_EQ(readCachedPublicIP("/nonexistent/public_ip", 3600), "");
+}
+
+TEST_F(PublicIpCacheTest, LookupServesFreshCacheImmediately) {
+    ASSERT_TRUE(writeCachedPublicIP(path, "198.51.100.20"));
+    PublicIpLookup lookup(3600, path);
+    EXPECT_TRUE(lookup.ready());
+    EXPECT_EQ(lookup.get(), "198.51.100.20");
+}
+
+TEST(NetworkInfoTest, DetectionDoesNotWaitForPublicIp) {
+    const auto start = std::chrono::steady_clock::now();
+    const NetworkInfo info = getNetworkInfo();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(info.publicIp.empty());
+    EXPECT_LT(elapsed, std::chrono::seconds(1));
+    if (!info.localIp.empty()) {
+        EXPECT_TRUE(Utils::isValidIpv4(info.localIp));
+        EXPECT_FALSE(info.interfaceName.empty());
+        EXPECT_TRUE(Utils::isValidIpv4(info.subnetMask));
+    }
+}
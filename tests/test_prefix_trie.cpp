@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "prefix_trie.hpp"
+#include "utils.hpp"
+#include <random>
+#include <vector>
+
+TEST(PrefixTrieTest, EmptyTrieMatchesNothing) {
+    PrefixTrie trie;
+    EXPECT_TRUE(trie.empty());
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("10.0.0.1")));
+}
+
+TEST(PrefixTrieTest, MatchesInsertedCidrs) {
+    PrefixTrie trie;
+    trie.insert("10.0.0.0/8");
+    trie.insert("192.168.1.0/24");
+    trie.insert("172.16.5.7/32");
+
+    EXPECT_TRUE(trie.contains(Utils::ipToUint("10.255.1.2")));
+    EXPECT_TRUE(trie.contains(Utils::ipToUint("192.168.1.0")));
+    EXPECT_TRUE(trie.contains(Utils::ipToUint("192.168.1.255")));
+    EXPECT_TRUE(trie.contains(Utils::ipToUint("172.16.5.7")));
+
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("11.0.0.0")));
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("192.168.2.0")));
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("172.16.5.6")));
+    EXPECT_EQ(trie.prefixCount(), 3U);
+}
+
+TEST(PrefixTrieTest, NestedAndSplitPrefixes) {
+    PrefixTrie trie;
+    trie.insert("10.1.2.0/24");
+    trie.insert("10.1.3.0/24");
+    trie.insert("10.0.0.0/8");   // covers both, inserted above them
+    trie.insert("10.1.2.0/24");  // duplicate
+
+    EXPECT_TRUE(trie.contains(Utils::ipToUint("10.9.9.9")));
+    EXPECT_EQ(trie.prefixCount(), 3U);
+}
+
+TEST(PrefixTrieTest, DefaultRouteMatchesEverything) {
+    PrefixTrie trie;
+    trie.insert("0.0.0.0/0");
+    EXPECT_TRUE(trie.contains(0));
+    EXPECT_TRUE(trie.contains(0xFFFFFFFFU));
+}
+
+TEST(PrefixTrieTest, RangeDecomposition) {
+    PrefixTrie trie;
+    trie.insertRange(Utils::ipToUint("10.0.0.5"), Utils::ipToUint("10.0.0.20"));
+    // 5/32, 6/31, 8/29, 16/30, 20/32
+    EXPECT_EQ(trie.prefixCount(), 5U);
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("10.0.0.4")));
+    for (int i = 5; i <= 20; ++i) {
+        EXPECT_TRUE(trie.contains(Utils::ipToUint("10.0.0." + std::to_string(i))));
+    }
+    EXPECT_FALSE(trie.contains(Utils::ipToUint("10.0.0.21")));
+}
+
+TEST(PrefixTrieTest, AgreesWithLinearScan) {
+    std::mt19937 gen(7);
+    std::vector<std::pair<uint32_t, int>> prefixes;
+    PrefixTrie trie;
+    for (int i = 0; i < 2000; ++i) {
+        const int len = 8 + static_cast<int>(gen() % 25);
+        const uint32_t mask = ~0U << (32 - len);
+        const uint32_t prefix = gen() & mask;
+        prefixes.emplace_back(prefix, len);
+        trie.insert(prefix, len);
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        // Bias half the probes into inserted prefixes so both outcomes are exercised
+        uint32_t ip = gen();
+        if (i % 2) {
+            const auto& [prefix, len] = prefixes[gen() % prefixes.size()];
+            ip = prefix | (ip & ~(~0U << (32 - len)));
+        }
+        bool expected = false;
+        for (const auto& [prefix, len] : prefixes) {
+            if ((ip & (~0U << (32 - len))) == prefix) { expected = true; break; }
+        }
+        ASSERT_EQ(trie.contains(ip), expected) << Utils::uintToIp(ip);
+    }
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "probe_transport.hpp"
+#include "scanner.hpp"
+#include "target_set.hpp"
+#include "metrics.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* const SUBNET = "10.20.0.0/20";
+
+    std::vector<std::string> scanWith(const SimulatedTransport::Model& model, const std::string& mode,
+                                      const size_t threads = 8, const int timeoutMs = 1000, bool thorough = false) {
+        NetworkScanner scanner(threads, mode, 80, timeoutMs);
+        scanner.setTransport(std::make_shared<SimulatedTransport>(model));
+        const TargetSet targets = TargetSet::hostsOf(SUBNET);
+        return thorough ? scanner.thoroughScan(targets) : scanner.scan(targets);
+    }
+
+    // Ground truth of model over SUBNET
+    template <typename Predicate>
+    std::vector<std::string> expected(const SimulatedTransport::Model& model, Predicate predicate) {
+        const SimulatedTransport network(model);
+        std::vector<std::string> hosts;
+        const auto [first, last] = Utils::parseCIDR(SUBNET);
+        for (uint32_t ip = first + 1; ip < last; ++ip) {
+            if (predicate(network, ip)) hosts.push_back(Utils::uintToIp(ip));
+        }
+        return hosts;
+    }
+
+    SimulatedTransport::Model lan() {
+        SimulatedTransport::Model model;
+        model.seed = 7;
+        model.liveFraction = 0.1;
+        return model;
+    }
+}
+
+TEST(SimulatedTransportTest, SameSeedSameNetworkWhateverTheThreadCount) {
+    const auto model = lan();
+    const auto one = scanWith(model, "icmp", 1);
+    EXPECT_EQ(one, scanWith(model, "icmp", 32));
+    EXPECT_EQ(one, expected(model, [](const SimulatedTransport& n, const uint32_t ip) { return n.answersEcho(ip); }));
+    // About 10% live, 80% of those answering echo, out of 4094 addresses
+    EXPECT_GT(one.size(), 250U);
+    EXPECT_LT(one.size(), 400U);
+
+    auto other = model;
+    other.seed = 8;
+    EXPECT_NE(one, scanWith(other, "icmp"));
+}
+
+TEST(SimulatedTransportTest, TcpFindsOnlyOpenPorts) {
+    const auto model = lan();
+    EXPECT_EQ(scanWith(model, "tcp"),
+              expected(model, [](const SimulatedTransport& n, const uint32_t ip) { return n.portOpen(ip, 80); }));
+}
+
+TEST(SimulatedTransportTest, FallbackRetriesSilentEchoOverTcp) {
+    auto model = lan();
+    model.echoFraction = 0.5;
+    const auto found = scanWith(model, "fallback");
+    EXPECT_EQ(found, expected(model, [](const SimulatedTransport& n, const uint32_t ip) {
+        return n.answersEcho(ip) || n.portOpen(ip, 80);
+    }));
+    EXPECT_GT(found.size(), scanWith(model, "icmp").size());
+}
+
+TEST(SimulatedTransportTest, RepliesSlowerThanTheTimeoutAreTimeouts) {
+    auto model = lan();
+    model.rttMedianMicros = 50000;
+    model.rttSpread = 0;
+    model.rttJitter = 0;
+
+    const uint64_t timeoutsBefore = Metrics::snapshot()[Metrics::Counter::Timeouts];
+    EXPECT_TRUE(scanWith(model, "icmp", 8, 10).empty());
+    EXPECT_EQ(Metrics::snapshot()[Metrics::Counter::Timeouts] - timeoutsBefore, TargetSet::hostsOf(SUBNET).size());
+    EXPECT_FALSE(scanWith(model, "icmp", 8, 100).empty());
+}
+
+TEST(SimulatedTransportTest, NeighborFailuresShortenTheTimeout) {
+    auto model = lan();
+    model.rttMedianMicros = 300000;   // between a quarter of the timeout and the timeout
+    model.rttSpread = 0;
+    model.rttJitter = 0;
+    const auto live = expected(model, [](const SimulatedTransport& n, const uint32_t ip) { return n.answersEcho(ip); });
+    ASSERT_FALSE(live.empty());
+
+    auto hints = std::make_shared<NeighborHints>();
+    hints->failed.insert(Utils::ipToUint(live.front()));
+
+    NetworkScanner scanner(8, "icmp", 80, 1000);
+    scanner.setTransport(std::make_shared<SimulatedTransport>(model));
+    scanner.setNeighborHints(hints);
+    const auto found = scanner.scan(TargetSet::hostsOf(SUBNET));
+    EXPECT_EQ(found.size(), live.size() - 1);
+    EXPECT_EQ(std::find(found.begin(), found.end(), live.front()), found.end());
+}
+
+TEST(SimulatedTransportTest, LossIsDeterministicPerAttempt) {
+    auto model = lan();
+    model.loss = 1;
+    EXPECT_TRUE(scanWith(model, "icmp").empty());
+
+    model.loss = 0.5;
+    const auto lossy = scanWith(model, "icmp");
+    EXPECT_EQ(lossy, scanWith(model, "icmp", 3));
+    const size_t live = expected(model, [](const SimulatedTransport& n, const uint32_t ip) { return n.answersEcho(ip); }).size();
+    EXPECT_GT(lossy.size(), live / 4);
+    EXPECT_LT(lossy.size(), live * 3 / 4);
+
+    // A second probe of the same host is a new draw: some hosts lost once answer the retry
+    SimulatedTransport network(model);
+    size_t recovered = 0;
+    const auto [first, last] = Utils::parseCIDR(SUBNET);
+    for (uint32_t ip = first + 1; ip < last; ++ip) {
+        if (!network.answersEcho(ip)) continue;
+        const std::string ipStr = Utils::uintToIp(ip);
+        if (!network.echo(ip, ipStr, 1000, nullptr) && network.echo(ip, ipStr, 1000, nullptr)) ++recovered;
+    }
+    EXPECT_GT(recovered, 0U);
+}
+
+TEST(SimulatedTransportTest, ReplyLimitSilencesHostsAfterTheirBudget) {
+    auto model = lan();
+    model.echoFraction = 1;
+    model.portFraction = 1;
+    const auto all = expected(model, [](const SimulatedTransport& n, const uint32_t ip) { return n.alive(ip); });
+    EXPECT_EQ(scanWith(model, "tcp", 8, 1000, true), all);
+
+    // One ICMP and one TCP reply per host: the echo and the first connect still make the quorum
+    model.replyLimit = 1;
+    EXPECT_EQ(scanWith(model, "tcp", 8, 1000, true), all);
+
+    SimulatedTransport network(model);
+    const uint32_t ip = Utils::ipToUint(all.front());
+    EXPECT_TRUE(network.connect(ip, all.front(), 80, 1000, nullptr));
+    EXPECT_FALSE(network.connect(ip, all.front(), 443, 1000, nullptr));
+    // Its TCP reply is spent, so only the echo answers a verification now
+    EXPECT_FALSE(network.verify(ip, all.front(), NetworkScanner::VERIFY_PORTS, NetworkScanner::VERIFY_QUORUM, 1000, nullptr));
+}
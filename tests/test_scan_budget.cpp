@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "scan_budget.hpp"
+#include <chrono>
+#include <thread>
+
+TEST(ScanBudgetTest, UnlimitedByDefault) {
+    ScanBudget budget;
+    for (int i = 0; i < 1000; ++i) ASSERT_TRUE(budget.acquire());
+    budget.addHosts(500);
+    EXPECT_FALSE(budget.exhausted());
+    EXPECT_EQ(budget.probes(), 1000U);
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::None);
+}
+
+TEST(ScanBudgetTest, ProbeLimitAllowsExactlyMaxProbes) {
+    ScanBudget::Limits limits;
+    limits.maxProbes = 3;
+    ScanBudget budget(limits);
+
+    EXPECT_TRUE(budget.acquire());
+    EXPECT_TRUE(budget.acquire());
+    EXPECT_TRUE(budget.acquire());
+    // Spending the last probe is not truncation; asking for one more is
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::None);
+    EXPECT_FALSE(budget.acquire());
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Probes);
+    EXPECT_EQ(budget.probes(), 3U);
+}
+
+TEST(ScanBudgetTest, HostLimitStopsFurtherProbes) {
+    ScanBudget::Limits limits;
+    limits.maxHosts = 2;
+    ScanBudget budget(limits);
+
+    budget.addHosts();
+    EXPECT_TRUE(budget.acquire());
+    budget.addHosts();
+    EXPECT_TRUE(budget.exhausted());
+    EXPECT_FALSE(budget.acquire());
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Hosts);
+}
+
+TEST(ScanBudgetTest, DurationLimitExpires) {
+    ScanBudget::Limits limits;
+    limits.maxDuration = std::chrono::milliseconds(20);
+    ScanBudget budget(limits);
+
+    EXPECT_TRUE(budget.acquire());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_FALSE(budget.acquire());
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Duration);
+}
+
+TEST(ScanBudgetTest, FirstLimitReachedIsReported) {
+    ScanBudget::Limits limits;
+    limits.maxHosts = 1;
+    limits.maxProbes = 1;
+    ScanBudget budget(limits);
+
+    EXPECT_TRUE(budget.acquire());
+    budget.addHosts();
+    EXPECT_FALSE(budget.acquire());
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Hosts);
+    EXPECT_EQ(ScanBudget::describe(budget.reason()), "max-hosts");
+    EXPECT_EQ(ScanBudget::describe(ScanBudget::Limit::None), "");
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "scan_history.hpp"
+#include "utils.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    // Gives each test a history path under a directory that is removed afterwards
+    class ScanHistoryFileTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            dir = ::testing::TempDir() + "scan_history_test_" + std::to_string(getpid());
+            path = dir + "/hosts";
+        }
+        void TearDown() override { std::filesystem::remove_all(dir); }
+
+        std::string dir;
+        std::string path;
+    };
+}
+
+TEST(ScanHistoryTest, ParseDropsStaleAndMalformedEntries) {
+    std::istringstream in(
+        "10.0.0.5 1000\n"
+        "10.0.0.6 100\n"
+        "garbage line\n"
+        "300.0.0.1 1000\n"
+        "10.0.0.5 900\n");
+
+    const auto seen = ScanHistory::parse(in, 1100, 500);
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen.at(Utils::ipToUint("10.0.0.5")), 1000);
+}
+
+TEST_F(ScanHistoryFileTest, RecordMergesWithEarlierScans) {
+    ASSERT_TRUE(ScanHistory::record(path, {Utils::ipToUint("192.168.1.20")}));
+    ASSERT_TRUE(ScanHistory::record(path, {Utils::ipToUint("192.168.1.7"), Utils::ipToUint("192.168.1.20")}));
+
+    const auto hosts = ScanHistory::load(path);
+    const std::vector<uint32_t> expected = {Utils::ipToUint("192.168.1.7"), Utils::ipToUint("192.168.1.20")};
+    EXPECT_EQ(hosts, expected);
+    EXPECT_TRUE(ScanHistory::load("/nonexistent/hosts").empty());
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "scan_pipeline.hpp"
+#include "scanner.hpp"
+#include "target_set.hpp"
+#include "prefix_trie.hpp"
+#include "scan_budget.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+TEST(ScanPipelineTest, VisitsJobsPortMajorAndSkipsExclusions) {
+    TargetSet targets;
+    targets.add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.3"));
+    PrefixTrie deny;
+    deny.insert("10.0.0.2/32");
+
+    std::vector<std::pair<uint32_t, int>> jobs;
+    const uint64_t skipped = ScanPipeline::forEachJob(targets, {22, 80}, &deny, nullptr,
+        [&](const uint32_t ip, const int port) { jobs.emplace_back(ip, port); });
+
+    EXPECT_EQ(skipped, 2U);
+    ASSERT_EQ(jobs.size(), 4U);
+    EXPECT_EQ(jobs[0], std::make_pair(Utils::ipToUint("10.0.0.1"), 22));
+    EXPECT_EQ(jobs[1], std::make_pair(Utils::ipToUint("10.0.0.3"), 22));
+    EXPECT_EQ(jobs[2].second, 80);
+}
+
+TEST(ScanPipelineTest, VisitsTiersInOrder) {
+    std::vector<TargetSet> tiers(2);
+    tiers[0].add(Utils::ipToUint("10.0.0.9"), Utils::ipToUint("10.0.0.9"));
+    tiers[1].add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.2"));
+
+    std::vector<uint32_t> visited;
+    ScanPipeline::forEachJob(tiers, {80}, nullptr, nullptr, [&](const uint32_t ip, int) { visited.push_back(ip); });
+
+    const std::vector<uint32_t> expected = {Utils::ipToUint("10.0.0.9"), Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.2")};
+    EXPECT_EQ(visited, expected);
+}
+
+TEST(ScanPipelineTest, RunReturnsSortedHits) {
+    TargetSet targets;
+    targets.add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.20"));
+    std::atomic<int> calls = 0;
+
+    const auto hits = ScanPipeline::run(targets, {443, 80}, 4, nullptr, nullptr,
+        [&calls](const uint32_t ip, const std::string&, const int port) {
+            ++calls;
+            return (ip & 1) && port == 80;
+        });
+
+    EXPECT_EQ(calls.load(), 40);
+    ASSERT_EQ(hits.size(), 10U);
+    EXPECT_EQ(hits.front().ip, Utils::ipToUint("10.0.0.1"));
+    EXPECT_TRUE(std::is_sorted(hits.begin(), hits.end()));
+}
+
+TEST(ScanPipelineTest, RunStopsAtProbeBudget) {
+    TargetSet targets;
+    targets.add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.100"));
+    ScanBudget::Limits limits;
+    limits.maxProbes = 30;
+    ScanBudget budget(limits);
+    std::atomic<int> calls = 0;
+
+    const auto hits = ScanPipeline::run(targets, {80}, 4, nullptr, &budget,
+        [&calls](uint32_t, const std::string&, int) {
+            ++calls;
+            return true;
+        });
+
+    EXPECT_EQ(calls.load(), 30);
+    EXPECT_EQ(hits.size(), 30U);
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Probes);
+}
+
+TEST(ScanPipelineTest, RunStopsOnceEnoughHostsAnswer) {
+    TargetSet targets;
+    targets.add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.3.255"));
+    ScanBudget::Limits limits;
+    limits.maxHosts = 5;
+    ScanBudget budget(limits);
+
+    // Hosts already being probed when the limit is hit still report back
+    const auto hits = ScanPipeline::run(targets, {80}, 2, nullptr, &budget,
+        [](const uint32_t ip, const std::string&, int) { return ip % 10 == 0; });
+
+    EXPECT_GE(hits.size(), 5U);
+    EXPECT_LT(budget.probes(), targets.size());
+    EXPECT_EQ(budget.reason(), ScanBudget::Limit::Hosts);
+}
+
+TEST(ScanPipelineTest, ParsesScanModes) {
+    EXPECT_EQ(parseScanMode("icmp"), ScanMode::Icmp);
+    EXPECT_EQ(parseScanMode("tcp"), ScanMode::Tcp);
+    EXPECT_EQ(parseScanMode("fallback"), ScanMode::Fallback);
+    EXPECT_EQ(parseScanMode("syn"), ScanMode::Syn);
+    EXPECT_THROW(parseScanMode("udp"), std::invalid_argument);
+}
+
+namespace {
+    // Exposes the tier order a scan would probe in
+    class ScheduleProbe : public Scanner {
+    public:
+        using Scanner::Scanner;
+        using Scanner::schedule;
+    };
+}
+
+TEST(ScanPipelineTest, ScheduleProbesPriorityThenRouterAddressesFirst) {
+    ScheduleProbe scanner(1, "tcp");
+    auto priority = std::make_shared<TargetSet>();
+    priority->add(Utils::ipToUint("10.9.0.77"), Utils::ipToUint("10.9.0.77"));
+    priority->add(Utils::ipToUint("172.16.0.1"), Utils::ipToUint("172.16.0.1"));  // not a target
+    scanner.setPriorityHosts(priority);
+
+    const TargetSet targets = TargetSet::hostsOf("10.9.0.0/24");
+    const auto tiers = scanner.schedule(targets);
+
+    ASSERT_EQ(tiers.size(), 3u);
+    EXPECT_EQ(tiers[0].size(), 1u);
+    EXPECT_TRUE(tiers[0].contains(Utils::ipToUint("10.9.0.77")));
+    EXPECT_TRUE(tiers[1].contains(Utils::ipToUint("10.9.0.1")));
+    EXPECT_TRUE(tiers[1].contains(Utils::ipToUint("10.9.0.254")));
+    EXPECT_FALSE(tiers[1].contains(Utils::ipToUint("10.9.0.77")));
+
+    uint64_t total = 0;
+    for (const auto& tier : tiers) total += tier.size();
+    EXPECT_EQ(total, targets.size());
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "syn.hpp"
+#include "icmp.hpp"
+#include <cstring>
+
+TEST(SynTest, CookieIsDeterministic) {
+    EXPECT_EQ(Syn::cookie(42, 0xC0A80101U, 80, 40000), Syn::cookie(42, 0xC0A80101U, 80, 40000));
+    EXPECT_NE(Syn::cookie(42, 0xC0A80101U, 80, 40000), Syn::cookie(43, 0xC0A80101U, 80, 40000));
+    EXPECT_NE(Syn::cookie(42, 0xC0A80101U, 80, 40000), Syn::cookie(42, 0xC0A80102U, 80, 40000));
+    EXPECT_NE(Syn::cookie(42, 0xC0A80101U, 80, 40000), Syn::cookie(42, 0xC0A80101U, 443, 40000));
+}
+
+TEST(SynTest, BuildSynHeader) {
+    uint8_t seg[20];
+    ASSERT_EQ(Syn::buildSyn(seg, 0x0A000001U, 0x0A000002U, 40000, 443, 0x11223344U), 20U);
+
+    EXPECT_EQ((seg[0] << 8) | seg[1], 40000);
+    EXPECT_EQ((seg[2] << 8) | seg[3], 443);
+    EXPECT_EQ(seg[4], 0x11);
+    EXPECT_EQ(seg[7], 0x44);
+    EXPECT_EQ(seg[12] >> 4, 5);   // data offset: 5 words
+    EXPECT_EQ(seg[13], 0x02);     // SYN only
+
+    // Re-checksumming a segment that carries its checksum must yield zero
+    EXPECT_EQ(Syn::tcpChecksum(0x0A000001U, 0x0A000002U, seg, sizeof(seg)), 0);
+}
+
+static size_t makeReply(uint8_t* pkt, uint32_t from, uint16_t fromPort, uint16_t toPort, uint32_t ack, uint8_t flags) {
+    std::memset(pkt, 0, 40);
+    pkt[0] = 0x45;
+    pkt[9] = 6;
+    pkt[12] = from >> 24; pkt[13] = from >> 16; pkt[14] = from >> 8; pkt[15] = from;
+    uint8_t* tcp = pkt + 20;
+    tcp[0] = fromPort >> 8; tcp[1] = fromPort & 0xff;
+    tcp[2] = toPort >> 8; tcp[3] = toPort & 0xff;
+    tcp[8] = ack >> 24; tcp[9] = ack >> 16; tcp[10] = ack >> 8; tcp[11] = ack;
+    tcp[12] = 0x50;
+    tcp[13] = flags;
+    return 40;
+}
+
+TEST(SynTest, ParseSynAckAndRst) {
+    const uint32_t secret = 1234;
+    const uint32_t host = 0x0A000002U;
+    uint8_t pkt[40];
+    Syn::Reply reply{};
+
+    size_t len = makeReply(pkt, host, 22, 40000, Syn::cookie(secret, host, 22, 40000) + 1, 0x12);
+    ASSERT_TRUE(Syn::parseReply(pkt, len, secret, 40000, reply));
+    EXPECT_EQ(reply.ip, host);
+    EXPECT_EQ(reply.port, 22);
+    EXPECT_EQ(reply.state, Syn::PortState::Open);
+
+    len = makeReply(pkt, host, 23, 40000, Syn::cookie(secret, host, 23, 40000) + 1, 0x14);
+    ASSERT_TRUE(Syn::parseReply(pkt, len, secret, 40000, reply));
+    EXPECT_EQ(reply.state, Syn::PortState::Closed);
+}
+
+TEST(SynTest, RejectsForeignTraffic) {
+    const uint32_t secret = 1234;
+    const uint32_t host = 0x0A000002U;
+    uint8_t pkt[40];
+    Syn::Reply reply{};
+
+    // Wrong acknowledgement number (not our cookie)
+    size_t len = makeReply(pkt, host, 22, 40000, 0xdeadbeef, 0x12);
+    EXPECT_FALSE(Syn::parseReply(pkt, len, secret, 40000, reply));
+
+    // Different destination port
+    len = makeReply(pkt, host, 22, 40001, Syn::cookie(secret, host, 22, 40000) + 1, 0x12);
+    EXPECT_FALSE(Syn::parseReply(pkt, len, secret, 40000, reply));
+
+    // Truncated packet
+    EXPECT_FALSE(Syn::parseReply(pkt, 30, secret, 40000, reply));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "target_set.hpp"
+#include "utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+static TargetSet parsed(const std::string& text, size_t* invalid = nullptr) {
+    TargetSet set;
+    const size_t bad = set.parse(text.data(), text.size());
+    if (invalid) *invalid = bad;
+    return set;
+}
+
+TEST(TargetSetTest, ParsesAllEntryForms) {
+    size_t invalid = 0;
+    const TargetSet set = parsed("10.0.0.1\n10.0.1.0/30, 10.0.2.5-10.0.2.6 10.0.3.1-3\n", &invalid);
+    EXPECT_EQ(invalid, 0U);
+    ASSERT_EQ(set.ranges().size(), 4U);
+    EXPECT_EQ(set.size(), 1U + 4U + 2U + 3U);
+    EXPECT_TRUE(set.contains(Utils::ipToUint("10.0.1.3")));
+    EXPECT_TRUE(set.contains(Utils::ipToUint("10.0.3.2")));
+    EXPECT_FALSE(set.contains(Utils::ipToUint("10.0.0.2")));
+}
+
+TEST(TargetSetTest, SkipsCommentsAndCountsInvalid) {
+    size_t invalid = 0;
+    const TargetSet set = parsed("# inventory export\n10.0.0.1 # core router\n300.1.1.1\n10.0.0.9/33\nhost.example\n", &invalid);
+    EXPECT_EQ(invalid, 3U);
+    EXPECT_EQ(set.size(), 1U);
+}
+
+TEST(TargetSetTest, MergesOverlappingAndAdjacentRanges) {
+    const TargetSet set = parsed("10.0.0.0/25 10.0.0.128/25 10.0.0.5 10.0.2.0-10.0.2.10 10.0.2.5-10.0.2.20");
+    ASSERT_EQ(set.ranges().size(), 2U);
+    EXPECT_EQ(set.ranges()[0], TargetSet::Range(Utils::ipToUint("10.0.0.0"), Utils::ipToUint("10.0.0.255")));
+    EXPECT_EQ(set.ranges()[1], TargetSet::Range(Utils::ipToUint("10.0.2.0"), Utils::ipToUint("10.0.2.20")));
+}
+
+TEST(TargetSetTest, AddMergesAsRangesArrive) {
+    TargetSet set;
+    set.add(Utils::ipToUint("10.0.0.20"), Utils::ipToUint("10.0.0.29"));
+    set.add(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.1"));
+    set.add(Utils::ipToUint("10.0.0.40"), Utils::ipToUint("10.0.0.49"));
+    ASSERT_EQ(set.ranges().size(), 3U);
+
+    // Bridges all three, touching the first and overlapping the last
+    set.add(Utils::ipToUint("10.0.0.45"), Utils::ipToUint("10.0.0.2"));
+    ASSERT_EQ(set.ranges().size(), 1U);
+    EXPECT_EQ(set.ranges()[0], TargetSet::Range(Utils::ipToUint("10.0.0.1"), Utils::ipToUint("10.0.0.49")));
+}
+
+TEST(TargetSetTest, SubtractSplitsRanges) {
+    TargetSet set = parsed("10.0.0.0/24 10.0.2.0/24");
+    set.subtract(parsed("10.0.0.10-10.0.0.19 10.0.0.200/29 10.0.2.0/24 10.0.9.9"));
+    ASSERT_EQ(set.ranges().size(), 3U);
+    EXPECT_EQ(set.size(), 256U - 10U - 8U);
+    EXPECT_FALSE(set.contains(Utils::ipToUint("10.0.0.15")));
+    EXPECT_TRUE(set.contains(Utils::ipToUint("10.0.0.20")));
+    EXPECT_FALSE(set.contains(Utils::ipToUint("10.0.2.1")));
+}
+
+TEST(TargetSetTest, IntersectKeepsOverlap) {
+    TargetSet set = parsed("10.0.0.0/24 10.0.2.0/24");
+    set.intersect(parsed("10.0.0.250-10.0.2.5 10.0.9.9"));
+    ASSERT_EQ(set.ranges().size(), 2U);
+    EXPECT_EQ(set.size(), 6U + 6U);
+    EXPECT_FALSE(set.contains(Utils::ipToUint("10.0.9.9")));
+}
+
+TEST(TargetSetTest, HandlesAddressSpaceEdges) {
+    TargetSet set = parsed("0.0.0.0/0");
+    EXPECT_EQ(set.size(), 1ULL << 32);
+    set.subtract(parsed("255.255.255.255 0.0.0.0"));
+    EXPECT_EQ(set.size(), (1ULL << 32) - 2);
+}
+
+TEST(TargetSetTest, HostsOfDropsNetworkAndBroadcast) {
+    EXPECT_EQ(TargetSet::hostsOf("192.168.1.0/24").size(), 254U);
+    EXPECT_FALSE(TargetSet::hostsOf("192.168.1.0/24").contains(Utils::ipToUint("192.168.1.255")));
+    EXPECT_EQ(TargetSet::hostsOf("192.168.1.7/32").size(), 1U);
+    EXPECT_EQ(TargetSet::hostsOf("192.168.1.6/31").size(), 2U);
+}
+
+TEST(TargetSetTest, LoadsFromFile) {
+    const std::string path = ::testing::TempDir() + "targets_test.txt";
+    {
+        std::ofstream out(path);
+        out << "192.168.0.0/16\n";
+        for (int i = 0; i < 1000; ++i) out << "10.1." << i / 256 << "." << i % 256 << "\n";
+    }
+
+    TargetSet set;
+    EXPECT_EQ(set.load(path), 0U);
+    EXPECT_EQ(set.size(), 65536U + 1000U);
+    EXPECT_EQ(set.ranges().size(), 2U);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(set.load("/nonexistent/targets.txt"), std::runtime_error);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "tcp.hpp"
+#include "fd_budget.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+// Listening socket on 127.0.0.1 with an ephemeral port
+static int listenLoopback(int& port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(fd, 16);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+TEST(TcpTest, DetectsOpenAndClosedPort) {
+    int port = 0;
+    const int listener = listenLoopback(port);
+    ASSERT_GE(listener, 0);
+
+    EXPECT_TRUE(Tcp::ping("127.0.0.1", port, true, 500));
+    close(listener);
+    EXPECT_FALSE(Tcp::ping("127.0.0.1", port, true, 500));
+}
+
+TEST(TcpTest, WorksWithDescriptorsAboveFdSetsize) {
+    // Push the next descriptor number past FD_SETSIZE (1024); select() based
+    // waiting would write out of bounds here.
+    if (FdBudget::raiseLimit() < 1200) {
+        GTEST_SKIP() << "RLIMIT_NOFILE too low to exceed FD_SETSIZE";
+    }
+
+    std::vector<int> filler;
+    while (filler.empty() || filler.back() < 1100) {
+        const int fd = dup(STDIN_FILENO);
+        if (fd < 0) break;
+        filler.push_back(fd);
+    }
+
+    int port = 0;
+    const int listener = listenLoopback(port);
+    EXPECT_GT(listener, 1024);
+    EXPECT_TRUE(Tcp::ping("127.0.0.1", port, true, 500));
+
+    close(listener);
+    for (const int fd : filler) close(fd);
+}
+
+TEST(FdBudgetTest, CapacityRespectsLimit) {
+    rlimit rl{};
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &rl), 0);
+    EXPECT_GT(FdBudget::capacity(), 0U);
+    if (rl.rlim_cur != RLIM_INFINITY) {
+        EXPECT_LE(FdBudget::capacity(), static_cast<size_t>(rl.rlim_cur));
+    }
+}
+
+TEST(TcpTest, StartConnectCompletesThroughPoll) {
+    int port = 0;
+    const int listener = listenLoopback(port);
+    ASSERT_GE(listener, 0);
+
+    const int sockfd = Tcp::startConnect("127.0.0.1", port);
+    ASSERT_GE(sockfd, 0);
+    pollfd pfd{sockfd, POLLOUT, 0};
+    ASSERT_EQ(poll(&pfd, 1, 500), 1);
+    EXPECT_TRUE(Tcp::connected(sockfd));
+    Tcp::closeAbortive(sockfd);
+    close(listener);
+}
+
+TEST(FdBudgetTest, MultiSlotAcquireIsReleased) {
+    const size_t capacity = FdBudget::capacity();
+    {
+        FdBudget::Slot slots(4);
+    }
+    // Every descriptor must be available again, or this would block forever
+    FdBudget::acquire(capacity);
+    FdBudget::release(capacity);
+    SUCCEED();
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "trace.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    size_t count(const std::string& haystack, const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+        return n;
+    }
+
+    std::string tracePath(const char* name) {
+        return ::testing::TempDir() + name;
+    }
+}
+
+TEST(TraceTest, SpansOutsideASessionAreNotRecorded) {
+    EXPECT_FALSE(Trace::active());
+    { Trace::Span span("ignored"); }
+
+    const std::string path = tracePath("trace_idle.json");
+    {
+        Trace::Session session(path);
+        EXPECT_TRUE(Trace::active());
+    }
+    EXPECT_FALSE(Trace::active());
+    EXPECT_EQ(readFile(path).find("\"ignored\""), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, WritesPhasesAndSampledProbesAsChromeEvents) {
+    const std::string path = tracePath("trace_events.json");
+    {
+        Trace::Session session(path);
+        {
+            Trace::Span phase("scan");
+            std::thread([] {
+                for (uint32_t i = 0; i < 4 * Trace::PROBE_SAMPLE; ++i) {
+                    Trace::Span probe("tcp", Trace::Category::Probe, "10.0.0.1");
+                }
+                Trace::Span host("identify", Trace::Category::Host, "10.0.0.\"2\"");
+            }).join();
+        }
+        EXPECT_GE(session.write(), 6U);
+    }
+
+    const std::string json = readFile(path);
+    EXPECT_EQ(json.rfind("{\"traceEvents\": [", 0), 0U);
+    EXPECT_NE(json.find("\"name\": \"scan\", \"cat\": \"phase\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_EQ(count(json, "\"name\": \"tcp\", \"cat\": \"probe\""), 4U);
+    EXPECT_NE(json.find("\"args\": {\"target\": \"10.0.0.1\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"target\": \"10.0.0.\\\"2\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"main\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"dropped_events\": 0"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, UnwritablePathThrows) {
+    EXPECT_THROW(Trace::Session("/nonexistent-dir/trace.json"), std::runtime_error);
+    EXPECT_FALSE(Trace::active());
+}
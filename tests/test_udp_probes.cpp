@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "udp_probes.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <thread>
+
+namespace {
+    // One-shot UDP responder on 127.0.0.1: answers the first datagram with respond(request)
+    class StandIn {
+    public:
+        explicit StandIn(std::function<std::vector<uint8_t>(const std::vector<uint8_t>&)> respond) {
+            sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bind(sockfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            socklen_t len = sizeof(addr);
+            getsockname(sockfd, reinterpret_cast<sockaddr*>(&addr), &len);
+            port = ntohs(addr.sin_port);
+
+            worker = std::thread([this, respond = std::move(respond)] {
+                pollfd pfd{sockfd, POLLIN, 0};
+                if (poll(&pfd, 1, 2000) <= 0) return;
+                uint8_t buf[2048];
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                const ssize_t n = recvfrom(sockfd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+                if (n <= 0) return;
+                const std::vector<uint8_t> reply = respond(std::vector<uint8_t>(buf, buf + n));
+                if (!reply.empty()) {
+                    sendto(sockfd, reply.data(), reply.size(), 0, reinterpret_cast<sockaddr*>(&from), fromLen);
+                }
+            });
+        }
+
+        ~StandIn() {
+            worker.join();
+            close(sockfd);
+        }
+
+        uint16_t port = 0;
+
+    private:
+        int sockfd = -1;
+        std::thread worker;
+    };
+
+    std::vector<uint8_t> netbiosReply(const std::vector<uint8_t>& request) {
+        std::vector<uint8_t> reply(request.begin(), request.begin() + 2);  // echo transaction id
+        reply.insert(reply.end(), {0x84, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00});
+        reply.insert(reply.end(), request.begin() + 12, request.begin() + 12 + 34);  // question name
+        reply.insert(reply.end(), {0x00, 0x21, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x02});
+        const char group[] = "WORKGROUP      ";
+        reply.insert(reply.end(), group, group + 15);
+        reply.insert(reply.end(), {0x00, 0x84, 0x00});  // <00> group
+        const char host[] = "DESKTOP-42     ";
+        reply.insert(reply.end(), host, host + 15);
+        reply.insert(reply.end(), {0x00, 0x04, 0x00});  // <00> unique
+        return reply;
+    }
+
+    // Tag, one-byte length, value: every test message is shorter than 128 bytes
+    std::vector<uint8_t> tlv(const uint8_t tag, const std::vector<uint8_t>& value) {
+        std::vector<uint8_t> out(2 + value.size());
+        out[0] = tag;
+        out[1] = static_cast<uint8_t>(value.size());
+        std::copy(value.begin(), value.end(), out.begin() + 2);
+        return out;
+    }
+
+    std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts) {
+        std::vector<uint8_t> out;
+        for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+        return out;
+    }
+
+    std::vector<uint8_t> snmpReply(const std::string& descr) {
+        // Hand-assembled v2c GetResponse with sysDescr.0 = descr
+        const std::vector<uint8_t> varbind = tlv(0x30, concat({
+            {0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00},
+            tlv(0x04, std::vector<uint8_t>(descr.begin(), descr.end()))}));
+        const std::vector<uint8_t> pdu = tlv(0xa2, concat({
+            {0x02, 0x01, 0x01, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00}, tlv(0x30, varbind)}));
+        return tlv(0x30, concat({{0x02, 0x01, 0x01, 0x04, 0x06, 'p', 'u', 'b', 'l', 'i', 'c'}, pdu}));
+    }
+}
+
+TEST(UdpProbesTest, NetbiosRequestEncodesWildcard) {
+    const auto request = UdpProbes::buildNetbiosStatusRequest(0x1234);
+    ASSERT_EQ(request.size(), 50U);
+    EXPECT_EQ(request[12], 0x20);
+    EXPECT_EQ(request[13], 'C');
+    EXPECT_EQ(request[14], 'K');
+    EXPECT_EQ(request[47], 0x21);
+}
+
+TEST(UdpProbesTest, NetbiosParserRejectsTruncatedReplies) {
+    const auto reply = netbiosReply(UdpProbes::buildNetbiosStatusRequest(0x1234));
+    std::string name;
+    ASSERT_TRUE(UdpProbes::parseNetbiosStatusResponse(reply.data(), reply.size(), name));
+    EXPECT_EQ(name, "DESKTOP-42");
+
+    // A header claiming one answer, and nothing after it
+    const std::vector<uint8_t> header(reply.begin(), reply.begin() + 12);
+    EXPECT_FALSE(UdpProbes::parseNetbiosStatusResponse(header.data(), header.size(), name));
+    for (size_t len = 13; len < reply.size(); ++len) {
+        const std::vector<uint8_t> truncated(reply.begin(), reply.begin() + static_cast<long>(len));
+        name.clear();
+        EXPECT_FALSE(UdpProbes::parseNetbiosStatusResponse(truncated.data(), truncated.size(), name)) << len;
+    }
+}
+
+TEST(UdpProbesTest, SnmpGetRoundTripsThroughParser) {
+    const auto request = UdpProbes::buildSnmpGet("s3cret", 7);
+    EXPECT_EQ(request[0], 0x30);
+    EXPECT_NE(std::search(request.begin(), request.end(), std::begin("s3cret"), std::end("s3cret") - 1), request.end());
+
+    const auto reply = snmpReply("HP ETHERNET MULTI-ENVIRONMENT,JETDIRECT");
+    std::string descr;
+    ASSERT_TRUE(UdpProbes::parseSnmpResponse(reply.data(), reply.size(), descr));
+    EXPECT_EQ(descr, "HP ETHERNET MULTI-ENVIRONMENT,JETDIRECT");
+    EXPECT_FALSE(UdpProbes::parseSnmpResponse(request.data(), request.size(), descr));
+}
+
+TEST(UdpProbesTest, DescribesResults) {
+    UdpProbes::Result result;
+    EXPECT_EQ(UdpProbes::describe(result), "");
+    result.netbiosName = "DESKTOP-42";
+    EXPECT_EQ(UdpProbes::describe(result), "Windows/SMB Host (DESKTOP-42)");
+    result.sysDescr = "Hardware: Intel64 - Software: Windows Version 10.0";
+    EXPECT_EQ(UdpProbes::describe(result), "Windows Host (DESKTOP-42)");
+}
+
+TEST(UdpProbesTest, ProbesLocalStandIns) {
+    StandIn netbios(netbiosReply);
+    StandIn snmp([](const std::vector<uint8_t>& request) {
+        const std::string community = "lab";
+        const bool ok = std::search(request.begin(), request.end(), community.begin(), community.end()) != request.end();
+        return ok ? snmpReply("Cisco IOS Software, C2960 Software") : std::vector<uint8_t>{};
+    });
+    StandIn ntp([](const std::vector<uint8_t>& request) {
+        std::vector<uint8_t> reply(48, 0);
+        if (request.size() == 48 && (request[0] & 0x07) == 3) {
+            reply[0] = 0x24;  // mode 4 (server)
+            reply[1] = 2;
+        }
+        return reply;
+    });
+
+    UdpProbes::Options options;
+    options.community = "lab";
+    options.timeoutMs = 500;
+    options.netbiosPort = netbios.port;
+    options.snmpPort = snmp.port;
+    options.ntpPort = ntp.port;
+
+    const auto results = UdpProbes::probe({"127.0.0.1"}, options);
+    ASSERT_EQ(results.count("127.0.0.1"), 1U);
+    const auto& result = results.at("127.0.0.1");
+    EXPECT_EQ(result.netbiosName, "DESKTOP-42");
+    EXPECT_EQ(result.sysDescr, "Cisco IOS Software, C2960 Software");
+    EXPECT_EQ(result.ntpStratum, 2);
+    EXPECT_EQ(UdpProbes::describe(result), "Network Device (DESKTOP-42)");
+}
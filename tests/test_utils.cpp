@@ -68,3 +68,19 @@ TEST(UtilsTest, IsValidIpv4) {
     EXPECT_FALSE(Utils::isValidIpv4("1.2.3.4.5"));
     EXPECT_FALSE(Utils::isValidIpv4("; rm -rf /"));
 }
+
+TEST(UtilsTest, ParsePortList) {
+    EXPECT_EQ(Utils::parsePortList("80"), (std::vector<int>{80}));
+    EXPECT_EQ(Utils::parsePortList("443,22,80"), (std::vector<int>{22, 80, 443}));
+    EXPECT_EQ(Utils::parsePortList("8000-8003,22"), (std::vector<int>{22, 8000, 8001, 8002, 8003}));
+    EXPECT_EQ(Utils::parsePortList("80,80,79-81"), (std::vector<int>{79, 80, 81}));
+}
+
+TEST(UtilsTest, ParsePortListInvalid) {
+    EXPECT_THROW(Utils::parsePortList(""), std::invalid_argument);
+    EXPECT_THROW(Utils::parsePortList("0"), std::invalid_argument);
+    EXPECT_THROW(Utils::parsePortList("65536"), std::invalid_argument);
+    EXPECT_THROW(Utils::parsePortList("100-90"), std::invalid_argument);
+    EXPECT_THROW(Utils::parsePortList("80x"), std::invalid_argument);
+    EXPECT_THROW(Utils::parsePortList("abc"), std::invalid_argument);
+}